@@ -20,6 +20,7 @@ RESULTS_DIR = PROJECT_ROOT / "benchmark_results"
 RECORDINGS_DIR = PROJECT_ROOT / "benchmark_recordings"
 GIFS_DIR = PROJECT_ROOT / "benchmark_gifs"
 PLOTS_DIR = PROJECT_ROOT / "benchmark_plots"
+FRAMES_DIR = RESULTS_DIR / "frames"
 
 def convert_videos_to_gifs():
     """Convert all MP4 videos to GIFs using ffmpeg."""
@@ -81,6 +82,72 @@ def load_benchmark_data():
     
     return pd.concat(all_data, ignore_index=True)
 
+def load_frame_data():
+    """Load per-frame timing logs (benchmark mode writes one per run)."""
+    frame_files = sorted(FRAMES_DIR.glob("grid*_frames.csv"))
+    if not frame_files:
+        return None
+    
+    all_data = []
+    for csv_file in frame_files:
+        try:
+            df = pd.read_csv(csv_file)
+            parts = csv_file.stem.split("_")  # e.g., "grid512_speed10_frames"
+            df["grid_size"] = int(parts[0].replace("grid", ""))
+            df["sim_speed"] = int(parts[1].replace("speed", "")) / 10.0
+            all_data.append(df)
+        except Exception as e:
+            print(f"Error loading {csv_file}: {e}")
+    
+    if not all_data:
+        return None
+    
+    return pd.concat(all_data, ignore_index=True)
+
+def plot_frame_time_distribution(frames):
+    """Plot per-frame time histograms (log scale) and save a percentile table."""
+    PLOTS_DIR.mkdir(exist_ok=True)
+    
+    metrics = [m for m in ["frame_ms", "cpu_ms", "wait_ms", "gpu_ms"] if m in frames.columns and frames[m].notna().any()]
+    fig, axes = plt.subplots(1, len(metrics), figsize=(6 * len(metrics), 5), squeeze=False)
+    
+    # Same bins as the app's histogram: four per octave
+    bins = 2.0 ** np.arange(-4, 12.25, 0.25)
+    rows = []
+    for (grid, speed), run in frames.groupby(["grid_size", "sim_speed"]):
+        for ax, metric in zip(axes[0], metrics):
+            values = run[metric].dropna()
+            if values.empty:
+                continue
+            ax.hist(values, bins=bins, histtype="step", linewidth=1.5, label=f"{grid}² @ {speed:g}x")
+        for metric in metrics:
+            values = run[metric].dropna()
+            if values.empty:
+                continue
+            rows.append({"grid_size": grid, "sim_speed": speed, "metric": metric, "frames": len(values),
+                         "mean": values.mean(), "p50": values.quantile(0.50), "p95": values.quantile(0.95),
+                         "p99": values.quantile(0.99), "max": values.max()})
+    
+    for ax, metric in zip(axes[0], metrics):
+        ax.set_xscale("log")
+        ax.set_yscale("log")
+        ax.set_xlabel(f"{metric.replace('_ms', '')} time (ms)", fontsize=12)
+        ax.set_ylabel("Frames", fontsize=12)
+        ax.grid(True, alpha=0.3)
+    axes[0][0].legend(fontsize=8)
+    fig.suptitle("Frame Time Distribution", fontsize=14, fontweight='bold')
+    
+    plt.tight_layout()
+    plt.savefig(PLOTS_DIR / "frame_time_distribution.png", dpi=150)
+    print(f"Saved: {PLOTS_DIR / 'frame_time_distribution.png'}")
+    plt.close()
+    
+    table = pd.DataFrame(rows).round(3)
+    table.to_csv(PLOTS_DIR / "frame_percentiles.csv", index=False)
+    print(f"Saved: {PLOTS_DIR / 'frame_percentiles.csv'}")
+    print("\n=== Frame Time Percentiles (ms) ===")
+    print(table.to_string(index=False))
+
 def plot_fps_by_grid_size(df):
     """Plot average FPS vs grid size."""
     PLOTS_DIR.mkdir(exist_ok=True)
@@ -142,11 +209,21 @@ def generate_summary_table(df):
     """Generate a summary table."""
     PLOTS_DIR.mkdir(exist_ok=True)
     
-    summary = df.groupby(["grid_size", "sim_speed"]).agg({
-        "fps": ["mean", "min", "max", "std"]
-    }).round(1)
+    aggs = {"fps": ["mean", "min", "max", "std"]}
+    columns = ["Avg FPS", "Min FPS", "Max FPS", "Std Dev"]
+    if "steps_per_second" in df.columns:
+        # Older CSVs predate multi-step batching and lack this column
+        aggs["steps_per_second"] = ["mean"]
+        columns.append("Avg Steps/s")
+    # Per-stage GPU ms (timestamp queries); empty when the device had none
+    for col in [c for c in df.columns if c.startswith("gpu_") and c.endswith("_ms")]:
+        if df[col].notna().any():
+            aggs[col] = ["mean"]
+            columns.append("GPU " + col[4:-3].replace("_", " ") + " ms")
     
-    summary.columns = ["Avg FPS", "Min FPS", "Max FPS", "Std Dev"]
+    summary = df.groupby(["grid_size", "sim_speed"]).agg(aggs).round(1)
+    
+    summary.columns = columns
     summary = summary.reset_index()
     
     # Save as CSV
@@ -185,6 +262,11 @@ def main():
     else:
         print("No benchmark data to plot")
     
+    frames = load_frame_data()
+    if frames is not None:
+        print()
+        plot_frame_time_distribution(frames)
+    
     print("\nDone!")
 
 if __name__ == "__main__":
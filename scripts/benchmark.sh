@@ -16,8 +16,36 @@ BIN_DIR="$PROJECT_ROOT/build/bin"
 # Output directories (absolute paths)
 RESULTS_DIR="$PROJECT_ROOT/benchmark_results"
 RECORDINGS_DIR="$PROJECT_ROOT/benchmark_recordings"
+FRAMES_DIR="$RESULTS_DIR/frames"   # Per-frame logs, percentile summaries, histograms
 mkdir -p "$RESULTS_DIR" "$RECORDINGS_DIR"
 
+# Headless mode: raw simulation throughput, no X server or recording needed
+#   HEADLESS=1 STEPS=2000 ./scripts/benchmark.sh
+if [ "${HEADLESS:-0}" = "1" ]; then
+    STEPS=${STEPS:-1000}
+    echo "========================================"
+    echo "Living Worlds Headless Benchmark"
+    echo "========================================"
+    echo "Grid sizes: ${GRIDS[*]}"
+    echo "Steps per test: ${STEPS}"
+    echo "========================================"
+    
+    cd "$BIN_DIR"
+    echo "grid_size,steps,seconds,steps_per_second,cells_per_second" > "$RESULTS_DIR/headless.csv"
+    for grid in "${GRIDS[@]}"; do
+        echo ""
+        echo "Testing: Grid=${grid}"
+        ./LivingWorlds --headless --benchmark --grid "$grid" --steps "$STEPS"
+        tail -n +2 "benchmark_headless_${grid}.csv" >> "$RESULTS_DIR/headless.csv"
+        rm -f "benchmark_headless_${grid}.csv"
+    done
+    
+    echo ""
+    echo "=== HEADLESS SUMMARY ===" | tee "$RESULTS_DIR/headless_summary.txt"
+    tail -n +2 "$RESULTS_DIR/headless.csv" | awk -F',' '{printf "grid%s: %.1f steps/s, %.3g cells/s\n", $1, $4, $5}' | tee -a "$RESULTS_DIR/headless_summary.txt"
+    exit 0
+fi
+
 # Get actual screen size
 SCREEN_RES=$(xdpyinfo | awk '/dimensions/{print $2}' | head -1)
 SCREEN_WIDTH=$(echo $SCREEN_RES | cut -d'x' -f1)
@@ -83,8 +111,12 @@ for grid in "${GRIDS[@]}"; do
             echo "Warning: Recording not created"
         fi
         
-        # Move CSV to results directory
+        # Move CSVs to results directory
         mv "benchmark_${grid}_${speed_int}.csv" "$CSV_FILE" 2>/dev/null || true
+        mkdir -p "$FRAMES_DIR"
+        for kind in frames summary histogram; do
+            mv "benchmark_${grid}_${speed_int}_${kind}.csv" "$FRAMES_DIR/${OUTPUT_NAME}_${kind}.csv" 2>/dev/null || true
+        done
         
         echo "Completed: $OUTPUT_NAME"
         echo ""
@@ -106,9 +138,9 @@ echo ""
 
 # Aggregate all CSVs
 echo "Aggregating results..."
-echo "time,fps,frame_ms,grid_size,sim_speed,erosion,biome_ca,test_name" > "$RESULTS_DIR/combined.csv"
+echo "time,fps,frame_ms,grid_size,sim_speed,erosion,biome_ca,steps_per_second,test_name" > "$RESULTS_DIR/combined.csv"
 for csv in "$RESULTS_DIR"/*.csv; do
-    if [[ "$csv" != *"combined.csv" ]]; then
+    if [[ "$csv" != *"combined.csv" && "$csv" != *"headless.csv" ]]; then
         testname=$(basename "$csv" .csv)
         tail -n +2 "$csv" | while read line; do
             echo "$line,$testname" >> "$RESULTS_DIR/combined.csv"
@@ -122,10 +154,11 @@ echo ""
 # Generate summary
 echo "=== SUMMARY ===" | tee "$RESULTS_DIR/summary.txt"
 for csv in "$RESULTS_DIR"/*.csv; do
-    if [[ "$csv" != *"combined.csv" && "$csv" != *"summary.txt" ]]; then
+    if [[ "$csv" != *"combined.csv" && "$csv" != *"headless.csv" ]]; then
         testname=$(basename "$csv" .csv)
         avg_fps=$(tail -n +2 "$csv" | awk -F',' '{sum+=$2; count++} END {if(count>0) printf "%.1f", sum/count; else print "N/A"}')
-        echo "$testname: Avg FPS = $avg_fps" | tee -a "$RESULTS_DIR/summary.txt"
+        avg_sps=$(tail -n +2 "$csv" | awk -F',' 'NF>=8 {sum+=$8; count++} END {if(count>0) printf "%.1f", sum/count; else print "N/A"}')
+        echo "$testname: Avg FPS = $avg_fps, Avg Steps/s = $avg_sps" | tee -a "$RESULTS_DIR/summary.txt"
     fi
 done
 
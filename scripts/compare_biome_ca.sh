@@ -0,0 +1,37 @@
+#!/bin/bash
+# Tiled biome_ca.comp vs the baseline kernel (biome_ca_baseline.comp, --biome-ca-direct):
+# per-step state hashes must match exactly, then both are timed.
+#   STEPS=200 ./scripts/compare_biome_ca.sh
+
+set -e
+
+GRIDS=(2048 3072)
+STEPS=${STEPS:-200}
+
+PROJECT_ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+BIN_DIR="$PROJECT_ROOT/build/bin"
+RESULTS_DIR="$PROJECT_ROOT/benchmark_results/biome_ca"
+mkdir -p "$RESULTS_DIR"
+
+cd "$BIN_DIR"
+for grid in "${GRIDS[@]}"; do
+    echo "=== Grid ${grid}: ${STEPS} steps ==="
+    ./LivingWorlds --verify "$STEPS" --grid "$grid" --biome-ca-direct \
+        --write-golden "$RESULTS_DIR/golden_direct_${grid}.csv"
+    ./LivingWorlds --verify "$STEPS" --grid "$grid" \
+        --golden "$RESULTS_DIR/golden_direct_${grid}.csv"
+done
+
+GRID_LIST=$(IFS=,; echo "${GRIDS[*]}")
+./LivingWorldsBench --grids "$GRID_LIST" --biome-ca-direct --out "$RESULTS_DIR/direct.json"
+./LivingWorldsBench --grids "$GRID_LIST" --out "$RESULTS_DIR/tiled.json"
+
+# ms/step of the biome_ca rows, one "grid ms" pair per line
+biome_ca_ms() {
+    grep '"kernel": "biome_ca"' "$1" | sed -E 's/.*"grid": ([0-9]+).*"ms_per_step": ([0-9.e+-]+).*/\1 \2/'
+}
+
+echo ""
+echo "=== biome_ca ms/step: direct vs tiled ===" | tee "$RESULTS_DIR/summary.txt"
+join <(biome_ca_ms "$RESULTS_DIR/direct.json") <(biome_ca_ms "$RESULTS_DIR/tiled.json") |
+    awk '{printf "grid%s: %.3f -> %.3f ms (%.2fx)\n", $1, $2, $3, $2 / $3}' | tee -a "$RESULTS_DIR/summary.txt"
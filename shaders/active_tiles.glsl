@@ -0,0 +1,32 @@
+// Active-tile bindings for the ACTIVE_TILES kernel variants (set 1).
+// Erosion workgroups come from vkCmdDispatchIndirect over the list
+// tile_compact.comp built, one 16x16 tile each; the biome CA still covers the
+// whole grid. A kernel flags its tile when any output cell differs from its
+// input, which re-activates it (and its neighbours) for the next two steps.
+#ifndef ACTIVE_TILES_GLSL
+#define ACTIVE_TILES_GLSL
+
+// Bit 0: changed this step. Bit 1: changed the step before, carried over by
+// tile_compact.comp, so this is a read-modify-write.
+layout(set = 1, binding = 1) buffer TileFlagsOut {
+    uint flags[];
+} tileFlagsOut;
+
+layout(set = 1, binding = 2) readonly buffer ActiveTileList {
+    uint dispatchX;  // VkDispatchIndirectCommand
+    uint dispatchY;
+    uint dispatchZ;
+    uint tiles[];    // (ty << 16) | tx
+} activeTiles;
+
+ivec2 activeTileCoord() {
+    uint packed = activeTiles.tiles[gl_WorkGroupID.x];
+    return ivec2(packed & 0xFFFFu, packed >> 16);
+}
+
+void markTileChanged(ivec2 tile, ivec2 size) {
+    int tilesX = (size.x + 15) / 16;
+    atomicOr(tileFlagsOut.flags[tile.y * tilesX + tile.x], 1u);
+}
+
+#endif
@@ -0,0 +1,62 @@
+// Bit-sliced biome state (--bitsliced). Biome IDs (0-8) are stored as 4
+// bitplanes, one uint per 32 horizontally adjacent cells: bit i of word wx
+// is cell x = 32 * wx + i. Plane p holds bit p of the ID.
+// Buffer layout: words[(plane * height + y) * rowWords + wx], rowWords = width / 32.
+// Bound as set 1 per parity p: binding 0 = planes[p], binding 1 = planes[1 - p],
+// mirroring Bio[p] / Bio[1 - p] in the image path.
+#ifndef BIOME_BITPLANES_GLSL
+#define BIOME_BITPLANES_GLSL
+
+const int BIOME_PLANES = 4;
+
+int planeWordIndex(int plane, int wx, int y, ivec2 size) {
+    return (plane * size.y + y) * (size.x / 32) + wx;
+}
+
+// Per-cell counts 0..8 as 4 bit-sliced words (bit i of sN = bit N of cell i's count)
+struct SlicedCount {
+    uint s0, s1, s2, s3;
+};
+
+// Carry-save adder tree over the 8 neighbour masks
+SlicedCount count8(uint n[8]) {
+    // Three full/half adders reduce 8 ones to 3 ones + 3 twos
+    uint a0 = n[0] ^ n[1] ^ n[2];
+    uint a1 = (n[0] & n[1]) | (n[2] & (n[0] ^ n[1]));
+    uint b0 = n[3] ^ n[4] ^ n[5];
+    uint b1 = (n[3] & n[4]) | (n[5] & (n[3] ^ n[4]));
+    uint c0 = n[6] ^ n[7];
+    uint c1 = n[6] & n[7];
+
+    // Ones column
+    SlicedCount r;
+    r.s0 = a0 ^ b0 ^ c0;
+    uint d1 = (a0 & b0) | (c0 & (a0 ^ b0));
+
+    // Twos column: a1, b1, c1, d1
+    uint t = a1 ^ b1 ^ c1;
+    uint t2 = (a1 & b1) | (c1 & (a1 ^ b1));
+    r.s1 = t ^ d1;
+    uint u2 = t & d1;
+
+    // Fours column: t2, u2 (at most one of them plus 8 = 1000b)
+    r.s2 = t2 ^ u2;
+    r.s3 = t2 & u2;
+    return r;
+}
+
+int slicedCountAt(SlicedCount c, int i) {
+    return int(((c.s0 >> i) & 1u) | (((c.s1 >> i) & 1u) << 1) |
+               (((c.s2 >> i) & 1u) << 2) | (((c.s3 >> i) & 1u) << 3));
+}
+
+// Mask of cells whose ID equals `id`, from the 4 planes
+uint planeMatch(uint p[4], uint id) {
+    uint m = 0xFFFFFFFFu;
+    for (int b = 0; b < BIOME_PLANES; b++) {
+        m &= ((id >> b) & 1u) != 0u ? p[b] : ~p[b];
+    }
+    return m;
+}
+
+#endif
@@ -0,0 +1,15 @@
+// Discrete biome IDs shared by the simulation kernels (Week 5.5)
+#ifndef BIOME_IDS_GLSL
+#define BIOME_IDS_GLSL
+
+const uint WATER   = 0u;
+const uint SAND    = 1u;
+const uint GRASS   = 2u;
+const uint FOREST  = 3u;
+const uint DESERT  = 4u;
+const uint ROCK    = 5u;
+const uint SNOW    = 6u;
+const uint TUNDRA  = 7u;
+const uint WETLAND = 8u;
+
+#endif
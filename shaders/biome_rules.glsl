@@ -0,0 +1,301 @@
+// Discrete biome CA rules shared by biome_ca.comp and sim_fused.comp
+#ifndef BIOME_RULES_GLSL
+#define BIOME_RULES_GLSL
+
+#include "biome_ids.glsl"
+
+// Matches BiomePushConstants on the host
+struct BiomeParams {
+    // Forest/Desert spreading
+    float forestChance;
+    float desertChance;
+    int forestThreshold;
+    int desertThreshold;
+    float time;
+    
+    // Wetland dynamics
+    float wetlandFormRate;
+    float wetlandSpreadRate;
+    float wetlandMaxHeight;
+    
+    // Mountain dynamics
+    float snowMeltRate;
+    float snowSpreadRate;
+    float tundraSpreadRate;
+    float treeLineHeight;
+};
+
+// Good 2D hash
+float hash2D(ivec2 p, float seed) {
+    vec3 p3 = fract(vec3(p.xyx) * vec3(0.1031, 0.1030, 0.0973) + seed);
+    p3 += dot(p3, p3.yxz + 33.33);
+    return fract((p3.x + p3.y) * p3.z);
+}
+
+// Neighbour counts over the 8-cell Moore neighbourhood
+struct BiomeCounts {
+    int forest;
+    int desert;
+    int water;
+    int sand;
+    int wetland;
+    int snow;
+    int tundra;
+    int same;   // Neighbours matching the current cell's biome
+};
+
+// Single pass histogram. Counts are at most 8, so biomes 0-7 fit in one
+// nibble each of a uint; WETLAND gets its own counter.
+struct BiomeHistogram {
+    uint packed;
+    int wetland;
+    int same;
+};
+
+BiomeHistogram emptyHistogram() {
+    return BiomeHistogram(0u, 0, 0);
+}
+
+void addNeighbor(inout BiomeHistogram hist, uint b, uint current) {
+    if (b == current) hist.same++;
+    if (b < WETLAND) hist.packed += 1u << (b * 4u);
+    else if (b == WETLAND) hist.wetland++;
+}
+
+int histogramCount(BiomeHistogram hist, uint biome) {
+    return int(bitfieldExtract(hist.packed, int(biome * 4u), 4));
+}
+
+BiomeCounts toCounts(BiomeHistogram hist) {
+    BiomeCounts c;
+    c.forest = histogramCount(hist, FOREST);
+    c.desert = histogramCount(hist, DESERT);
+    c.water = histogramCount(hist, WATER);
+    c.sand = histogramCount(hist, SAND);
+    c.wetland = hist.wetland;
+    c.snow = histogramCount(hist, SNOW);
+    c.tundra = histogramCount(hist, TUNDRA);
+    c.same = hist.same;
+    return c;
+}
+
+// Next biome for the cell at pos with (post-erosion) height h
+uint applyBiomeRules(ivec2 pos, float h, uint current, BiomeCounts c, BiomeParams p) {
+    uint newBiome = current;
+    
+    float rF = hash2D(pos, p.time * 0.01);
+    float rD = hash2D(pos, p.time * 0.01 + 100.0);
+    float rT = hash2D(pos, p.time * 0.01 + 200.0);
+    float rS = hash2D(pos, 0.0);
+
+    // LOCATION CHECKS - Only apply bias at IMMEDIATE proximity
+    // Most cells should be NEUTRAL for fair competition
+    bool nearWater = (c.water >= 1 || c.sand >= 1);  // Touching water/sand
+    // No "inland" bias - removed to keep balance
+    // All non-coastal cells are neutral
+
+    // HEIGHT CONSTRAINTS (now with dynamic spreading)
+    if (h < 0.30) {
+        newBiome = WATER;
+    } else if (h < 0.35) {
+        newBiome = SAND;
+    } else if (h > 0.85) {
+        // Peak elevation - always snow
+        newBiome = SNOW;
+    } else if (h > 0.72) {
+        // Mountain zone - height-based defaults with dynamic transitions
+        
+        // Step 1: Set height-based defaults for cells that need initialization
+        if (current == GRASS || current == WATER || current == SAND || current == DESERT || current == FOREST) {
+            // Convert lowland biomes to mountain biomes based on height
+            if (h > 0.82) {
+                newBiome = SNOW;  // High mountain
+            } else if (h > 0.78) {
+                newBiome = ROCK;  // Upper mountain
+            } else {
+                newBiome = TUNDRA;  // Alpine meadow
+            }
+        }
+        
+        // Step 2: Dynamic transitions (only for cells already in mountain biomes)
+        // Snow melts into tundra at lower elevations
+        if (current == SNOW && h < 0.82) {
+            if (rT < p.snowMeltRate) {
+                newBiome = TUNDRA;
+            }
+        }
+        
+        // Snow spreads downhill from existing snow
+        if (current == ROCK && c.snow >= 2 && h > 0.78) {
+            if (rT < p.snowSpreadRate) {
+                newBiome = SNOW;
+            }
+        }
+        if (current == TUNDRA && c.snow >= 3 && h > 0.76) {
+            if (rT < p.snowSpreadRate * 0.5) {
+                newBiome = SNOW;
+            }
+        }
+        
+        // Tundra spreads from existing tundra
+        if (current == ROCK && c.tundra >= 2 && h < 0.80) {
+            if (rT < p.tundraSpreadRate) {
+                newBiome = TUNDRA;
+            }
+        }
+        
+        // Tree line: tundra can become forest at lower edge
+        if (current == TUNDRA && h < p.treeLineHeight && c.forest >= 2) {
+            if (rT < p.tundraSpreadRate * 0.3) {
+                newBiome = FOREST;
+            }
+        }
+    } else {
+        // MAIN LAND (exclude WETLAND - it's a valid stable biome)
+        if (current == WATER || current == SAND || current == ROCK || 
+            current == SNOW || current == TUNDRA) {
+            newBiome = GRASS;
+        }
+        
+        // CLUSTER STABILITY
+        bool isDeepInCluster = (c.same >= 6);
+        bool isAtEdge = (c.same <= 3);
+        
+        // SEEDING (first 10 steps)
+        if (p.time < 10.0 && p.forestChance > 0.01 && current == GRASS) {
+            float threshold = 0.025 * p.forestChance;
+            if (rS < threshold) {
+                // Coast seeds forest, else 50/50
+                if (nearWater) {
+                    newBiome = FOREST;
+                } else {
+                    newBiome = ((pos.x + pos.y) % 2 == 0) ? FOREST : DESERT;
+                }
+            }
+        }
+        
+        // === GRASS: Location-aware spreading ===
+        if (current == GRASS) {
+            // Base spread chances scaled by push constants
+            float forestSpread = 0.05 * p.forestChance;
+            float desertSpread = 0.05 * p.desertChance;
+            
+            // Coastal modifiers
+            if (nearWater) {
+                forestSpread *= 1.5;  // Forest +50% near water
+                desertSpread *= 0.5;  // Desert -50% near water
+            }
+            
+            // Use push constant thresholds
+            bool forestWants = (c.forest >= p.forestThreshold && rF < forestSpread);
+            bool desertWants = (c.desert >= p.desertThreshold && rD < desertSpread);
+            
+            if (forestWants && desertWants) {
+                newBiome = (rT < 0.5) ? FOREST : DESERT;
+            } else if (forestWants) {
+                newBiome = FOREST;
+            } else if (desertWants) {
+                newBiome = DESERT;
+            }
+            
+            // Spontaneous seeding
+            float seedRate = (p.forestChance < 0.01) ? 0.003 : 0.0005;
+            if (rT < seedRate && newBiome == GRASS) {
+                newBiome = (rF < 0.5) ? FOREST : DESERT;
+            }
+        }
+        
+        // === FOREST ===
+        if (current == FOREST) {
+            // Deep in cluster - very stable
+            if (isDeepInCluster) {
+                // Almost never changes
+                if (c.desert >= 6 && rF < 0.005) {
+                    newBiome = GRASS;
+                }
+            } else if (isAtEdge) {
+                // At edge - can be converted
+                if (c.desert >= 3 && rF < 0.04) {
+                    newBiome = GRASS;
+                }
+            }
+            // Isolation death
+            if (c.same == 0 && rF < 0.1) {
+                newBiome = GRASS;
+            }
+            // Tree line: forest above tree line becomes tundra
+            // No tundra neighbor required - height alone determines tree line
+            if (h > p.treeLineHeight) {
+                if (rT < p.tundraSpreadRate) {
+                    newBiome = TUNDRA;
+                }
+            }
+        }
+        
+        // === DESERT === (same as forest)
+        if (current == DESERT) {
+            if (isDeepInCluster) {
+                if (c.forest >= 6 && rD < 0.005) {
+                    newBiome = GRASS;
+                }
+            } else if (isAtEdge) {
+                if (c.forest >= 3 && rD < 0.04) {
+                    newBiome = GRASS;
+                }
+            }
+            if (c.same == 0 && rD < 0.1) {
+                newBiome = GRASS;
+            }
+        }
+        
+        // === WETLAND ===
+        // Forms where forest meets water at low elevation
+        if (current == FOREST && nearWater && h < p.wetlandMaxHeight && h > 0.35) {
+            if (rT < p.wetlandFormRate) {
+                newBiome = WETLAND;
+            }
+        }
+        
+        // Wetland spreads along water edges (thicker strips)
+        if (current == GRASS && nearWater && c.wetland >= 1 && h < p.wetlandMaxHeight) {
+            if (rT < p.wetlandSpreadRate) {
+                newBiome = WETLAND;
+            }
+        }
+        
+        // Wetland grows from forest near water (grows inland)
+        if (current == GRASS && c.wetland >= 2 && c.forest >= 1 && h < p.wetlandMaxHeight) {
+            if (rT < p.wetlandSpreadRate * 0.6) {
+                newBiome = WETLAND;
+            }
+        }
+        
+        // Wetlands reclaim adjacent sand (vegetation blocks sand)
+        if (current == SAND && c.wetland >= 2) {
+            if (rT < p.wetlandSpreadRate * 0.4) {
+                newBiome = WETLAND;
+            }
+        }
+        
+        // Wetland blocks sand formation
+        if (current == GRASS && nearWater && c.wetland > 0 && h < 0.4) {
+            // Cannot become sand if wetland nearby
+            if (newBiome == SAND) {
+                newBiome = GRASS;
+            }
+        }
+        
+        // Wetland stability (very stable)
+        if (current == WETLAND) {
+            // Wetland persists - only very slowly dries up if isolated from water
+            if (!nearWater && c.wetland == 0 && rT < 0.005) {
+                newBiome = GRASS;  // Very rare drying
+            }
+            // Otherwise wetland persists
+        }
+    }
+
+    return newBiome;
+}
+
+#endif
@@ -0,0 +1,66 @@
+// Erosion rule shared by erosion.comp and sim_fused.comp
+#ifndef EROSION_RULES_GLSL
+#define EROSION_RULES_GLSL
+
+#include "biome_ids.glsl"
+
+// Matches ErosionPushConstants on the host
+struct ErosionParams {
+    float rate;           // Base erosion rate (0.1-0.99)
+    float bidrEnabled;    // 0.0 = off, 1.0 = on
+    float forestMult;     // Forest erosion multiplier (0.05-1.0)
+    float desertMult;     // Desert erosion multiplier (1.0-2.0)
+    float sandMult;       // Sand erosion multiplier (1.5-4.0)
+    float coastalBonus;   // Extra erosion near water (1.0-2.0)
+};
+
+// New height for a cell given its 8-neighbour average height
+float erodeHeight(float h, float neighborAvg, uint biome, bool hasWaterNeighbor, ErosionParams params) {
+    // Calculate erosion rate with bidir feedback
+    float finalRate = params.rate;
+    
+    if (params.bidrEnabled > 0.5) {
+        // Biome-specific erosion modifiers
+        if (biome == FOREST) {
+            finalRate *= params.forestMult; // Forest protects terrain
+        } else if (biome == DESERT) {
+            finalRate *= params.desertMult; // Desert erodes faster
+        } else if (biome == SAND) {
+            finalRate *= params.sandMult;   // Sand very erosive
+            if (hasWaterNeighbor) {
+                finalRate *= params.coastalBonus; // Wave action bonus
+            }
+        } else if (biome == ROCK) {
+            finalRate *= 0.1;  // Rock very resistant
+        } else if (biome == SNOW) {
+            finalRate *= 0.05; // Snow/Ice very resistant
+        } else if (biome == TUNDRA) {
+            finalRate *= 0.3;  // Tundra moderately resistant (permafrost)
+        } else if (biome == WETLAND) {
+            finalRate *= 0.05; // Wetland very resistant (vegetation stabilizes)
+        }
+        
+        // Any coastal cell gets bonus erosion (even non-sand)
+        // But wetlands protect coastlines
+        if (hasWaterNeighbor && biome != WATER && biome != FOREST && biome != WETLAND) {
+            finalRate *= 1.2;  // All coastal areas erode faster
+        }
+    }
+    
+    // Soft clamp: preserve relative differences while capping at 0.95
+    // Uses formula: scaled = target * rate / (rate + offset) where offset controls curve
+    // This ensures higher multipliers still give higher rates, but never exceed 0.95
+    if (finalRate > 0.5) {
+        // Soft scaling for high rates
+        finalRate = 0.5 + (finalRate - 0.5) / (1.0 + (finalRate - 0.5) * 0.5);
+    }
+    finalRate = clamp(finalRate, 0.0, 0.95);
+    
+    // Move towards neighbor average
+    float newH = h + (neighborAvg - h) * finalRate;
+    
+    // Clamp
+    return clamp(newH, 0.0, 1.0);
+}
+
+#endif
@@ -0,0 +1,18 @@
+// Heightmap storage format (--height-format R16_UNORM / R32_SFLOAT / RGBA8_UNORM).
+// Height images are declared without a format qualifier so one SPIR-V module
+// serves every format; shaders that imageLoad them need
+// GL_EXT_shader_image_load_formatted. HEIGHT_LEVELS is the number of steps
+// the store rounds to (0 = float, no rounding), set by the host.
+#ifndef HEIGHT_FORMAT_GLSL
+#define HEIGHT_FORMAT_GLSL
+
+layout(constant_id = 10) const float HEIGHT_LEVELS = 65535.0;
+
+// Round like the height store, so a value kept in registers or shared
+// memory matches what the next imageLoad would return
+float quantizeHeight(float h) {
+    if (HEIGHT_LEVELS <= 0.0) return h;
+    return round(clamp(h, 0.0, 1.0) * HEIGHT_LEVELS) / HEIGHT_LEVELS;
+}
+
+#endif
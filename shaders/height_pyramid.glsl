@@ -0,0 +1,30 @@
+// Queries on the min/max/mean height pyramid (height_pyramid.comp).
+// A level k cell covers 2^(k+1) heightmap texels per side; the last cell of
+// a row/column also covers any remainder, hence the clamps.
+
+// Conservative height range over heightmap texels [lo, hi] (inclusive), from
+// at most 2x2 cells of the finest level that spans it.
+// x = min, y = max, z = mean (approximate), all in [0, 1].
+vec3 heightPyramidRange(usampler2D pyramid, ivec2 lo, ivec2 hi) {
+    int levels = textureQueryLevels(pyramid);
+    int k = 0;
+    while (k + 1 < levels && any(greaterThan((hi >> (k + 1)) - (lo >> (k + 1)), ivec2(1)))) k++;
+
+    ivec2 size = textureSize(pyramid, k);
+    ivec2 c0 = min(lo >> (k + 1), size - 1);
+    ivec2 c1 = min(hi >> (k + 1), size - 1);
+    uint qmin = 65535u;
+    uint qmax = 0u;
+    float sum = 0.0;
+    float count = 0.0;
+    for (int y = c0.y; y <= c1.y; y++) {
+        for (int x = c0.x; x <= c1.x; x++) {
+            uvec4 v = texelFetch(pyramid, ivec2(x, y), k);
+            qmin = min(qmin, v.r);
+            qmax = max(qmax, v.g);
+            sum += float(v.b);
+            count += 1.0;
+        }
+    }
+    return vec3(float(qmin), float(qmax), sum / count) / 65535.0;
+}
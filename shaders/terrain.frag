@@ -144,7 +144,7 @@ void main() {
     }
     
     // === BIOME EDGE DETECTION ===
-    vec2 texelSize = vec2(1.0 / 3072.0);
+    vec2 texelSize = 1.0 / vec2(textureSize(biomeMap, 0));
     uint biomeN = texture(biomeMap, inUV + vec2(0, texelSize.y)).r;
     uint biomeS = texture(biomeMap, inUV - vec2(0, texelSize.y)).r;
     uint biomeE = texture(biomeMap, inUV + vec2(texelSize.x, 0)).r;
@@ -1,7 +1,5 @@
 #version 450
 
-layout(location = 0) in vec2 inPos; // Grid position (u, v)
-
 layout(location = 0) out vec2 outUV;
 layout(location = 1) out vec3 outWorldPos;
 layout(location = 2) out float outHeight;
@@ -10,31 +8,72 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
     mat4 model;
     mat4 view;
     mat4 proj;
+    mat4 invView;
     float time;
     int vizMode;
 } ubo;
 
+// CDLOD patches selected on the host this frame (TerrainLod), one per instance
+struct TerrainPatch {
+    uvec2 origin;      // Texel of the patch's corner
+    uint level;        // Quad size is 2^level texels
+    float morphStart;
+    float morphEnd;
+    uint pad0, pad1, pad2;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer TerrainPatches {
+    TerrainPatch patches[];
+};
+
 // We need to sample the heightmap in the vertex shader
 // This requires the sampler to be available.
-// We will use the same descriptor set layout as visualization, 
+// We will use the same descriptor set layout as visualization,
 // binding 0 is heightmap.
 layout(set = 1, binding = 0) uniform sampler2D heightMap;
 
+// Quads per patch side; gl_VertexIndex is a vertex id in the (PATCH_QUADS + 1)^2 grid
+layout(constant_id = 0) const uint PATCH_QUADS = 32;
+
+// Heightmap texel under a grid vertex; the far edge repeats the last texel
+float heightAt(vec2 texel, ivec2 size) {
+    return texelFetch(heightMap, min(ivec2(texel), size - 1), 0).r;
+}
+
 void main() {
-    outUV = inPos;
-    
-    // Sample height
-    // Note: Vertex Texture Fetch. Ensure texture is accessible.
-    float height = texture(heightMap, inPos).r;
+    TerrainPatch node = patches[gl_InstanceIndex];
+    uint side = PATCH_QUADS + 1u;
+    uint vertexId = uint(gl_VertexIndex);
+    vec2 inPos = vec2(vertexId % side, vertexId / side); // Patch grid position (0..PATCH_QUADS)
+    ivec2 size = textureSize(heightMap, 0);
+    float quad = float(1u << node.level);
+
+    // Morph factor from the unmorphed vertex, measured on y = 0 like the
+    // host selection does, so neighbouring patches agree along their seams
+    vec2 texel = vec2(node.origin) + inPos * quad;
+    vec2 world = min(texel, vec2(size)) / vec2(size) - 0.5;
+    vec3 cameraPos = ubo.invView[3].xyz;
+    float dist = length(vec3(cameraPos.x - world.x, cameraPos.y, cameraPos.z - world.y));
+    float morph = clamp((dist - node.morphStart) / (node.morphEnd - node.morphStart), 0.0, 1.0);
+
+    // Odd vertices slide onto their even neighbour, so a fully morphed patch
+    // is the next level's grid and meets a coarser neighbour without cracks
+    vec2 coarsePos = inPos - fract(inPos * 0.5) * 2.0;
+    vec2 coarseTexel = vec2(node.origin) + coarsePos * quad;
+    texel = mix(texel, coarseTexel, morph);
+    float height = mix(heightAt(vec2(node.origin) + inPos * quad, size), heightAt(coarseTexel, size), morph);
+
+    vec2 uv = min(texel, vec2(size)) / vec2(size);
+    outUV = uv;
     outHeight = height;
-    
+
     // Scale height for visualization
-    float heightScale = 0.22; 
-    
-    vec3 localPos = vec3(inPos.x - 0.5, height * heightScale, inPos.y - 0.5);
-    
+    float heightScale = 0.22;
+
+    vec3 localPos = vec3(uv.x - 0.5, height * heightScale, uv.y - 0.5);
+
     gl_Position = ubo.proj * ubo.view * ubo.model * vec4(localPos, 1.0);
-    
+
     // Pass world position to fragment shader for lighting/fog
     outWorldPos = (ubo.model * vec4(localPos, 1.0)).xyz;
 }
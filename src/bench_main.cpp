@@ -0,0 +1,141 @@
+// LivingWorldsBench: compute-only throughput of each simulation stage across
+// grid sizes, written as JSON. Needs no display, so it runs on lavapipe.
+#include "living_worlds.hpp"
+#include "cli_args.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: LivingWorldsBench [options]\n"
+              << "Options:\n"
+              << "  --grids LIST      Comma-separated grid sizes, multiples of 16 (default: 512,1024,2048,4096,8192)\n"
+              << "  --warmup N        Untimed dispatches per kernel (default: 3)\n"
+              << "  --iterations N    Timed dispatches per kernel (default: 20)\n"
+              << "  --height-format F Heightmap format: r16 (default), r32f or rgba8\n"
+              << "  --biome-ca-direct Time the baseline (pre-tiling) biome CA kernel instead\n"
+              << "  --out FILE        JSON results (default: bench_results.json)\n"
+              << "  --help            Show this help message\n";
+}
+
+struct Result {
+    uint32_t grid;
+    KernelTiming timing;
+};
+
+// The device name comes from the driver, so it may hold quotes or control
+// characters
+std::string json_escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (hasArg(argc, argv, "--help")) {
+        printUsage();
+        return 0;
+    }
+
+    std::vector<uint32_t> grids;
+    std::stringstream gridList(getArgString(argc, argv, "--grids", "512,1024,2048,4096,8192"));
+    for (std::string item; std::getline(gridList, item, ',');) {
+        int grid = atoi(item.c_str());
+        if (grid < 16 || grid % 16 != 0) {
+            std::cerr << "Grid sizes must be positive multiples of 16, got " << item << "\n";
+            return 1;
+        }
+        grids.push_back(static_cast<uint32_t>(grid));
+    }
+    uint32_t warmup = static_cast<uint32_t>(std::max(getArgInt(argc, argv, "--warmup", 3), 0));
+    uint32_t iterations = static_cast<uint32_t>(std::max(getArgInt(argc, argv, "--iterations", 20), 1));
+    std::string outPath = getArgString(argc, argv, "--out", "bench_results.json");
+
+    ProfileConfig config;
+    config.biomeCADirect = hasArg(argc, argv, "--biome-ca-direct");
+    const char* heightFormat = getArgString(argc, argv, "--height-format", "r16");
+    if (strcmp(heightFormat, "r16") == 0) {
+        config.heightFormat = VK_FORMAT_R16_UNORM;
+    } else if (strcmp(heightFormat, "r32f") == 0) {
+        config.heightFormat = VK_FORMAT_R32_SFLOAT;
+    } else if (strcmp(heightFormat, "rgba8") == 0) {
+        config.heightFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    } else {
+        std::cerr << "Unknown --height-format " << heightFormat << "\n";
+        printUsage();
+        return 1;
+    }
+
+    // One fresh device per grid size: images are sized at init
+    std::string deviceName;
+    std::string usedFormat;
+    std::vector<Result> results;
+    for (uint32_t grid : grids) {
+        std::cout << "=== Grid " << grid << "x" << grid << " ===\n";
+        config.gridSize = static_cast<int>(grid);
+        LivingWorlds app(config);
+        KernelBenchReport report = app.benchmark_kernels(warmup, iterations);
+        deviceName = report.device;
+        usedFormat = report.heightFormat;
+        for (const KernelTiming& timing : report.kernels) results.push_back({grid, timing});
+    }
+
+    std::ofstream json(outPath);
+    json << "{\n"
+         << "  \"device\": \"" << json_escape(deviceName) << "\",\n"
+         << "  \"height_format\": \"" << json_escape(usedFormat) << "\",\n"
+         << "  \"warmup\": " << warmup << ",\n"
+         << "  \"iterations\": " << iterations << ",\n"
+         << "  \"results\": [\n";
+
+    printf("\n%-6s %-13s %10s %10s %10s %12s\n", "grid", "kernel", "ms/step", "ns/cell", "GB/s", "steps/s");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        double cells = static_cast<double>(r.grid) * r.grid;
+        double seconds = r.timing.msPerStep * 1e-3;
+        double nsPerCell = r.timing.msPerStep * 1e6 / cells;
+        double gbPerSec = seconds > 0.0 ? r.timing.bytesPerStep / seconds * 1e-9 : 0.0;
+        double stepsPerSec = seconds > 0.0 ? 1.0 / seconds : 0.0;
+
+        json << "    {\"grid\": " << r.grid
+             << ", \"kernel\": \"" << r.timing.kernel << "\""
+             << ", \"ms_per_step\": " << r.timing.msPerStep
+             << ", \"ns_per_cell\": " << nsPerCell
+             << ", \"gb_per_s\": " << gbPerSec
+             << ", \"steps_per_s\": " << stepsPerSec
+             << ", \"bytes_per_step\": " << r.timing.bytesPerStep
+             << ", \"timer\": \"" << (r.timing.gpuTimer ? "gpu" : "wall") << "\"}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+        printf("%-6u %-13s %10.3f %10.3f %10.2f %12.1f%s\n", r.grid, r.timing.kernel, r.timing.msPerStep,
+               nsPerCell, gbPerSec, stepsPerSec, r.timing.gpuTimer ? "" : "  (wall clock)");
+    }
+    json << "  ]\n}\n";
+
+    if (!json) {
+        std::cerr << "Failed to write " << outPath << "\n";
+        return 1;
+    }
+    std::cout << "\nDevice: " << deviceName << "\nResults: " << outPath << "\n";
+    return 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+
+// Command-line helpers shared by LivingWorlds and LivingWorldsBench. Flags
+// are matched exactly; a flag's value is the argument right after it.
+inline bool hasArg(int argc, char* argv[], const char* arg) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], arg) == 0) return true;
+    }
+    return false;
+}
+
+inline int getArgInt(int argc, char* argv[], const char* arg, int defaultVal) {
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], arg) == 0) {
+            return atoi(argv[i + 1]);
+        }
+    }
+    return defaultVal;
+}
+
+inline const char* getArgString(int argc, char* argv[], const char* arg, const char* defaultVal) {
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], arg) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return defaultVal;
+}
+
+inline float getArgFloat(int argc, char* argv[], const char* arg, float defaultVal) {
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], arg) == 0) {
+            return static_cast<float>(atof(argv[i + 1]));
+        }
+    }
+    return defaultVal;
+}
@@ -0,0 +1,694 @@
+#include "cpu_sim.hpp"
+#include "living_worlds.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CPU_SIM_SSE2 1
+#include <immintrin.h>
+#endif
+
+// GCC/Clang build the AVX2 kernel for any x86 target and pick it at
+// runtime; other compilers only when the whole build targets AVX2
+#if defined(CPU_SIM_SSE2) && (defined(__GNUC__) || defined(__AVX2__))
+#define CPU_SIM_AVX2 1
+#if defined(__GNUC__)
+#define CPU_SIM_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CPU_SIM_TARGET_AVX2
+#endif
+#endif
+
+namespace {
+
+// biome_ids.glsl
+enum Biome : uint32_t {
+    WATER = 0,
+    SAND = 1,
+    GRASS = 2,
+    FOREST = 3,
+    DESERT = 4,
+    ROCK = 5,
+    SNOW = 6,
+    TUNDRA = 7,
+    WETLAND = 8,
+};
+
+// floor() without a libm call: baseline x86-64 has no SSE4.1 roundss, and
+// the hashes below floor several times per cell
+float floor_fast(float v) {
+    if (!(std::fabs(v) < 2147483648.0f)) return std::floor(v);
+    float t = static_cast<float>(static_cast<int32_t>(v));
+    return t > v ? t - 1.0f : t;
+}
+
+float fract(float v) { return v - floor_fast(v); }
+
+// Store rounding of the height image (height_format.glsl quantizeHeight)
+float quantize(float h, float levels) {
+    if (levels <= 0.0f) return h;
+    return std::nearbyint(std::clamp(h, 0.0f, 1.0f) * levels) / levels;
+}
+
+// ---- noise_init.comp ----
+
+float hash12(float px, float py, float seed) {
+    px += seed;
+    py += seed;
+    px = fract(px * 5.3983f);
+    py = fract(py * 5.4427f);
+    float d = py * (px + 21.5351f) + px * (py + 14.3137f); // dot(p.yx, p.xy + vec2(21.5351, 14.3137))
+    px += d;
+    py += d;
+    return fract(px * py * 95.4337f);
+}
+
+float mix(float a, float b, float t) { return a * (1.0f - t) + b * t; }
+
+float value_noise(float px, float py, float seed) {
+    float ix = floor_fast(px), iy = floor_fast(py);
+    float fx = px - ix, fy = py - iy;
+    float ux = fx * fx * (3.0f - 2.0f * fx);
+    float uy = fy * fy * (3.0f - 2.0f * fy);
+    return mix(mix(hash12(ix, iy, seed), hash12(ix + 1.0f, iy, seed), ux),
+               mix(hash12(ix, iy + 1.0f, seed), hash12(ix + 1.0f, iy + 1.0f, seed), ux), uy);
+}
+
+float fbm(float px, float py, float seed) {
+    const float c = std::cos(0.5f), s = std::sin(0.5f);
+    float v = 0.0f;
+    float a = 0.5f;
+    for (int i = 0; i < 6; i++) {
+        v += a * value_noise(px, py, seed);
+        // rot = mat2(c, s, -s, c) is column-major in GLSL
+        float rx = c * px - s * py;
+        float ry = s * px + c * py;
+        px = rx * 2.0f + 100.0f;
+        py = ry * 2.0f + 100.0f;
+        a *= 0.5f;
+    }
+    return v;
+}
+
+// ---- erosion_rules.glsl ----
+
+float erosion_rate(uint32_t biome, bool hasWaterNeighbor, const ErosionPushConstants& params) {
+    float finalRate = params.rate;
+    if (params.bidrEnabled > 0.5f) {
+        if (biome == FOREST) {
+            finalRate *= params.forestMult;
+        } else if (biome == DESERT) {
+            finalRate *= params.desertMult;
+        } else if (biome == SAND) {
+            finalRate *= params.sandMult;
+            if (hasWaterNeighbor) finalRate *= params.coastalBonus;
+        } else if (biome == ROCK) {
+            finalRate *= 0.1f;
+        } else if (biome == SNOW) {
+            finalRate *= 0.05f;
+        } else if (biome == TUNDRA) {
+            finalRate *= 0.3f;
+        } else if (biome == WETLAND) {
+            finalRate *= 0.05f;
+        }
+        if (hasWaterNeighbor && biome != WATER && biome != FOREST && biome != WETLAND) {
+            finalRate *= 1.2f;
+        }
+    }
+    if (finalRate > 0.5f) {
+        finalRate = 0.5f + (finalRate - 0.5f) / (1.0f + (finalRate - 0.5f) * 0.5f);
+    }
+    return std::clamp(finalRate, 0.0f, 0.95f);
+}
+
+float erode_height(float h, float neighborSum, float rate, float levels) {
+    float neighborAvg = neighborSum / 8.0f;
+    float newH = std::clamp(h + (neighborAvg - h) * rate, 0.0f, 1.0f);
+    return quantize(newH, levels);
+}
+
+// One cell with explicit (clamped) neighbour columns; used at the grid
+// edges and for the tails the vector kernels leave
+float erode_cell(const float* up, const float* mid, const float* dn,
+                 const uint8_t* bUp, const uint8_t* bMid, const uint8_t* bDn,
+                 uint32_t x, uint32_t xl, uint32_t xr, const float* rateTable, float levels) {
+    // Same summation order as the shader's dy/dx loop
+    float sum = up[xl] + up[x] + up[xr] + mid[xl] + mid[xr] + dn[xl] + dn[x] + dn[xr];
+    bool water = bUp[xl] == WATER || bUp[x] == WATER || bUp[xr] == WATER ||
+                 bMid[xl] == WATER || bMid[xr] == WATER ||
+                 bDn[xl] == WATER || bDn[x] == WATER || bDn[xr] == WATER;
+    return erode_height(mid[x], sum, rateTable[(bMid[x] << 1) | (water ? 1 : 0)], levels);
+}
+
+// Rate table index ((biome << 1) | hasWaterNeighbor) for interior cells
+// [x0, x1) of a row
+void classify_row(const uint8_t* bUp, const uint8_t* bMid, const uint8_t* bDn,
+                  uint32_t x0, uint32_t x1, uint16_t* index, bool simd) {
+    uint32_t x = x0;
+#ifdef CPU_SIM_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    for (; simd && x + 16 <= x1; x += 16) {
+        auto load = [](const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+        __m128i water = _mm_cmpeq_epi8(load(bUp + x - 1), zero);
+        water = _mm_or_si128(water, _mm_cmpeq_epi8(load(bUp + x), zero));
+        water = _mm_or_si128(water, _mm_cmpeq_epi8(load(bUp + x + 1), zero));
+        water = _mm_or_si128(water, _mm_cmpeq_epi8(load(bMid + x - 1), zero));
+        water = _mm_or_si128(water, _mm_cmpeq_epi8(load(bMid + x + 1), zero));
+        water = _mm_or_si128(water, _mm_cmpeq_epi8(load(bDn + x - 1), zero));
+        water = _mm_or_si128(water, _mm_cmpeq_epi8(load(bDn + x), zero));
+        water = _mm_or_si128(water, _mm_cmpeq_epi8(load(bDn + x + 1), zero));
+        water = _mm_and_si128(water, one);
+
+        __m128i biome = load(bMid + x);
+        __m128i lo = _mm_or_si128(_mm_slli_epi16(_mm_unpacklo_epi8(biome, zero), 1), _mm_unpacklo_epi8(water, zero));
+        __m128i hi = _mm_or_si128(_mm_slli_epi16(_mm_unpackhi_epi8(biome, zero), 1), _mm_unpackhi_epi8(water, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(index + (x - x0)), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(index + (x - x0) + 8), hi);
+    }
+#endif
+    for (; x < x1; x++) {
+        bool water = bUp[x - 1] == WATER || bUp[x] == WATER || bUp[x + 1] == WATER ||
+                     bMid[x - 1] == WATER || bMid[x + 1] == WATER ||
+                     bDn[x - 1] == WATER || bDn[x] == WATER || bDn[x + 1] == WATER;
+        index[x - x0] = static_cast<uint16_t>((bMid[x] << 1) | (water ? 1 : 0));
+    }
+}
+
+// Interior erosion row kernels: cells [x0, x1), every x - 1 and x + 1 in
+// range. Each returns the first x it did not handle.
+using ErodeRowFn = uint32_t (*)(const float* up, const float* mid, const float* dn, const uint16_t* index,
+                                const float* rateTable, float* out, uint32_t x0, uint32_t x1, float levels);
+
+uint32_t erode_row_scalar(const float*, const float*, const float*, const uint16_t*,
+                          const float*, float*, uint32_t x0, uint32_t, float) {
+    return x0;
+}
+
+#ifdef CPU_SIM_SSE2
+uint32_t erode_row_sse2(const float* up, const float* mid, const float* dn, const uint16_t* index,
+                        const float* rateTable, float* out, uint32_t x0, uint32_t x1, float levels) {
+    const __m128 eighth = _mm_set1_ps(1.0f / 8.0f); // Exact, same as the division
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 lv = _mm_set1_ps(levels);
+    uint32_t x = x0;
+    for (; x + 4 <= x1; x += 4) {
+        __m128 sum = _mm_loadu_ps(up + x - 1);
+        sum = _mm_add_ps(sum, _mm_loadu_ps(up + x));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(up + x + 1));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(mid + x - 1));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(mid + x + 1));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(dn + x - 1));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(dn + x));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(dn + x + 1));
+
+        const uint16_t* i = index + (x - x0);
+        __m128 rate = _mm_setr_ps(rateTable[i[0]], rateTable[i[1]], rateTable[i[2]], rateTable[i[3]]);
+        __m128 h = _mm_loadu_ps(mid + x);
+        __m128 newH = _mm_add_ps(h, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(sum, eighth), h), rate));
+        newH = _mm_min_ps(_mm_max_ps(newH, zero), one);
+        if (levels > 0.0f) {
+            // cvtps rounds to nearest even, like nearbyint
+            newH = _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(newH, lv))), lv);
+        }
+        _mm_storeu_ps(out + x, newH);
+    }
+    return x;
+}
+#endif
+
+#ifdef CPU_SIM_AVX2
+CPU_SIM_TARGET_AVX2
+uint32_t erode_row_avx2(const float* up, const float* mid, const float* dn, const uint16_t* index,
+                        const float* rateTable, float* out, uint32_t x0, uint32_t x1, float levels) {
+    const __m256 eighth = _mm256_set1_ps(1.0f / 8.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 lv = _mm256_set1_ps(levels);
+    uint32_t x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        __m256 sum = _mm256_loadu_ps(up + x - 1);
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(up + x));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(up + x + 1));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(mid + x - 1));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(mid + x + 1));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(dn + x - 1));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(dn + x));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(dn + x + 1));
+
+        __m256i i = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(index + (x - x0))));
+        __m256 rate = _mm256_i32gather_ps(rateTable, i, 4);
+        __m256 h = _mm256_loadu_ps(mid + x);
+        __m256 newH = _mm256_add_ps(h, _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(sum, eighth), h), rate));
+        newH = _mm256_min_ps(_mm256_max_ps(newH, zero), one);
+        if (levels > 0.0f) {
+            newH = _mm256_div_ps(_mm256_round_ps(_mm256_mul_ps(newH, lv), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC), lv);
+        }
+        _mm256_storeu_ps(out + x, newH);
+    }
+    return x;
+}
+#endif
+
+bool has_avx2() {
+#if defined(CPU_SIM_AVX2) && defined(__GNUC__)
+    __builtin_cpu_init(); // May run before the libgcc constructor that normally does this
+    return __builtin_cpu_supports("avx2");
+#elif defined(CPU_SIM_AVX2)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Index into CpuSim::ISAS of the best path this build and CPU run
+uint32_t best_isa() {
+#ifdef CPU_SIM_AVX2
+    if (has_avx2()) return 0;
+#endif
+#ifdef CPU_SIM_SSE2
+    return 1;
+#else
+    return 2;
+#endif
+}
+
+ErodeRowFn erode_row_for(uint32_t isa) {
+#ifdef CPU_SIM_AVX2
+    if (isa == 0) return erode_row_avx2;
+#endif
+#ifdef CPU_SIM_SSE2
+    if (isa <= 1) return erode_row_sse2;
+#endif
+    return erode_row_scalar;
+}
+
+// ---- biome_rules.glsl ----
+
+float hash2D(int32_t x, int32_t y, float seed) {
+    float p3x = fract(static_cast<float>(x) * 0.1031f + seed);
+    float p3y = fract(static_cast<float>(y) * 0.1030f + seed);
+    float p3z = fract(static_cast<float>(x) * 0.0973f + seed);
+    float d = p3x * (p3y + 33.33f) + p3y * (p3x + 33.33f) + p3z * (p3z + 33.33f); // dot(p3, p3.yxz + 33.33)
+    p3x += d;
+    p3y += d;
+    p3z += d;
+    return fract((p3x + p3y) * p3z);
+}
+
+// The four random draws of applyBiomeRules for one cell
+struct CellHashes {
+    float rF, rD, rT, rS;
+};
+
+CellHashes cell_hashes(int32_t x, int32_t y, float time) {
+    float seed = time * 0.01f;
+    return {hash2D(x, y, seed), hash2D(x, y, seed + 100.0f), hash2D(x, y, seed + 200.0f), hash2D(x, y, 0.0f)};
+}
+
+#ifdef CPU_SIM_SSE2
+// Same operations as floor_fast()/hash2D(), four cells at a time
+__m128 floor_x4(__m128 v) {
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f)));
+}
+
+__m128 fract_x4(__m128 v) { return _mm_sub_ps(v, floor_x4(v)); }
+
+__m128 hash2D_x4(__m128 fx, __m128 fy, float seed) {
+    const __m128 s = _mm_set1_ps(seed);
+    const __m128 k = _mm_set1_ps(33.33f);
+    __m128 p3x = fract_x4(_mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(0.1031f)), s));
+    __m128 p3y = fract_x4(_mm_add_ps(_mm_mul_ps(fy, _mm_set1_ps(0.1030f)), s));
+    __m128 p3z = fract_x4(_mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(0.0973f)), s));
+    __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p3x, _mm_add_ps(p3y, k)), _mm_mul_ps(p3y, _mm_add_ps(p3x, k))),
+                          _mm_mul_ps(p3z, _mm_add_ps(p3z, k)));
+    p3x = _mm_add_ps(p3x, d);
+    p3y = _mm_add_ps(p3y, d);
+    p3z = _mm_add_ps(p3z, d);
+    return fract_x4(_mm_mul_ps(_mm_add_ps(p3x, p3y), p3z));
+}
+
+// Hashes of cells (x .. x + 3, y)
+void cell_hashes_x4(int32_t x, int32_t y, float time, CellHashes out[4]) {
+    __m128 fx = _mm_cvtepi32_ps(_mm_setr_epi32(x, x + 1, x + 2, x + 3));
+    __m128 fy = _mm_set1_ps(static_cast<float>(y));
+    float seed = time * 0.01f;
+    alignas(16) float r[4][4];
+    _mm_store_ps(r[0], hash2D_x4(fx, fy, seed));
+    _mm_store_ps(r[1], hash2D_x4(fx, fy, seed + 100.0f));
+    _mm_store_ps(r[2], hash2D_x4(fx, fy, seed + 200.0f));
+    _mm_store_ps(r[3], hash2D_x4(fx, fy, 0.0f));
+    for (int i = 0; i < 4; i++) out[i] = {r[0][i], r[1][i], r[2][i], r[3][i]};
+}
+#endif
+
+struct BiomeCounts {
+    int forest;
+    int desert;
+    int water;
+    int sand;
+    int wetland;
+    int snow;
+    int tundra;
+    int same;
+};
+
+uint32_t apply_biome_rules(int32_t x, int32_t y, float h, uint32_t current, const BiomeCounts& c,
+                           const BiomePushConstants& p, const CellHashes& r) {
+    uint32_t newBiome = current;
+
+    bool nearWater = (c.water >= 1 || c.sand >= 1);
+
+    if (h < 0.30f) {
+        newBiome = WATER;
+    } else if (h < 0.35f) {
+        newBiome = SAND;
+    } else if (h > 0.85f) {
+        newBiome = SNOW;
+    } else if (h > 0.72f) {
+        const float rT = r.rT;
+
+        if (current == GRASS || current == WATER || current == SAND || current == DESERT || current == FOREST) {
+            if (h > 0.82f) {
+                newBiome = SNOW;
+            } else if (h > 0.78f) {
+                newBiome = ROCK;
+            } else {
+                newBiome = TUNDRA;
+            }
+        }
+
+        if (current == SNOW && h < 0.82f) {
+            if (rT < p.snowMeltRate) newBiome = TUNDRA;
+        }
+        if (current == ROCK && c.snow >= 2 && h > 0.78f) {
+            if (rT < p.snowSpreadRate) newBiome = SNOW;
+        }
+        if (current == TUNDRA && c.snow >= 3 && h > 0.76f) {
+            if (rT < p.snowSpreadRate * 0.5f) newBiome = SNOW;
+        }
+        if (current == ROCK && c.tundra >= 2 && h < 0.80f) {
+            if (rT < p.tundraSpreadRate) newBiome = TUNDRA;
+        }
+        if (current == TUNDRA && h < p.treeLineHeight && c.forest >= 2) {
+            if (rT < p.tundraSpreadRate * 0.3f) newBiome = FOREST;
+        }
+    } else {
+        const float rF = r.rF, rD = r.rD, rT = r.rT, rS = r.rS;
+
+        if (current == WATER || current == SAND || current == ROCK ||
+            current == SNOW || current == TUNDRA) {
+            newBiome = GRASS;
+        }
+
+        bool isDeepInCluster = (c.same >= 6);
+        bool isAtEdge = (c.same <= 3);
+
+        if (p.time < 10.0f && p.forestChance > 0.01f && current == GRASS) {
+            float threshold = 0.025f * p.forestChance;
+            if (rS < threshold) {
+                if (nearWater) {
+                    newBiome = FOREST;
+                } else {
+                    newBiome = ((x + y) % 2 == 0) ? FOREST : DESERT;
+                }
+            }
+        }
+
+        if (current == GRASS) {
+            float forestSpread = 0.05f * p.forestChance;
+            float desertSpread = 0.05f * p.desertChance;
+            if (nearWater) {
+                forestSpread *= 1.5f;
+                desertSpread *= 0.5f;
+            }
+
+            bool forestWants = (c.forest >= p.forestThreshold && rF < forestSpread);
+            bool desertWants = (c.desert >= p.desertThreshold && rD < desertSpread);
+            if (forestWants && desertWants) {
+                newBiome = (rT < 0.5f) ? FOREST : DESERT;
+            } else if (forestWants) {
+                newBiome = FOREST;
+            } else if (desertWants) {
+                newBiome = DESERT;
+            }
+
+            float seedRate = (p.forestChance < 0.01f) ? 0.003f : 0.0005f;
+            if (rT < seedRate && newBiome == GRASS) {
+                newBiome = (rF < 0.5f) ? FOREST : DESERT;
+            }
+        }
+
+        if (current == FOREST) {
+            if (isDeepInCluster) {
+                if (c.desert >= 6 && rF < 0.005f) newBiome = GRASS;
+            } else if (isAtEdge) {
+                if (c.desert >= 3 && rF < 0.04f) newBiome = GRASS;
+            }
+            if (c.same == 0 && rF < 0.1f) newBiome = GRASS;
+            if (h > p.treeLineHeight) {
+                if (rT < p.tundraSpreadRate) newBiome = TUNDRA;
+            }
+        }
+
+        if (current == DESERT) {
+            if (isDeepInCluster) {
+                if (c.forest >= 6 && rD < 0.005f) newBiome = GRASS;
+            } else if (isAtEdge) {
+                if (c.forest >= 3 && rD < 0.04f) newBiome = GRASS;
+            }
+            if (c.same == 0 && rD < 0.1f) newBiome = GRASS;
+        }
+
+        if (current == FOREST && nearWater && h < p.wetlandMaxHeight && h > 0.35f) {
+            if (rT < p.wetlandFormRate) newBiome = WETLAND;
+        }
+        if (current == GRASS && nearWater && c.wetland >= 1 && h < p.wetlandMaxHeight) {
+            if (rT < p.wetlandSpreadRate) newBiome = WETLAND;
+        }
+        if (current == GRASS && c.wetland >= 2 && c.forest >= 1 && h < p.wetlandMaxHeight) {
+            if (rT < p.wetlandSpreadRate * 0.6f) newBiome = WETLAND;
+        }
+        if (current == SAND && c.wetland >= 2) {
+            if (rT < p.wetlandSpreadRate * 0.4f) newBiome = WETLAND;
+        }
+        if (current == GRASS && nearWater && c.wetland > 0 && h < 0.4f) {
+            if (newBiome == SAND) newBiome = GRASS;
+        }
+        if (current == WETLAND) {
+            if (!nearWater && c.wetland == 0 && rT < 0.005f) newBiome = GRASS;
+        }
+    }
+
+    return newBiome;
+}
+
+uint8_t biome_cell(int32_t x, int32_t y, float h, const uint8_t* bUp, const uint8_t* bMid, const uint8_t* bDn,
+                   uint32_t xl, uint32_t xr, const BiomePushConstants& params, const CellHashes& r) {
+    uint32_t current = bMid[x];
+    const uint8_t neighbors[8] = {bUp[xl], bUp[x], bUp[xr], bMid[xl], bMid[xr], bDn[xl], bDn[x], bDn[xr]};
+    int histogram[WETLAND + 1] = {};
+    int same = 0;
+    for (uint8_t b : neighbors) {
+        if (b == current) same++;
+        if (b <= WETLAND) histogram[b]++;
+    }
+    BiomeCounts c;
+    c.forest = histogram[FOREST];
+    c.desert = histogram[DESERT];
+    c.water = histogram[WATER];
+    c.sand = histogram[SAND];
+    c.wetland = histogram[WETLAND];
+    c.snow = histogram[SNOW];
+    c.tundra = histogram[TUNDRA];
+    c.same = same;
+    return static_cast<uint8_t>(apply_biome_rules(x, y, h, current, c, params, r));
+}
+
+} // namespace
+
+CpuSim::CpuSim(uint32_t width, uint32_t height, float levels, bool erosion, bool biomeCA, uint32_t threadCount)
+    : simWidth(width), simHeight(height), heightLevels(levels),
+      erosionEnabled(erosion), biomeCAEnabled(biomeCA),
+      tilesX((width + TILE_W - 1) / TILE_W), tilesY((height + TILE_H - 1) / TILE_H),
+      isaIndex(best_isa()), pool(threadCount) {
+    size_t cells = static_cast<size_t>(width) * height;
+    heights[0].assign(cells, 0.0f);
+    if (erosionEnabled) heights[1].assign(cells, 0.0f);
+    biomes[0].assign(cells, 0);
+    if (biomeCAEnabled) biomes[1].assign(cells, 0);
+    rateIndex.assign(static_cast<size_t>(pool.size()) * TILE_W, 0);
+    std::fill(std::begin(rateTable), std::end(rateTable), 0.0f);
+}
+
+bool CpuSim::set_isa(const char* name) {
+    for (uint32_t i = best_isa(); i < std::size(ISAS); i++) {
+        if (strcmp(ISAS[i], name) == 0) {
+            isaIndex = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* CpuSim::isa() const {
+    return ISAS[isaIndex];
+}
+
+void CpuSim::for_each_tile(const std::function<void(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t)>& body) {
+    pool.parallel_for(tile_count(), [&](uint32_t tile, uint32_t worker) {
+        uint32_t x0 = (tile % tilesX) * TILE_W;
+        uint32_t y0 = (tile / tilesX) * TILE_H;
+        body(x0, std::min(x0 + TILE_W, simWidth), y0, std::min(y0 + TILE_H, simHeight), worker);
+    });
+}
+
+void CpuSim::init_terrain(float seed) {
+    float* out = heights[0].data();
+    const float w = static_cast<float>(simWidth), h = static_cast<float>(simHeight);
+    for_each_tile([&](uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, uint32_t) {
+        for (uint32_t y = y0; y < y1; y++) {
+            for (uint32_t x = x0; x < x1; x++) {
+                float u = static_cast<float>(x) / w;
+                float v = static_cast<float>(y) / h;
+                float height = fbm(u * 4.0f, v * 4.0f, seed);
+                height = height * height * (3.0f - 2.0f * height);
+                height = height * 0.85f + 0.1f;
+                out[static_cast<size_t>(y) * simWidth + x] = quantize(std::clamp(height, 0.0f, 1.0f), heightLevels);
+            }
+        }
+    });
+    if (erosionEnabled) heights[1] = heights[0];
+    current = 0;
+    simStep = 0;
+}
+
+void CpuSim::init_biomes(const BiomePushConstants& params) {
+    BiomePushConstants p = params;
+    p.time = 0.0f;
+    std::fill(biomes[0].begin(), biomes[0].end(), 0);
+    if (biomeCAEnabled) {
+        std::fill(biomes[1].begin(), biomes[1].end(), 0);
+        update_biomes(heights[height_slot(0)].data(), biomes[0].data(), biomes[1].data(), p);
+        update_biomes(heights[height_slot(1)].data(), biomes[1].data(), biomes[0].data(), p);
+    } else {
+        // The GPU runs this pass in place on the aliased image; read a
+        // cleared copy instead
+        std::vector<uint8_t> cleared(biomes[0].size(), 0);
+        update_biomes(heights[0].data(), cleared.data(), biomes[0].data(), p);
+    }
+}
+
+void CpuSim::step(const ErosionPushConstants& erosionParams, BiomePushConstants& biomeParams) {
+    uint32_t in = current;
+    uint32_t out = (in + 1) % 2;
+
+    // 1. Erosion (reads H[in] + Bio[in], or Bio[out] when fused, writes H[out])
+    if (erosionEnabled) {
+        erode(heights[in].data(), biomes[biome_slot(fusedOrder ? out : in)].data(), heights[out].data(), erosionParams);
+    }
+
+    // 2. Biome CA (reads the height erosion just wrote + Bio[out], writes Bio[in])
+    simStep++;
+    if (biomeCAEnabled) {
+        biomeParams.time = static_cast<float>(simStep);
+        update_biomes(heights[height_slot(out)].data(), biomes[out].data(), biomes[in].data(), biomeParams);
+    }
+
+    current = out;
+}
+
+void CpuSim::erode(const float* inHeight, const uint8_t* inBiome, float* outHeight, const ErosionPushConstants& params) {
+    // The rate only depends on the cell's biome and whether it touches
+    // water, so erosion_rate() runs 512 times a step instead of per cell
+    for (uint32_t i = 0; i < 512; i++) {
+        rateTable[i] = erosion_rate(i >> 1, (i & 1) != 0, params);
+    }
+
+    const uint32_t w = simWidth, h = simHeight;
+    const float levels = heightLevels;
+    const ErodeRowFn erodeRow = erode_row_for(isaIndex);
+    const bool simd = isaIndex < 2;
+    for_each_tile([&](uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, uint32_t worker) {
+        uint16_t* index = rateIndex.data() + static_cast<size_t>(worker) * TILE_W;
+        // Interior columns of this tile: both horizontal neighbours exist
+        uint32_t ix0 = std::max(x0, 1u);
+        uint32_t ix1 = std::min(x1, w - 1);
+
+        for (uint32_t y = y0; y < y1; y++) {
+            size_t rowUp = static_cast<size_t>(y > 0 ? y - 1 : 0) * w;
+            size_t row = static_cast<size_t>(y) * w;
+            size_t rowDn = static_cast<size_t>(std::min(y + 1, h - 1)) * w;
+            const float *up = inHeight + rowUp, *mid = inHeight + row, *dn = inHeight + rowDn;
+            const uint8_t *bUp = inBiome + rowUp, *bMid = inBiome + row, *bDn = inBiome + rowDn;
+            float* out = outHeight + row;
+
+            uint32_t x = x0;
+            if (ix0 < ix1) {
+                for (; x < ix0; x++) {
+                    out[x] = erode_cell(up, mid, dn, bUp, bMid, bDn, x, x > 0 ? x - 1 : 0, std::min(x + 1, w - 1), rateTable, levels);
+                }
+                classify_row(bUp, bMid, bDn, ix0, ix1, index, simd);
+                x = erodeRow(up, mid, dn, index, rateTable, out, ix0, ix1, levels);
+                for (; x < ix1; x++) {
+                    float sum = up[x - 1] + up[x] + up[x + 1] + mid[x - 1] + mid[x + 1] + dn[x - 1] + dn[x] + dn[x + 1];
+                    out[x] = erode_height(mid[x], sum, rateTable[index[x - ix0]], levels);
+                }
+            }
+            for (; x < x1; x++) {
+                out[x] = erode_cell(up, mid, dn, bUp, bMid, bDn, x, x > 0 ? x - 1 : 0, std::min(x + 1, w - 1), rateTable, levels);
+            }
+        }
+    });
+}
+
+void CpuSim::update_biomes(const float* inHeight, const uint8_t* inBiome, uint8_t* outBiome, const BiomePushConstants& params) {
+    const uint32_t w = simWidth, h = simHeight;
+    const bool simd = isaIndex < 2;
+    for_each_tile([&](uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, uint32_t) {
+        for (uint32_t y = y0; y < y1; y++) {
+            size_t row = static_cast<size_t>(y) * w;
+            const float* height = inHeight + row;
+            const uint8_t* bUp = inBiome + static_cast<size_t>(y > 0 ? y - 1 : 0) * w;
+            const uint8_t* bMid = inBiome + row;
+            const uint8_t* bDn = inBiome + static_cast<size_t>(std::min(y + 1, h - 1)) * w;
+            uint8_t* out = outBiome + row;
+
+            uint32_t x = x0;
+#ifdef CPU_SIM_SSE2
+            // Water, beach and peak cells only depend on their own height:
+            // settle those four at a time, and hash the rest four at a time
+            const __m128 water = _mm_set1_ps(0.30f), sand = _mm_set1_ps(0.35f), snow = _mm_set1_ps(0.85f);
+            for (; simd && x + 4 <= x1; x += 4) {
+                __m128 hv = _mm_loadu_ps(height + x);
+                int isWater = _mm_movemask_ps(_mm_cmplt_ps(hv, water));
+                int isSand = _mm_movemask_ps(_mm_cmplt_ps(hv, sand));
+                int isSnow = _mm_movemask_ps(_mm_cmpgt_ps(hv, snow));
+                if ((isSand | isSnow) == 0xF) {
+                    for (uint32_t lane = 0; lane < 4; lane++) {
+                        out[x + lane] = ((isWater >> lane) & 1) ? WATER : ((isSand >> lane) & 1) ? SAND : SNOW;
+                    }
+                    continue;
+                }
+                CellHashes r[4];
+                cell_hashes_x4(static_cast<int32_t>(x), static_cast<int32_t>(y), params.time, r);
+                for (uint32_t lane = 0; lane < 4; lane++) {
+                    uint32_t cx = x + lane;
+                    out[cx] = biome_cell(static_cast<int32_t>(cx), static_cast<int32_t>(y), height[cx], bUp, bMid, bDn,
+                                         cx > 0 ? cx - 1 : 0, std::min(cx + 1, w - 1), params, r[lane]);
+                }
+            }
+#endif
+            for (; x < x1; x++) {
+                CellHashes r = cell_hashes(static_cast<int32_t>(x), static_cast<int32_t>(y), params.time);
+                out[x] = biome_cell(static_cast<int32_t>(x), static_cast<int32_t>(y), height[x], bUp, bMid, bDn,
+                                    x > 0 ? x - 1 : 0, std::min(x + 1, w - 1), params, r);
+            }
+        }
+    });
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "thread_pool.hpp"
+#include <cstdint>
+#include <vector>
+
+struct ErosionPushConstants;
+struct BiomePushConstants;
+
+// CPU port of the two-pass simulation (--backend cpu): noise_init.comp,
+// erosion.comp and biome_ca.comp with the same push constants, hash2D and
+// ping-pong slots as record_simulation_steps(), so a run from the same seed
+// follows the GPU one. set_fused() switches to the sim_fused.comp order
+// (also that of sim_temporal.comp) for --verify-reference. Heights are kept
+// as floats rounded to heightLevels steps like the height store; expect
+// float-precision agreement, not bit-identical heights (GPU compilers may
+// fuse multiply-adds).
+//
+// Work is split into TILE_W x TILE_H tiles walked row by row, shared over a
+// ThreadPool. The erosion row kernel has AVX2 (picked at runtime) and SSE2
+// paths with a scalar fallback; the biome CA vectorizes the height bands
+// that don't depend on neighbours and runs the full rules per cell. All
+// paths do the same float operations in the same order (cpu_sim.cpp builds
+// with -ffp-contract=off), so they agree bit for bit; --check-isa tests it.
+class CpuSim {
+public:
+    // heightLevels as for the shaders: 65535 (r16), 255 (rgba8), 0 (float).
+    // A disabled stage's second slot aliases its first, as on the GPU.
+    CpuSim(uint32_t width, uint32_t height, float heightLevels, bool erosion, bool biomeCA, uint32_t threads = 0);
+
+    // dispatch_noise_init(): fbm terrain from `seed` into both height slots
+    void init_terrain(float seed);
+    // dispatch_biome_ca_init(): both biome slots cleared, then the CA at time 0
+    void init_biomes(const BiomePushConstants& params);
+
+    // One erosion + biome CA step; params.time is set to the new step count
+    void step(const ErosionPushConstants& erosionParams, BiomePushConstants& biomeParams);
+
+    // Fused order: erosion reads the newest biome, Bio[out], instead of the
+    // one before it, like sim_fused.comp
+    void set_fused(bool fused) { fusedOrder = fused; }
+
+    // Latest state: H[current] and the biome the last CA step wrote,
+    // Bio[1 - current] (what record_export() reads back)
+    const float* heightmap() const { return heights[height_slot(current)].data(); }
+    const uint8_t* biomemap() const { return biomes[biome_slot(1 - current)].data(); }
+
+    // Raw ping-pong slots and position, to restart from another backend's
+    // state (--verify-reference steps the GPU state in lockstep)
+    float* height_data(uint32_t slot) { return heights[height_slot(slot)].data(); }
+    uint8_t* biome_data(uint32_t slot) { return biomes[biome_slot(slot)].data(); }
+    void set_position(uint32_t currentIndex, uint32_t step) { current = currentIndex; simStep = step; }
+
+    uint32_t width() const { return simWidth; }
+    uint32_t height() const { return simHeight; }
+    uint32_t steps() const { return simStep; }
+    uint32_t threads() const { return pool.size(); }
+    // Vector paths, best first. A new CpuSim uses the best one this build
+    // and CPU run; set_isa() picks a lower one, false if it isn't available.
+    static constexpr const char* ISAS[] = {"avx2", "sse2", "scalar"};
+    bool set_isa(const char* name);
+    const char* isa() const; // Path in use
+
+private:
+    static constexpr uint32_t TILE_W = 256; // Three input rows of a tile stay in L1
+    static constexpr uint32_t TILE_H = 16;
+
+    uint32_t height_slot(uint32_t i) const { return erosionEnabled ? i : 0; }
+    uint32_t biome_slot(uint32_t i) const { return biomeCAEnabled ? i : 0; }
+
+    uint32_t tile_count() const { return tilesX * tilesY; }
+    void for_each_tile(const std::function<void(uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, uint32_t worker)>& body);
+
+    void erode(const float* inHeight, const uint8_t* inBiome, float* outHeight, const ErosionPushConstants& params);
+    void update_biomes(const float* inHeight, const uint8_t* inBiome, uint8_t* outBiome, const BiomePushConstants& params);
+
+    uint32_t simWidth, simHeight;
+    float heightLevels;
+    bool erosionEnabled, biomeCAEnabled;
+    bool fusedOrder = false;
+    uint32_t tilesX, tilesY;
+    uint32_t isaIndex;       // Into ISAS
+    uint32_t current = 0;    // current_heightmap_index
+    uint32_t simStep = 0;
+
+    std::vector<float> heights[2];
+    std::vector<uint8_t> biomes[2];
+    std::vector<uint16_t> rateIndex;  // Per-worker erosion scratch, TILE_W each
+    float rateTable[512];             // Erosion rate by (biome << 1) | hasWaterNeighbor
+
+    ThreadPool pool;
+};
@@ -0,0 +1,115 @@
+#include "frame_graph.hpp"
+#include "gpu_profiler.hpp"
+
+namespace {
+
+VkAccessFlags read_access(VkPipelineStageFlags stage) {
+    return (stage & VK_PIPELINE_STAGE_TRANSFER_BIT) ? VK_ACCESS_TRANSFER_READ_BIT : VK_ACCESS_SHADER_READ_BIT;
+}
+
+VkAccessFlags write_access(VkPipelineStageFlags stage) {
+    return (stage & VK_PIPELINE_STAGE_TRANSFER_BIT) ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_WRITE_BIT;
+}
+
+} // namespace
+
+FrameGraph::ResourceId FrameGraph::add_resource(const char* name) {
+    ResourceState state;
+    state.name = name;
+    resources.push_back(state);
+    return static_cast<ResourceId>(resources.size() - 1);
+}
+
+void FrameGraph::add_pass(const char* name, VkPipelineStageFlags stage,
+                          std::initializer_list<ResourceId> reads,
+                          std::initializer_list<ResourceId> writes,
+                          RecordFn record) {
+    passes.push_back({name, stage, reads, writes, std::move(record)});
+}
+
+void FrameGraph::execute(VkCommandBuffer cmd) {
+    for (Pass& pass : passes) {
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+        VkAccessFlags srcAccess = 0;
+        VkAccessFlags dstAccess = 0;
+
+        // Read-after-write: make the last write visible to this stage
+        for (ResourceId id : pass.reads) {
+            const ResourceState& r = resources[id];
+            if (r.writeStages && (pass.stage & ~r.writeVisibleTo)) {
+                srcStages |= r.writeStages;
+                srcAccess |= r.writeAccess;
+                dstStages |= pass.stage;
+                dstAccess |= read_access(pass.stage) | write_access(pass.stage);
+            }
+        }
+        for (ResourceId id : pass.writes) {
+            const ResourceState& r = resources[id];
+            // Write-after-read: execution dependency only
+            if (r.readStages && (pass.stage & ~r.readsOrderedBefore)) {
+                srcStages |= r.readStages;
+                dstStages |= pass.stage;
+            }
+            // Write-after-write
+            if (r.writeStages && (pass.stage & ~r.writeVisibleTo)) {
+                srcStages |= r.writeStages;
+                srcAccess |= r.writeAccess;
+                dstStages |= pass.stage;
+                dstAccess |= read_access(pass.stage) | write_access(pass.stage);
+            }
+        }
+
+        // writeVisibleTo means "visible to any access at those stages", so
+        // the destination mask covers both reads and writes
+        if (srcStages) {
+            VkMemoryBarrier memBar = {};
+            memBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memBar.srcAccessMask = srcAccess;
+            memBar.dstAccessMask = dstAccess;
+            vkCmdPipelineBarrier(cmd, srcStages, dstStages, 0,
+                                 srcAccess ? 1 : 0, srcAccess ? &memBar : nullptr, 0, nullptr, 0, nullptr);
+            barrierCount++;
+
+            // A global barrier also covers resources this pass doesn't touch
+            for (ResourceState& r : resources) {
+                if (r.writeStages && !(r.writeStages & ~srcStages) && !(r.writeAccess & ~srcAccess)) {
+                    r.writeVisibleTo |= dstStages;
+                }
+                if (r.readStages && !(r.readStages & ~srcStages)) {
+                    r.readsOrderedBefore |= dstStages;
+                }
+            }
+        }
+
+        if (profiler) profiler->begin(cmd, pass.name);
+        pass.record(cmd);
+        if (profiler) profiler->end(cmd);
+        passCount++;
+
+        for (ResourceId id : pass.reads) {
+            ResourceState& r = resources[id];
+            r.readStages |= pass.stage;
+            r.readsOrderedBefore = 0; // This reader isn't ordered before anything yet
+        }
+        for (ResourceId id : pass.writes) {
+            ResourceState& r = resources[id];
+            r.writeStages = pass.stage;
+            r.writeAccess = write_access(pass.stage);
+            r.writeVisibleTo = 0;
+            r.readStages = 0;
+            r.readsOrderedBefore = 0;
+        }
+    }
+    passes.clear();
+}
+
+void FrameGraph::invalidate() {
+    for (ResourceState& r : resources) {
+        r.writeStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        r.writeAccess = VK_ACCESS_MEMORY_WRITE_BIT;
+        r.writeVisibleTo = 0;
+        r.readStages = 0;
+        r.readsOrderedBefore = 0;
+    }
+}
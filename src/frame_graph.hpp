@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+class GpuProfiler;
+
+// Minimal frame graph: passes declare the resources they read and write at
+// a pipeline stage, execute() records them in order and inserts only the
+// barriers those declarations require.
+//
+// All sim images stay in VK_IMAGE_LAYOUT_GENERAL, so a barrier is a single
+// global VkMemoryBarrier per pass (merged across every hazard it resolves).
+// Resource state persists across execute() calls: barriers cover earlier
+// command buffers on the same queue too.
+class FrameGraph {
+public:
+    using ResourceId = uint32_t;
+    using RecordFn = std::function<void(VkCommandBuffer)>;
+
+    ResourceId add_resource(const char* name);
+
+    void add_pass(const char* name, VkPipelineStageFlags stage,
+                  std::initializer_list<ResourceId> reads,
+                  std::initializer_list<ResourceId> writes,
+                  RecordFn record);
+
+    // Records every pass added since the last execute(), then clears them
+    void execute(VkCommandBuffer cmd);
+
+    // Something outside the graph (one-shot upload, reset) wrote resources:
+    // the next access to any of them gets a full barrier
+    void invalidate();
+
+    // Optional: every pass becomes a timed GPU scope named after the pass
+    void set_profiler(GpuProfiler* p) { profiler = p; }
+
+    uint32_t barriers_emitted() const { return barrierCount; }
+    uint32_t passes_executed() const { return passCount; }
+    void reset_counters() { barrierCount = 0; passCount = 0; }
+
+private:
+    struct ResourceState {
+        const char* name;
+        VkPipelineStageFlags writeStages = 0;   // Last writer (0 = never written)
+        VkAccessFlags writeAccess = 0;
+        VkPipelineStageFlags writeVisibleTo = 0; // Stages already synchronized with that write
+        VkPipelineStageFlags readStages = 0;    // Readers since the last write
+        VkPipelineStageFlags readsOrderedBefore = 0;
+    };
+
+    struct Pass {
+        const char* name;
+        VkPipelineStageFlags stage;
+        std::vector<ResourceId> reads;
+        std::vector<ResourceId> writes;
+        RecordFn record;
+    };
+
+    std::vector<ResourceState> resources;
+    std::vector<Pass> passes;
+    GpuProfiler* profiler = nullptr;
+    uint32_t barrierCount = 0;
+    uint32_t passCount = 0;
+};
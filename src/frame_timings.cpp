@@ -0,0 +1,171 @@
+#include "frame_timings.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+namespace {
+
+const char* const METRIC_NAMES[] = {"frame_ms", "cpu_ms", "wait_ms", "gpu_ms", "compute_ms"};
+constexpr size_t METRIC_COUNT = 5;
+
+float metric_of(const FrameSample& s, size_t index) {
+    switch (index) {
+        case 0: return s.frameMs;
+        case 1: return s.cpuMs;
+        case 2: return s.waitMs;
+        case 3: return s.gpuMs;
+        default: return s.computeMs;
+    }
+}
+
+// Nearest-rank percentile of sorted values
+float percentile(const std::vector<float>& sorted, double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+}
+
+constexpr int HIST_BINS_PER_OCTAVE = 4;
+constexpr int HIST_MIN_EXP = -4;  // 1/16 ms
+constexpr int HIST_MAX_EXP = 12;  // 4096 ms
+constexpr int HIST_BINS = (HIST_MAX_EXP - HIST_MIN_EXP) * HIST_BINS_PER_OCTAVE;
+
+double bin_edge(int bin) {
+    return std::exp2(HIST_MIN_EXP + static_cast<double>(bin) / HIST_BINS_PER_OCTAVE);
+}
+
+// Out-of-range values land in the first/last bin
+int bin_of(float ms) {
+    if (ms <= 0.0f) return 0;
+    int bin = static_cast<int>(std::floor((std::log2(ms) - HIST_MIN_EXP) * HIST_BINS_PER_OCTAVE));
+    return std::clamp(bin, 0, HIST_BINS - 1);
+}
+
+void write_optional(std::ofstream& out, float value) {
+    if (std::isfinite(value)) out << value;
+}
+
+} // namespace
+
+void FrameTimings::reserve(size_t capacity, std::vector<std::string> stageColumns) {
+    ring.assign(std::max(capacity, size_t(1)), FrameSample{});
+    stageNames = std::move(stageColumns);
+    stageMs.assign(ring.size() * stageNames.size(), std::numeric_limits<float>::quiet_NaN());
+    frameCount = 0;
+}
+
+size_t FrameTimings::size() const {
+    return static_cast<size_t>(std::min<uint64_t>(frameCount, ring.size()));
+}
+
+void FrameTimings::record(double time, float frameMs, float cpuMs, float waitMs, uint32_t steps) {
+    if (ring.empty()) return;
+    const float none = std::numeric_limits<float>::quiet_NaN();
+    size_t index = frameCount % ring.size();
+    ring[index] = {time, frameMs, cpuMs, waitMs, none, none, steps};
+    std::fill_n(stageMs.begin() + index * stageNames.size(), stageNames.size(), none);
+    frameCount++;
+}
+
+FrameSample* FrameTimings::find(uint64_t frame) {
+    if (frame >= frameCount || frameCount - frame > ring.size()) return nullptr;
+    return &ring[frame % ring.size()];
+}
+
+void FrameTimings::set_gpu(uint64_t frame, float ms) {
+    if (FrameSample* s = find(frame)) s->gpuMs = ms;
+}
+
+void FrameTimings::set_compute(uint64_t frame, float ms) {
+    if (FrameSample* s = find(frame)) s->computeMs = ms;
+}
+
+void FrameTimings::add_stages(uint64_t frame, const std::vector<double>& ms) {
+    if (!find(frame)) return;
+    float* row = stageMs.data() + (frame % ring.size()) * stageNames.size();
+    for (size_t i = 0; i < std::min(ms.size(), stageNames.size()); i++) {
+        if (!std::isfinite(row[i])) row[i] = 0.0f;
+        row[i] += static_cast<float>(ms[i]);
+    }
+}
+
+std::vector<float> FrameTimings::metric(size_t index) const {
+    std::vector<float> values;
+    values.reserve(size());
+    for (uint64_t f = frameCount - size(); f < frameCount; f++) {
+        float v = metric_of(ring[f % ring.size()], index);
+        if (std::isfinite(v)) values.push_back(v);
+    }
+    return values;
+}
+
+bool FrameTimings::write_frames(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "frame,time,frame_ms,cpu_ms,wait_ms,gpu_ms,compute_ms,steps";
+    for (const std::string& name : stageNames) out << "," << name;
+    out << "\n" << std::setprecision(6);
+    for (uint64_t f = frameCount - size(); f < frameCount; f++) {
+        const FrameSample& s = ring[f % ring.size()];
+        out << f << "," << s.time << "," << s.frameMs << "," << s.cpuMs << "," << s.waitMs << ",";
+        write_optional(out, s.gpuMs);
+        out << ",";
+        write_optional(out, s.computeMs);
+        out << "," << s.steps;
+        const float* row = stageMs.data() + (f % ring.size()) * stageNames.size();
+        for (size_t i = 0; i < stageNames.size(); i++) {
+            out << ",";
+            write_optional(out, row[i]);
+        }
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool FrameTimings::write_summary(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "metric,count,min,mean,p50,p95,p99,max\n";
+    std::cout << "\nFrame timings (" << size() << " frames";
+    if (overwritten() > 0) std::cout << ", oldest " << overwritten() << " overwritten";
+    std::cout << ")\n" << std::fixed << std::setprecision(3);
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        std::vector<float> values = metric(m);
+        if (values.empty()) continue; // No GPU timestamps / no async batches
+        std::sort(values.begin(), values.end());
+        double sum = 0.0;
+        for (float v : values) sum += v;
+        double mean = sum / values.size();
+        out << METRIC_NAMES[m] << "," << values.size() << "," << values.front() << "," << mean << ","
+            << percentile(values, 0.50) << "," << percentile(values, 0.95) << ","
+            << percentile(values, 0.99) << "," << values.back() << "\n";
+        std::cout << "  " << std::left << std::setw(11) << METRIC_NAMES[m] << std::right
+                  << " min " << values.front() << "  mean " << mean
+                  << "  p50 " << percentile(values, 0.50) << "  p95 " << percentile(values, 0.95)
+                  << "  p99 " << percentile(values, 0.99) << "  max " << values.back() << "\n";
+    }
+    std::cout << std::defaultfloat;
+    return static_cast<bool>(out);
+}
+
+bool FrameTimings::write_histogram(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+    std::vector<uint64_t> counts(METRIC_COUNT * HIST_BINS, 0);
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        for (float v : metric(m)) counts[m * HIST_BINS + bin_of(v)]++;
+    }
+    out << "bin_lo_ms,bin_hi_ms";
+    for (const char* name : METRIC_NAMES) out << "," << name;
+    out << "\n";
+    for (int b = 0; b < HIST_BINS; b++) {
+        out << bin_edge(b) << "," << bin_edge(b + 1);
+        for (size_t m = 0; m < METRIC_COUNT; m++) out << "," << counts[m * HIST_BINS + b];
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One displayed frame. GPU times arrive a few frames late (timestamp
+// readback) and stay NaN if they never do.
+struct FrameSample {
+    double time;       // Seconds since the benchmark started
+    float frameMs;     // Start of the previous frame to start of this one
+    float cpuMs;       // Main thread time spent on this frame, minus waitMs
+    float waitMs;      // Blocked in the frame fence wait and swapchain acquire
+    float gpuMs;       // Graphics command buffer, all profiled stages
+    float computeMs;   // Async sim batch submitted this frame, if any
+    uint32_t steps;    // Sim steps started this frame
+};
+
+// Benchmark-mode frame log: a ring preallocated once, so recording a frame
+// never allocates; the oldest frames are overwritten when it fills. Written
+// out at exit as a per-frame CSV, a percentile summary and a log-scale
+// histogram. The per-frame CSV also gets one GPU ms column per profiled
+// stage (graphics and async batch summed).
+class FrameTimings {
+public:
+    void reserve(size_t capacity, std::vector<std::string> stageColumns = {});
+
+    // Number the next record() gets; GPU times are matched back by it
+    uint64_t next_frame() const { return frameCount; }
+    void record(double time, float frameMs, float cpuMs, float waitMs, uint32_t steps);
+    void set_gpu(uint64_t frame, float ms);
+    void set_compute(uint64_t frame, float ms);
+    // Adds per-stage ms (GpuProfiler::collected()); extra stages are ignored
+    void add_stages(uint64_t frame, const std::vector<double>& ms);
+
+    size_t size() const;
+    uint64_t overwritten() const { return frameCount - size(); }
+
+    bool write_frames(const std::string& path) const;
+    // metric,count,min,mean,p50,p95,p99,max per metric; also printed
+    bool write_summary(const std::string& path) const;
+    // Four bins per octave from 1/16 ms to 4 s, one count column per metric
+    bool write_histogram(const std::string& path) const;
+
+private:
+    FrameSample* find(uint64_t frame);
+    std::vector<float> metric(size_t index) const; // Finite values, oldest first
+
+    std::vector<FrameSample> ring;
+    std::vector<std::string> stageNames;
+    std::vector<float> stageMs;      // ring.size() x stageNames.size(), NaN until reported
+    uint64_t frameCount = 0;
+};
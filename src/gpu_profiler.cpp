@@ -0,0 +1,162 @@
+#include "gpu_profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+uint32_t GpuProfiler::add_stage(const char* name) {
+    return find_stage(name);
+}
+
+uint32_t GpuProfiler::find_stage(const char* name) {
+    for (uint32_t i = 0; i < stageList.size(); i++) {
+        if (std::strcmp(stageList[i].name, name) == 0) return i;
+    }
+    Stage stage;
+    stage.name = name;
+    stageList.push_back(stage);
+    return static_cast<uint32_t>(stageList.size() - 1);
+}
+
+void GpuProfiler::init(VkDevice dev, VkPhysicalDevice physicalDevice, uint32_t slotCount, uint32_t scopesPerSlot) {
+    device = dev;
+    queriesPerSlot = scopesPerSlot * 2;
+
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(physicalDevice, &props);
+    timestampPeriod = props.limits.timestampPeriod;
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+    familyValidBits.resize(familyCount);
+    bool anyValid = false;
+    for (uint32_t i = 0; i < familyCount; i++) {
+        familyValidBits[i] = families[i].timestampValidBits;
+        anyValid |= familyValidBits[i] > 0;
+    }
+
+    if (!anyValid || timestampPeriod <= 0.0f) {
+        std::cout << "GPU profiler: timestamps not supported, stage timings disabled\n";
+        return;
+    }
+
+    VkQueryPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = slotCount * queriesPerSlot;
+    if (vkCreateQueryPool(device, &poolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+        std::cout << "GPU profiler: query pool creation failed, stage timings disabled\n";
+        queryPool = VK_NULL_HANDLE;
+        return;
+    }
+    slots.resize(slotCount);
+    ticks.resize(queriesPerSlot);
+}
+
+void GpuProfiler::destroy() {
+    if (queryPool) vkDestroyQueryPool(device, queryPool, nullptr);
+    queryPool = VK_NULL_HANDLE;
+}
+
+void GpuProfiler::begin_frame(VkCommandBuffer cmd, uint32_t slot, uint32_t queueFamily) {
+    if (!enabled()) return;
+    for (Slot& other : slots) {
+        if (other.cmd == cmd) other.cmd = VK_NULL_HANDLE; // Command buffer changed hands
+    }
+
+    Slot& s = slots[slot];
+    s.cmd = cmd;
+    s.nextQuery = 0;
+    s.scopes.clear();
+    s.open.clear();
+    uint32_t bits = queueFamily < familyValidBits.size() ? familyValidBits[queueFamily] : 0;
+    s.mask = bits >= 64 ? ~0ull : (1ull << bits) - 1;
+    if (bits == 0) return;
+    vkCmdResetQueryPool(cmd, queryPool, slot * queriesPerSlot, queriesPerSlot);
+}
+
+GpuProfiler::Slot* GpuProfiler::slot_for(VkCommandBuffer cmd) {
+    for (Slot& s : slots) {
+        if (s.cmd == cmd && s.mask) return &s;
+    }
+    return nullptr;
+}
+
+void GpuProfiler::begin(VkCommandBuffer cmd, const char* name) {
+    Slot* s = slot_for(cmd);
+    if (!s) return;
+    if (s->nextQuery + 2 > queriesPerSlot) {
+        if (!overflowWarned) {
+            std::cout << "GPU profiler: more than " << queriesPerSlot / 2
+                      << " scopes in one command buffer, the rest are untimed\n";
+            overflowWarned = true;
+        }
+        s->open.push_back(-1); // Out of queries: untimed, but keep end() balanced
+        return;
+    }
+
+    Scope scope;
+    scope.stage = find_stage(name);
+    scope.parent = s->open.empty() ? -1 : s->open.back();
+    scope.query = s->nextQuery;
+    s->nextQuery += 2;
+    uint32_t base = static_cast<uint32_t>(s - slots.data()) * queriesPerSlot;
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, base + scope.query);
+    s->open.push_back(static_cast<int32_t>(s->scopes.size()));
+    s->scopes.push_back(scope);
+}
+
+void GpuProfiler::end(VkCommandBuffer cmd) {
+    Slot* s = slot_for(cmd);
+    if (!s || s->open.empty()) return;
+    int32_t index = s->open.back();
+    s->open.pop_back();
+    if (index < 0) return;
+    uint32_t base = static_cast<uint32_t>(s - slots.data()) * queriesPerSlot;
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, base + s->scopes[index].query + 1);
+}
+
+double GpuProfiler::collect(uint32_t slot) {
+    if (!enabled()) return -1.0;
+    Slot& s = slots[slot];
+    s.cmd = VK_NULL_HANDLE; // Nothing more lands here until the next begin_frame()
+    if (s.scopes.empty()) return -1.0;
+
+    // No WAIT bit: the submit is already complete, and if a query somehow
+    // isn't (VK_NOT_READY) the slot is dropped rather than stalled on
+    VkResult result = vkGetQueryPoolResults(device, queryPool, slot * queriesPerSlot, s.nextQuery,
+                                            s.nextQuery * sizeof(uint64_t), ticks.data(), sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+    double totalMs = -1.0;
+    if (result == VK_SUCCESS) {
+        totalMs = 0.0;
+        collectedMs.assign(stageList.size(), 0.0);
+        std::vector<double> exclusiveMs(s.scopes.size(), 0.0);
+        for (size_t i = 0; i < s.scopes.size(); i++) {
+            const Scope& scope = s.scopes[i];
+            uint64_t elapsed = (ticks[scope.query + 1] - ticks[scope.query]) & s.mask;
+            double ms = elapsed * static_cast<double>(timestampPeriod) * 1e-6;
+            exclusiveMs[i] += ms;
+            if (scope.parent >= 0) exclusiveMs[scope.parent] -= ms;
+        }
+        for (size_t i = 0; i < s.scopes.size(); i++) {
+            double ms = std::max(exclusiveMs[i], 0.0);
+            stageList[s.scopes[i].stage].accumMs += ms;
+            collectedMs[s.scopes[i].stage] += ms;
+            totalMs += ms;
+        }
+    }
+    s.scopes.clear();
+    s.open.clear();
+    s.nextQuery = 0;
+    return totalMs;
+}
+
+void GpuProfiler::roll(uint32_t frames) {
+    for (Stage& stage : stageList) {
+        stage.avgMs = frames > 0 ? static_cast<float>(stage.accumMs / frames) : 0.0f;
+        stage.accumMs = 0.0;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+// Per-stage GPU timings from timestamp queries. Each command buffer that is
+// profiled owns a "slot" (one per frame in flight, plus one for the async
+// batch) with its own range of queries; results are read back only once the
+// slot's previous submit is known complete, so nothing ever waits on the GPU.
+//
+// Scopes nest: a stage's time excludes the scopes opened inside it (ImGui
+// inside the terrain pass). A stage recorded several times in one command
+// buffer (erosion once per step) sums.
+//
+// Queue families whose timestampValidBits is 0 are simply not profiled; if
+// none of them can be, enabled() is false and every call is a no-op.
+class GpuProfiler {
+public:
+    struct Stage {
+        const char* name;
+        double accumMs = 0.0; // Since the last roll()
+        float avgMs = 0.0f;   // Per frame, over the last roll() period
+    };
+
+    // Registers a stage up front so it has a stable index (CSV columns);
+    // begin() registers unknown names on the fly
+    uint32_t add_stage(const char* name);
+
+    // scopesPerSlot bounds the scopes one command buffer can open; past it
+    // begin() warns once and leaves the rest untimed
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t slotCount, uint32_t scopesPerSlot);
+    void destroy();
+
+    // Resets `slot`'s queries at the start of cmd; scopes recorded into cmd
+    // afterwards land in that slot. Call collect(slot) first.
+    void begin_frame(VkCommandBuffer cmd, uint32_t slot, uint32_t queueFamily);
+
+    void begin(VkCommandBuffer cmd, const char* name);
+    void end(VkCommandBuffer cmd);
+
+    // Adds the slot's finished scopes to the stage totals and returns their
+    // sum (ms), or -1 if the slot has nothing to report. Only call once the
+    // submit that recorded them has completed (fence / timeline).
+    double collect(uint32_t slot);
+
+    // Turns the totals into per-frame averages over `frames` frames
+    void roll(uint32_t frames);
+
+    bool enabled() const { return queryPool != VK_NULL_HANDLE; }
+    const std::vector<Stage>& stages() const { return stageList; }
+    // Per-stage ms of the last collect() that reported, indexed like stages()
+    const std::vector<double>& collected() const { return collectedMs; }
+
+private:
+    struct Scope {
+        uint32_t stage;
+        int32_t parent;    // Enclosing scope in the same slot, -1 at top level
+        uint32_t query;    // Begin timestamp; end is query + 1
+    };
+
+    struct Slot {
+        VkCommandBuffer cmd = VK_NULL_HANDLE;
+        uint64_t mask = 0;            // timestampValidBits of its queue family
+        uint32_t nextQuery = 0;
+        std::vector<Scope> scopes;
+        std::vector<int32_t> open;    // Scopes begun but not ended
+    };
+
+    Slot* slot_for(VkCommandBuffer cmd);
+    uint32_t find_stage(const char* name);
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    float timestampPeriod = 1.0f;               // Nanoseconds per tick
+    uint32_t queriesPerSlot = 0;                // Two per scope
+    bool overflowWarned = false;
+    std::vector<uint32_t> familyValidBits;
+    std::vector<Slot> slots;
+    std::vector<Stage> stageList;
+    std::vector<uint64_t> ticks;                // Readback scratch
+    std::vector<double> collectedMs;
+};
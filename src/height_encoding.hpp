@@ -0,0 +1,31 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Host-side view of a heightmap readback (--height-format). Consumers that
+// don't care about the storage format work in 1/65535 steps.
+enum class HeightEncoding { R16, R32F, RGBA8 };
+
+inline uint32_t height_bytes_per_texel(HeightEncoding encoding) {
+    return encoding == HeightEncoding::R16 ? 2 : 4;
+}
+
+inline uint16_t height_to_u16(const uint8_t* texel, HeightEncoding encoding) {
+    switch (encoding) {
+        case HeightEncoding::R16: {
+            uint16_t value;
+            memcpy(&value, texel, sizeof(value));
+            return value;
+        }
+        case HeightEncoding::R32F: {
+            float value;
+            memcpy(&value, texel, sizeof(value));
+            return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+        }
+        default:
+            return static_cast<uint16_t>(texel[0] * 257); // RGBA8: height in R
+    }
+}
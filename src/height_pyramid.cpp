@@ -0,0 +1,132 @@
+#include "height_pyramid.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+void HeightPyramid::build(const uint8_t* texels, HeightEncoding encoding, uint32_t width, uint32_t height) {
+    baseWidth = width;
+    baseHeight = height;
+    uint32_t stride = height_bytes_per_texel(encoding);
+    base.resize(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < base.size(); i++) {
+        base[i] = height_to_u16(texels + i * stride, encoding);
+    }
+
+    // 2x2 reductions down to a single cell; odd edges repeat the last texel
+    levels.clear();
+    uint32_t w = width, h = height;
+    while (w > 1 || h > 1) {
+        uint32_t prev = static_cast<uint32_t>(levels.size());
+        Level next;
+        next.width = (w + 1) / 2;
+        next.height = (h + 1) / 2;
+        next.minH.resize(static_cast<size_t>(next.width) * next.height);
+        next.maxH.resize(next.minH.size());
+        for (uint32_t y = 0; y < next.height; y++) {
+            for (uint32_t x = 0; x < next.width; x++) {
+                uint16_t lo = 65535, hi = 0;
+                for (uint32_t dy = 0; dy < 2; dy++) {
+                    for (uint32_t dx = 0; dx < 2; dx++) {
+                        uint32_t sx = std::min(2 * x + dx, w - 1);
+                        uint32_t sy = std::min(2 * y + dy, h - 1);
+                        lo = std::min(lo, level_min(prev, sx, sy));
+                        hi = std::max(hi, level_max(prev, sx, sy));
+                    }
+                }
+                next.minH[static_cast<size_t>(y) * next.width + x] = lo;
+                next.maxH[static_cast<size_t>(y) * next.width + x] = hi;
+            }
+        }
+        w = next.width;
+        h = next.height;
+        levels.push_back(std::move(next));
+    }
+}
+
+uint16_t HeightPyramid::level_min(uint32_t level, uint32_t x, uint32_t y) const {
+    if (level == 0) return base[static_cast<size_t>(y) * baseWidth + x];
+    const Level& l = levels[level - 1];
+    return l.minH[static_cast<size_t>(y) * l.width + x];
+}
+
+uint16_t HeightPyramid::level_max(uint32_t level, uint32_t x, uint32_t y) const {
+    if (level == 0) return base[static_cast<size_t>(y) * baseWidth + x];
+    const Level& l = levels[level - 1];
+    return l.maxH[static_cast<size_t>(y) * l.width + x];
+}
+
+// Maximum-mipmap traversal: skip whole cells the ray passes above, descend
+// where it might dip below. A ray already under a cell's minimum hits the
+// texel it is over, so that case stops without descending.
+bool HeightPyramid::raycast(const glm::vec3& origin, const glm::vec3& dir, float& u, float& v) const {
+    if (base.empty()) return false;
+    uint32_t top = static_cast<uint32_t>(levels.size());
+
+    // Clip to the terrain's bounding box (up to the highest texel)
+    glm::vec3 boxMin(0.0f);
+    glm::vec3 boxMax(static_cast<float>(baseWidth), level_max(top, 0, 0) / 65535.0f, static_cast<float>(baseHeight));
+    float tNear = 0.0f, tFar = FLT_MAX;
+    for (int a = 0; a < 3; a++) {
+        if (std::fabs(dir[a]) < 1e-12f) {
+            if (origin[a] < boxMin[a] || origin[a] > boxMax[a]) return false;
+            continue;
+        }
+        float t0 = (boxMin[a] - origin[a]) / dir[a];
+        float t1 = (boxMax[a] - origin[a]) / dir[a];
+        if (t0 > t1) std::swap(t0, t1);
+        tNear = std::max(tNear, t0);
+        tFar = std::min(tFar, t1);
+        if (tNear > tFar) return false;
+    }
+
+    // Nudge past a cell boundary: ~1/1000 texel
+    float horizontal = std::max(std::fabs(dir.x), std::fabs(dir.z));
+    float stepEps = 1e-3f / (horizontal > 0.0f ? horizontal : std::fabs(dir.y));
+
+    float t = tNear;
+    uint32_t level = top;
+    bool hit = false;
+    for (int iter = 0; iter < (1 << 20) && t <= tFar; iter++) {
+        glm::vec3 p = origin + dir * t;
+        uint32_t cellSize = 1u << level;
+        uint32_t levelW = level == 0 ? baseWidth : levels[level - 1].width;
+        uint32_t levelH = level == 0 ? baseHeight : levels[level - 1].height;
+        int cx = std::clamp(static_cast<int>(std::floor(p.x / cellSize)), 0, static_cast<int>(levelW) - 1);
+        int cz = std::clamp(static_cast<int>(std::floor(p.z / cellSize)), 0, static_cast<int>(levelH) - 1);
+
+        float exitT = tFar;
+        if (dir.x > 0.0f) exitT = std::min(exitT, ((cx + 1) * static_cast<float>(cellSize) - origin.x) / dir.x);
+        else if (dir.x < 0.0f) exitT = std::min(exitT, (cx * static_cast<float>(cellSize) - origin.x) / dir.x);
+        if (dir.z > 0.0f) exitT = std::min(exitT, ((cz + 1) * static_cast<float>(cellSize) - origin.z) / dir.z);
+        else if (dir.z < 0.0f) exitT = std::min(exitT, (cz * static_cast<float>(cellSize) - origin.z) / dir.z);
+
+        float cellMin = level_min(level, cx, cz) / 65535.0f;
+        float cellMax = level_max(level, cx, cz) / 65535.0f;
+        float yIn = p.y;
+        float yOut = origin.y + dir.y * exitT;
+
+        if (yIn <= cellMin) {  // Under every texel of the cell, including this one
+            hit = true;
+            break;
+        }
+        if (std::min(yIn, yOut) > cellMax) {
+            t = std::max(exitT, t) + stepEps;
+            if (level < top) level++;
+            continue;
+        }
+        // The ray reaches cellMax inside this cell; nothing before that can hit
+        if (yIn > cellMax) t += (cellMax - yIn) / dir.y;
+        if (level == 0) {
+            hit = true;
+            break;
+        }
+        level--;
+    }
+    if (!hit) return false;
+
+    glm::vec3 p = origin + dir * t;
+    u = std::clamp(p.x / baseWidth, 0.0f, 1.0f);
+    v = std::clamp(p.z / baseHeight, 0.0f, 1.0f);
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "height_encoding.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// CPU copy of the heightmap with a min/max mip chain, for terrain picking
+// without a GPU round-trip. Built off the main thread from a readback; a
+// built pyramid is immutable, so a pick never races a refresh.
+//
+// Ray space is the heightmap's: x/z in texels, y in normalized height [0, 1].
+// Each texel is treated as a flat-topped column, so hits are exact to a texel.
+class HeightPyramid {
+public:
+    void build(const uint8_t* texels, HeightEncoding encoding, uint32_t width, uint32_t height);
+
+    // First intersection with the terrain along origin + t * dir (t >= 0).
+    // Returns the hit in UV [0, 1].
+    bool raycast(const glm::vec3& origin, const glm::vec3& dir, float& u, float& v) const;
+
+    uint32_t width() const { return baseWidth; }
+    uint32_t height() const { return baseHeight; }
+    float height_at(uint32_t x, uint32_t y) const { return base[static_cast<size_t>(y) * baseWidth + x] / 65535.0f; }
+
+private:
+    struct Level {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint16_t> minH;
+        std::vector<uint16_t> maxH;
+    };
+
+    // Level 0 is the base heightmap itself (min == max)
+    uint16_t level_min(uint32_t level, uint32_t x, uint32_t y) const;
+    uint16_t level_max(uint32_t level, uint32_t x, uint32_t y) const;
+
+    uint32_t baseWidth = 0;
+    uint32_t baseHeight = 0;
+    std::vector<uint16_t> base;
+    std::vector<Level> levels;  // levels[i] covers 2^(i+1) texels per cell
+};
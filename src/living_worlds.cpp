@@ -1,4 +1,5 @@
 #include "living_worlds.hpp"
+#include "cpu_sim.hpp"
 
 #include <iostream>
 #include <fstream>
@@ -6,6 +7,11 @@
 #include <cmath>
 #include <random>
 #include <ctime>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cctype>
+#include <cstdio>
 
 #define VK_CHECK(x)                                                 \
     do {                                                            \
@@ -19,11 +25,38 @@
 // Change default pattern here for testing
 const Pattern DEFAULT_PATTERN = Pattern::GosperGliderGun; 
 
-void LivingWorlds::run() {
+// Profiled stages with a benchmark CSV column, named after their graph
+// passes (plus ImGui, timed inside the terrain pass)
+static const char* const GPU_PROFILE_STAGES[] = {
+    "brush", "sim batch", "temporal", "fused", "erosion", "biome CA", "sim stats",
+    "display copy", "export", "pick readback", "checkpoint", "height pyramid", "terrain cull", "terrain", "imgui",
+};
+
+int LivingWorlds::run() {
+    if (config.cpuBackend) {
+        return run_cpu() ? 0 : 1;
+    }
+    if (config.headless) {
+        init_headless();
+        if (!config.loadStatePath.empty()) load_state(config.loadStatePath);
+        bool ok = true;
+        if (config.verifySteps > 0) {
+            ok = run_verify();
+        } else {
+            run_headless();
+        }
+        if (!config.saveStatePath.empty()) save_state(config.saveStatePath);
+        cleanup_headless();
+        return ok ? 0 : 1;
+    }
+    
     init();
-    initialize_grid_pattern(DEFAULT_PATTERN); 
+    if (storage_images[0]) initialize_grid_pattern(DEFAULT_PATTERN);
+    if (!config.loadStatePath.empty()) load_state(config.loadStatePath);
     main_loop();
+    if (!config.saveStatePath.empty()) save_state(config.saveStatePath);
     cleanup();
+    return 0;
 }
 
 void LivingWorlds::init() {
@@ -31,14 +64,28 @@ void LivingWorlds::init() {
     simWidth = static_cast<uint32_t>(config.gridSize);
     simHeight = static_cast<uint32_t>(config.gridSize);
     simInterval = 0.5f / config.simSpeed;
+    currentSeed = config.seed;
+    erosionParams.bidrEnabled = config.bidirErosion ? 1.0f : 0.0f;
+    resolve_stages();
     
     // Benchmark mode setup
     if (config.benchmarkMode) {
         benchmarkStartTime = glfwGetTime();
-        std::string filename = "benchmark_" + std::to_string(config.gridSize) + 
-                               "_" + std::to_string(static_cast<int>(config.simSpeed * 10)) + ".csv";
+        benchmarkName = "benchmark_" + std::to_string(config.gridSize) + 
+                        "_" + std::to_string(static_cast<int>(config.simSpeed * 10));
+        std::string filename = benchmarkName + ".csv";
         benchmarkCSV.open(filename);
-        benchmarkCSV << "time,fps,frame_ms,grid_size,sim_speed,erosion,biome_ca\n";
+        benchmarkCSV << "time,fps,frame_ms,grid_size,sim_speed,erosion,biome_ca,steps_per_second";
+        std::vector<std::string> stageColumns;
+        for (const char* stage : GPU_PROFILE_STAGES) {
+            std::string column = std::string("gpu_") + stage + "_ms";
+            for (char& c : column) c = (c == ' ') ? '_' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            benchmarkCSV << "," << column;
+            stageColumns.push_back(column);
+        }
+        benchmarkCSV << "\n";
+        // Same stage columns, per frame (stages registered in this order)
+        frameTimings.reserve(static_cast<size_t>(std::max(config.frameLogCapacity, 1)), std::move(stageColumns));
         std::cout << "Logging to: " << filename << std::endl;
     }
     
@@ -46,17 +93,18 @@ void LivingWorlds::init() {
     init_vulkan();
     init_swapchain();
     init_commands();
+    init_gpu_profiler();
     
     // 2.5D Resources must be created before framebuffers (depth)
-    create_grid_mesh();
-    create_vertex_buffer();
-    create_index_buffer();
+    create_patch_index_buffer();
     create_uniform_buffers();
+    create_terrain_patch_buffers();
     create_depth_resources(); // Init depth resources here
 
     init_default_renderpass(); // Now uses depth format
     init_framebuffers();       // Now uses depth image view
     init_sync_structures();
+    init_async_compute();
 
     // Compute setup
     init_storage_images();
@@ -65,20 +113,76 @@ void LivingWorlds::init() {
     init_noise_pipeline();
     dispatch_noise_init(); // <-- WAS MISSING
     
-    init_biome_pipeline();
-    init_erosion_pipeline();
-    init_biome_growth_pipeline();
-    init_biome_ca_pipeline(); // Week 5.5
+    if (config.climate) {
+        init_biome_pipeline();
+        init_biome_growth_pipeline();
+    }
+    if (config.enableErosion) init_erosion_pipeline();
+    init_biome_ca_pipeline(); // Week 5.5 (also seeds the biomes when the CA stage is off)
+    if (config.fusedSim) init_fused_pipeline();
+    if (config.temporalK > 0) init_temporal_pipeline();
+    if (config.activeTiles) init_active_tiles();
+    if (config.bitslicedBiome) init_bitsliced_biome();
+    init_sim_stats();
+    init_brush_pipeline();
+    create_height_pyramid(); // Sampled by the texture sets
     init_terrain_pipeline();
+    init_terrain_cull();
+    init_height_pyramid_pipeline();
     
     dispatch_biome_init(); // Run once (temp/hum)
     dispatch_biome_ca_init(); // Week 5.5: Initialize discrete biomes
+    init_frame_graph();
+    init_export();
+    init_picking();
     
-    // Viz Pipeline
-    init_viz_pipeline();
+    // Viz Pipeline (debug view of the climate layers)
+    if (config.climate) init_viz_pipeline();
     
     // ImGui for UI controls
     init_imgui();
+    
+    print_vram_report();
+}
+
+// Compute-only init: no GLFW window, surface, swapchain, render pass or ImGui,
+// so it runs on build machines without a display (and on lavapipe).
+void LivingWorlds::init_headless() {
+    simWidth = static_cast<uint32_t>(config.gridSize);
+    simHeight = static_cast<uint32_t>(config.gridSize);
+    config.asyncCompute = false; // Nothing to overlap with
+    currentSeed = config.seed;
+    erosionParams.bidrEnabled = config.bidirErosion ? 1.0f : 0.0f;
+    resolve_stages();
+    
+    init_vulkan();
+    init_commands();
+    init_sync_structures();
+    
+    init_storage_images();
+    init_descriptors();
+    
+    init_noise_pipeline();
+    dispatch_noise_init();
+    
+    if (config.climate) {
+        init_biome_pipeline();
+        init_biome_growth_pipeline();
+    }
+    if (config.enableErosion) init_erosion_pipeline();
+    init_biome_ca_pipeline();
+    if (config.fusedSim) init_fused_pipeline();
+    if (config.temporalK > 0) init_temporal_pipeline();
+    if (config.activeTiles) init_active_tiles();
+    if (config.bitslicedBiome) init_bitsliced_biome();
+    
+    dispatch_biome_init();
+    dispatch_biome_ca_init();
+    init_frame_graph();
+    init_export();
+    if (config.verifySteps > 0) init_state_hash();
+    
+    print_vram_report();
 }
 
 void LivingWorlds::init_window() {
@@ -165,6 +269,7 @@ void LivingWorlds::init_vulkan() {
     auto inst_ret = builder.set_app_name("Living Worlds")
                         .request_validation_layers(true)
                         .require_api_version(1, 3, 0)
+                        .set_headless(config.headless)
                         .use_default_debug_messenger()
                         .build();
 
@@ -175,11 +280,14 @@ void LivingWorlds::init_vulkan() {
     instance = inst_ret.value();
     debug_messenger = instance.debug_messenger;
 
-    glfwCreateWindowSurface(instance.instance, window, nullptr, &surface);
-
     vkb::PhysicalDeviceSelector selector{instance};
-    auto phys_ret = selector.set_surface(surface)
-                        .set_minimum_version(1, 2)
+    if (!config.headless) {
+        glfwCreateWindowSurface(instance.instance, window, nullptr, &surface);
+        selector.set_surface(surface);
+    }
+    // Any device type, so CPU implementations like lavapipe work headless
+    auto phys_ret = selector.set_minimum_version(1, 2)
+                        .allow_any_gpu_device_type(true)
                         .select();
     
     if (!phys_ret) {
@@ -187,8 +295,44 @@ void LivingWorlds::init_vulkan() {
         abort();
     }
     physical_device = phys_ret.value();
+    std::cout << "Using device: " << physical_device.name << "\n";
+
+    // Height images are bound without a format qualifier (--height-format).
+    // Without these device features choose_height_format() only takes
+    // formats that allow it on their own.
+    VkPhysicalDeviceFeatures without_format = {};
+    without_format.shaderStorageImageReadWithoutFormat = VK_TRUE;
+    without_format.shaderStorageImageWriteWithoutFormat = VK_TRUE;
+    storageWithoutFormat = physical_device.enable_features_if_present(without_format);
+
+    // Async compute needs timeline semaphores (core in 1.2, but optional feature)
+    VkPhysicalDeviceVulkan12Features features12 = {};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    if (config.asyncCompute) {
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &features12;
+        vkGetPhysicalDeviceFeatures2(physical_device.physical_device, &features2);
+        if (!features12.timelineSemaphore) {
+            std::cout << "Async compute: timeline semaphores unsupported, using single queue\n";
+        }
+        // Only enable what we use
+        VkBool32 timeline = features12.timelineSemaphore;
+        features12 = {};
+        features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        features12.timelineSemaphore = timeline;
+    }
+
+    // Snapshot loads can import the mmapped file instead of copying it
+    if (config.importHostMemory) {
+        hostImportSupported = physical_device.enable_extension_if_present(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+        if (!hostImportSupported) std::cout << "VK_EXT_external_memory_host unsupported, snapshots use a staging copy\n";
+    }
 
     vkb::DeviceBuilder device_builder{physical_device};
+    if (features12.timelineSemaphore) {
+        device_builder.add_pNext(&features12);
+    }
     auto dev_ret = device_builder.build();
     
     if (!dev_ret) {
@@ -200,6 +344,22 @@ void LivingWorlds::init_vulkan() {
     graphics_queue = device.get_queue(vkb::QueueType::graphics).value();
     graphics_queue_family = device.get_queue_index(vkb::QueueType::graphics).value();
 
+    // Prefer a compute-only family, then any compute family separate from graphics
+    if (features12.timelineSemaphore) {
+        auto compute_index = device.get_dedicated_queue_index(vkb::QueueType::compute);
+        if (!compute_index) compute_index = device.get_queue_index(vkb::QueueType::compute);
+        
+        if (compute_index && compute_index.value() != graphics_queue_family) {
+            compute_queue_family = compute_index.value();
+            vkGetDeviceQueue(device.device, compute_queue_family, 0, &compute_queue);
+            asyncCompute = true;
+            std::cout << "Async compute: ON (graphics family " << graphics_queue_family
+                      << ", compute family " << compute_queue_family << ")\n";
+        } else {
+            std::cout << "Async compute: no separate compute family, using single queue\n";
+        }
+    }
+
     VmaAllocatorCreateInfo allocatorInfo = {};
     allocatorInfo.physicalDevice = physical_device.physical_device;
     allocatorInfo.device = device.device;
@@ -351,6 +511,35 @@ void LivingWorlds::init_sync_structures() {
     }
 }
 
+void LivingWorlds::init_async_compute() {
+    if (!asyncCompute) return;
+    
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = compute_queue_family;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    VK_CHECK(vkCreateCommandPool(device.device, &poolInfo, nullptr, &compute_command_pool));
+    
+    // One batch in flight at a time, so a single command buffer is enough
+    VkCommandBufferAllocateInfo cmdAllocInfo = {};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.commandPool = compute_command_pool;
+    cmdAllocInfo.commandBufferCount = 1;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    VK_CHECK(vkAllocateCommandBuffers(device.device, &cmdAllocInfo, &compute_command_buffer));
+    
+    VkSemaphoreTypeCreateInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+    
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &timelineInfo;
+    VK_CHECK(vkCreateSemaphore(device.device, &semaphoreInfo, nullptr, &sim_timeline));
+    VK_CHECK(vkCreateSemaphore(device.device, &semaphoreInfo, nullptr, &render_timeline));
+}
+
 // ================= COMPUTE =================
 
 void LivingWorlds::create_storage_image(VkImage& image, VmaAllocation& alloc, VkImageView& view, VkFormat format) {
@@ -368,6 +557,15 @@ void LivingWorlds::create_storage_image(VkImage& image, VmaAllocation& alloc, Vk
     imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT; // TRANSFER_DST for clearing
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    
+    // Sim images are touched by both queues in async mode (one-shot inits and
+    // spawns on graphics, steps on compute); CONCURRENT avoids ownership transfers
+    uint32_t queueFamilies[2] = {graphics_queue_family, compute_queue_family};
+    if (asyncCompute) {
+        imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        imageInfo.queueFamilyIndexCount = 2;
+        imageInfo.pQueueFamilyIndices = queueFamilies;
+    }
 
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
@@ -388,35 +586,189 @@ void LivingWorlds::create_storage_image(VkImage& image, VmaAllocation& alloc, Vk
     VK_CHECK(vkCreateImageView(device.device, &viewInfo, nullptr, &view));
 }
 
-void LivingWorlds::init_storage_images() {
-    create_storage_image(storage_images[0], storage_image_allocations[0], storage_image_views[0], VK_FORMAT_R8G8B8A8_UNORM);
-    create_storage_image(storage_images[1], storage_image_allocations[1], storage_image_views[1], VK_FORMAT_R8G8B8A8_UNORM);
-    
-    // Week 3 Heightmaps - Switch to RGBA8 for compatibility (Debug Fix)
-    create_storage_image(heightmap_images[0], heightmap_allocations[0], heightmap_views[0], VK_FORMAT_R8G8B8A8_UNORM);
-    create_storage_image(heightmap_images[1], heightmap_allocations[1], heightmap_views[1], VK_FORMAT_R8G8B8A8_UNORM);
-    
-    std::cout << "Init Storage Images:\n";
-    std::cout << "  Created Heightmap View 0: " << heightmap_views[0] << "\n";
-    std::cout << "  Created Heightmap View 1: " << heightmap_views[1] << "\n";
+static const char* height_format_name(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R16_UNORM:      return "R16_UNORM";
+        case VK_FORMAT_R32_SFLOAT:     return "R32_SFLOAT";
+        case VK_FORMAT_R8G8B8A8_UNORM: return "RGBA8_UNORM";
+        default:                       return "unknown format";
+    }
+}
+
+// Falls back R16_UNORM -> R32_SFLOAT -> RGBA8_UNORM when the requested
+// height format can't be a storage image on this device. Without the
+// device-wide without-format features, a format also has to allow
+// unqualified storage reads/writes itself (format features 2, Vulkan 1.3).
+void LivingWorlds::choose_height_format() {
+    const VkFormatFeatureFlags2 needed = VK_FORMAT_FEATURE_2_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_BIT |
+                                         VK_FORMAT_FEATURE_2_TRANSFER_SRC_BIT | VK_FORMAT_FEATURE_2_TRANSFER_DST_BIT;
+    const VkFormatFeatureFlags2 withoutFormat = VK_FORMAT_FEATURE_2_STORAGE_READ_WITHOUT_FORMAT_BIT |
+                                                VK_FORMAT_FEATURE_2_STORAGE_WRITE_WITHOUT_FORMAT_BIT;
+    bool formatFeatures2 = physical_device.properties.apiVersion >= VK_API_VERSION_1_3;
+    
+    VkFormat candidates[3] = {config.heightFormat, VK_FORMAT_R32_SFLOAT, VK_FORMAT_R8G8B8A8_UNORM};
+    bool found = false;
+    for (VkFormat format : candidates) {
+        VkFormatFeatureFlags2 features = 0;
+        if (formatFeatures2) {
+            VkFormatProperties3 props3 = {};
+            props3.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3;
+            VkFormatProperties2 props = {};
+            props.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2;
+            props.pNext = &props3;
+            vkGetPhysicalDeviceFormatProperties2(physical_device.physical_device, format, &props);
+            features = props3.optimalTilingFeatures;
+        } else {
+            VkFormatProperties props;
+            vkGetPhysicalDeviceFormatProperties(physical_device.physical_device, format, &props);
+            features = props.optimalTilingFeatures; // Same bit values as the 32-bit flags
+        }
+        VkFormatFeatureFlags2 required = storageWithoutFormat ? needed : needed | withoutFormat;
+        if ((features & required) == required) {
+            if (format != config.heightFormat) {
+                std::cout << "Height format " << height_format_name(config.heightFormat) << " unsupported, using "
+                          << height_format_name(format) << "\n";
+            }
+            config.heightFormat = format;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        std::cerr << "No height format usable as an unqualified storage image on this device\n";
+        abort();
+    }
     
-    // Week 4 Biomes
-    create_storage_image(temp_images[0], temp_allocations[0], temp_views[0], VK_FORMAT_R32_SFLOAT);
-    create_storage_image(temp_images[1], temp_allocations[1], temp_views[1], VK_FORMAT_R32_SFLOAT);
-    create_storage_image(humidity_images[0], humidity_allocations[0], humidity_views[0], VK_FORMAT_R32_SFLOAT);
-    create_storage_image(humidity_images[1], humidity_allocations[1], humidity_views[1], VK_FORMAT_R32_SFLOAT);
+    uint32_t bytesPerCell = 4;
+    switch (config.heightFormat) {
+        case VK_FORMAT_R16_UNORM:  heightLevels = 65535.0f; bytesPerCell = 2; break;
+        case VK_FORMAT_R32_SFLOAT: heightLevels = 0.0f; break;
+        default:                   heightLevels = 255.0f; break;
+    }
+    std::cout << "Heightmap: " << height_format_name(config.heightFormat)
+              << ", " << (2ull * bytesPerCell * simWidth * simHeight) / (1024 * 1024) << " MB ping-pong pair\n";
+}
+
+// Drops options that need a disabled stage. Fused/temporal kernels run
+// erosion and the biome CA together; the bitplanes only feed the CA.
+void LivingWorlds::resolve_stages() {
+    if ((config.fusedSim || config.temporalK > 0) && !(config.enableErosion && config.enableBiomeCA)) {
+        std::cout << "Fused/temporal kernels need erosion and the biome CA, using the two-pass path\n";
+        config.fusedSim = false;
+        config.temporalK = 0;
+    }
+    if (config.bitslicedBiome && !config.enableBiomeCA) {
+        std::cout << "Bit-sliced biomes need the biome CA, disabled\n";
+        config.bitslicedBiome = false;
+    }
+    if (config.activeTiles && !(config.enableErosion && config.enableBiomeCA)) {
+        std::cout << "Active tiles need erosion and the biome CA, disabled\n";
+        config.activeTiles = false;
+    }
+}
+
+void LivingWorlds::track_vram(const char* stage, VmaAllocation allocation) {
+    VmaAllocationInfo info;
+    vmaGetAllocationInfo(allocator, allocation, &info);
+    for (auto& entry : stage_vram) {
+        if (entry.first == stage) {
+            entry.second += info.size;
+            return;
+        }
+    }
+    stage_vram.emplace_back(stage, info.size);
+}
+
+void LivingWorlds::print_vram_report() {
+    VkDeviceSize total = 0;
+    std::cout << "VRAM by stage:\n";
+    for (const auto& entry : stage_vram) {
+        std::cout << "  " << entry.first << ": " << entry.second / (1024.0 * 1024.0) << " MB\n";
+        total += entry.second;
+    }
+    std::cout << "  Total: " << total / (1024.0 * 1024.0) << " MB\n";
+}
+
+// A disabled stage's second ping-pong image aliases the first; clear the
+// alias so cleanup destroys each image once
+void LivingWorlds::release_aliased_images() {
+    if (heightmap_images[1] == heightmap_images[0]) {
+        heightmap_images[1] = VK_NULL_HANDLE;
+        heightmap_views[1] = VK_NULL_HANDLE;
+        heightmap_allocations[1] = VK_NULL_HANDLE;
+    }
+    if (biome_images[1] == biome_images[0]) {
+        biome_images[1] = VK_NULL_HANDLE;
+        biome_views[1] = VK_NULL_HANDLE;
+        biome_allocations[1] = VK_NULL_HANDLE;
+    }
+}
+
+// Only the stages that are enabled get images. Heights only change under
+// erosion and biomes only under the CA, so a disabled stage keeps a single
+// image and both ping-pong slots point at it.
+void LivingWorlds::init_storage_images() {
+    // Week 3 Heightmaps - single channel, format chosen by --height-format
+    choose_height_format();
+    create_storage_image(heightmap_images[0], heightmap_allocations[0], heightmap_views[0], config.heightFormat);
+    track_vram("Terrain (height)", heightmap_allocations[0]);
+    if (config.enableErosion) {
+        create_storage_image(heightmap_images[1], heightmap_allocations[1], heightmap_views[1], config.heightFormat);
+        track_vram("Erosion", heightmap_allocations[1]);
+    } else {
+        heightmap_images[1] = heightmap_images[0];
+        heightmap_allocations[1] = heightmap_allocations[0];
+        heightmap_views[1] = heightmap_views[0];
+    }
     
     // Week 5.5 Discrete Biome (R8_UINT)
     create_storage_image(biome_images[0], biome_allocations[0], biome_views[0], VK_FORMAT_R8_UINT);
-    create_storage_image(biome_images[1], biome_allocations[1], biome_views[1], VK_FORMAT_R8_UINT);
+    track_vram("Biomes", biome_allocations[0]);
+    if (config.enableBiomeCA) {
+        create_storage_image(biome_images[1], biome_allocations[1], biome_views[1], VK_FORMAT_R8_UINT);
+        track_vram("Biome CA", biome_allocations[1]);
+    } else {
+        biome_images[1] = biome_images[0];
+        biome_allocations[1] = biome_allocations[0];
+        biome_views[1] = biome_views[0];
+    }
     
-    // Transition ALL images to VK_IMAGE_LAYOUT_GENERAL
+    // Week 4 Biomes (climate layers) + the Week 1 RGBA8 image heightmap_viz
+    // writes into; nothing in the sim loop reads them
+    if (config.climate) {
+        create_storage_image(storage_images[0], storage_image_allocations[0], storage_image_views[0], VK_FORMAT_R8G8B8A8_UNORM);
+        track_vram("Climate", storage_image_allocations[0]);
+        for(int i=0; i<2; i++) {
+            create_storage_image(temp_images[i], temp_allocations[i], temp_views[i], VK_FORMAT_R32_SFLOAT);
+            create_storage_image(humidity_images[i], humidity_allocations[i], humidity_views[i], VK_FORMAT_R32_SFLOAT);
+            track_vram("Climate", temp_allocations[i]);
+            track_vram("Climate", humidity_allocations[i]);
+        }
+    }
+    
+    // Transition everything we created to VK_IMAGE_LAYOUT_GENERAL
     for(int i=0; i<2; i++) {
-        transition_image_layout(storage_images[i], VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
-        transition_image_layout(heightmap_images[i], VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
-        transition_image_layout(temp_images[i], VK_FORMAT_R32_SFLOAT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
-        transition_image_layout(humidity_images[i], VK_FORMAT_R32_SFLOAT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
-        transition_image_layout(biome_images[i], VK_FORMAT_R8_UINT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+        if (i == 0 || config.enableErosion) transition_image_layout(heightmap_images[i], config.heightFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+        if (i == 0 || config.enableBiomeCA) transition_image_layout(biome_images[i], VK_FORMAT_R8_UINT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+        if (config.climate) {
+            transition_image_layout(temp_images[i], VK_FORMAT_R32_SFLOAT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+            transition_image_layout(humidity_images[i], VK_FORMAT_R32_SFLOAT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+        }
+    }
+    if (config.climate) {
+        transition_image_layout(storage_images[0], VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+    }
+    
+    // Async compute: renderer-owned copies of the latest finished generation
+    if (asyncCompute) {
+        for(int i=0; i<2; i++) {
+            create_storage_image(display_height_images[i], display_height_allocations[i], display_height_views[i], config.heightFormat);
+            create_storage_image(display_biome_images[i], display_biome_allocations[i], display_biome_views[i], VK_FORMAT_R8_UINT);
+            track_vram("Async display copies", display_height_allocations[i]);
+            track_vram("Async display copies", display_biome_allocations[i]);
+            transition_image_layout(display_height_images[i], config.heightFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+            transition_image_layout(display_biome_images[i], VK_FORMAT_R8_UINT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+        }
     }
 }
 
@@ -487,15 +839,20 @@ void LivingWorlds::init_descriptors() {
         writes.push_back(w);
     };
 
-    // Set 0
-    add_write(compute_descriptor_sets[0], 0, &gol0);
-    add_write(compute_descriptor_sets[0], 1, &gol1);
+    // Set 0 (GOL/climate bindings only when their stage allocated images;
+    // no pipeline that gets bound reads them otherwise)
+    if (storage_images[1]) {
+        add_write(compute_descriptor_sets[0], 0, &gol0);
+        add_write(compute_descriptor_sets[0], 1, &gol1);
+    }
     add_write(compute_descriptor_sets[0], 2, &h0);
     add_write(compute_descriptor_sets[0], 3, &h1);
-    add_write(compute_descriptor_sets[0], 4, &t0);
-    add_write(compute_descriptor_sets[0], 5, &t1);
-    add_write(compute_descriptor_sets[0], 6, &hum0);
-    add_write(compute_descriptor_sets[0], 7, &hum1);
+    if (config.climate) {
+        add_write(compute_descriptor_sets[0], 4, &t0);
+        add_write(compute_descriptor_sets[0], 5, &t1);
+        add_write(compute_descriptor_sets[0], 6, &hum0);
+        add_write(compute_descriptor_sets[0], 7, &hum1);
+    }
 
     // Biome bindings (8, 9)
     VkDescriptorImageInfo bio0 = {VK_NULL_HANDLE, biome_views[0], VK_IMAGE_LAYOUT_GENERAL};
@@ -505,14 +862,18 @@ void LivingWorlds::init_descriptors() {
 
     // Set 1: Current=1, Next=0
     // Bindings: 0:GOL1, 1:GOL0, 2:H1, 3:H0, 4:T1, 5:T0, 6:Hum1, 7:Hum0, 8:Bio1, 9:Bio0
-    add_write(compute_descriptor_sets[1], 0, &gol1);
-    add_write(compute_descriptor_sets[1], 1, &gol0);
+    if (storage_images[1]) {
+        add_write(compute_descriptor_sets[1], 0, &gol1);
+        add_write(compute_descriptor_sets[1], 1, &gol0);
+    }
     add_write(compute_descriptor_sets[1], 2, &h1);
     add_write(compute_descriptor_sets[1], 3, &h0);
-    add_write(compute_descriptor_sets[1], 4, &t1);
-    add_write(compute_descriptor_sets[1], 5, &t0);
-    add_write(compute_descriptor_sets[1], 6, &hum1);
-    add_write(compute_descriptor_sets[1], 7, &hum0);
+    if (config.climate) {
+        add_write(compute_descriptor_sets[1], 4, &t1);
+        add_write(compute_descriptor_sets[1], 5, &t0);
+        add_write(compute_descriptor_sets[1], 6, &hum1);
+        add_write(compute_descriptor_sets[1], 7, &hum0);
+    }
     add_write(compute_descriptor_sets[1], 8, &bio1);
     add_write(compute_descriptor_sets[1], 9, &bio0);
 
@@ -717,6 +1078,8 @@ void LivingWorlds::init_biome_growth_pipeline() {
 }
 
 void LivingWorlds::dispatch_biome_init() {
+    if (!biome_pipeline) return; // Climate stage off
+    
     VkCommandBuffer cmd;
     VkCommandBufferAllocateInfo cmdAllocInfo = {};
     cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -732,9 +1095,9 @@ void LivingWorlds::dispatch_biome_init() {
     
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_pipeline);
     
-    // Push Seed
+    // Push Seed (--seed, or the UI reset's)
     PushConsts push;
-    push.seed = SEED;
+    push.seed = currentSeed;
     vkCmdPushConstants(cmd, biome_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConsts), &push);
     
     // We need to bind descriptor sets.
@@ -796,24 +1159,25 @@ void LivingWorlds::init_erosion_pipeline() {
     vkDestroyShaderModule(device.device, erosionShader, nullptr);
 }
 
-// Week 5.5: Discrete Biome CA Pipeline
-void LivingWorlds::init_biome_ca_pipeline() {
-    VkShaderModule biomeCaShader;
-    if (!load_shader_module("shaders/biome_ca.comp.spv", &biomeCaShader)) {
-        std::cerr << "Failed to load shaders/biome_ca.comp.spv\n";
+// Fused erosion + biome CA: one dispatch per step instead of two
+void LivingWorlds::init_fused_pipeline() {
+    VkShaderModule fusedShader;
+    if (!load_shader_module("shaders/sim_fused.comp.spv", &fusedShader)) {
+        std::cerr << "Failed to load shaders/sim_fused.comp.spv\n";
         abort();
     }
 
     VkPipelineShaderStageCreateInfo shaderStageInfo = {};
     shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-    shaderStageInfo.module = biomeCaShader;
+    shaderStageInfo.module = fusedShader;
     shaderStageInfo.pName = "main";
+    shaderStageInfo.pSpecializationInfo = &heightSpecInfo;
 
     VkPushConstantRange pushConstantRange = {};
     pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(BiomePushConstants);
+    pushConstantRange.size = sizeof(FusedPushConstants);
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -822,142 +1186,1126 @@ void LivingWorlds::init_biome_ca_pipeline() {
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-    VK_CHECK(vkCreatePipelineLayout(device.device, &pipelineLayoutInfo, nullptr, &biome_ca_pipeline_layout));
+    VK_CHECK(vkCreatePipelineLayout(device.device, &pipelineLayoutInfo, nullptr, &fused_pipeline_layout));
 
     VkComputePipelineCreateInfo pipelineInfo = {};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
     pipelineInfo.stage = shaderStageInfo;
-    pipelineInfo.layout = biome_ca_pipeline_layout;
+    pipelineInfo.layout = fused_pipeline_layout;
 
-    VK_CHECK(vkCreateComputePipelines(device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &biome_ca_pipeline));
+    VK_CHECK(vkCreateComputePipelines(device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &fused_pipeline));
 
-    vkDestroyShaderModule(device.device, biomeCaShader, nullptr);
+    vkDestroyShaderModule(device.device, fusedShader, nullptr);
 }
 
-void LivingWorlds::dispatch_biome_ca_init() {
-    // Initialize discrete biome layer: All land = GRASS (2), Water = WATER (0)
-    // First clear the biome images to 0
-    
-    VkCommandBuffer cmd;
-    VkCommandBufferAllocateInfo cmdAllocInfo = {};
-    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    cmdAllocInfo.commandPool = command_pool;
-    cmdAllocInfo.commandBufferCount = 1;
-    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    vkAllocateCommandBuffers(device.device, &cmdAllocInfo, &cmd);
+// Temporal blocking: K is a specialization constant that sizes the ghost
+// zone, so clamp it to what fits in shared memory
+void LivingWorlds::init_temporal_pipeline() {
+    // 2 buffers x (height float + biome uint) per cell of the (16 + 2K)^2 tile
+    uint32_t sharedLimit = physical_device.properties.limits.maxComputeSharedMemorySize;
+    int k = std::clamp(config.temporalK, 1, 8);
+    while (k > 1 && 2u * 8u * (16u + 2u * k) * (16u + 2u * k) > sharedLimit) k--;
+    if (k != config.temporalK) {
+        std::cout << "Temporal blocking: K=" << config.temporalK << " unsupported, using K=" << k << "\n";
+    }
+    temporalK = k;
 
-    VkCommandBufferBeginInfo beginInfo = {};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(cmd, &beginInfo);
-    
-    // Clear both biome images to 0 (WATER) first
-    VkClearColorValue clearColor = {};
-    clearColor.uint32[0] = 0; // WATER = 0
-    VkImageSubresourceRange range = {};
-    range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    range.baseMipLevel = 0;
-    range.levelCount = 1;
-    range.baseArrayLayer = 0;
-    range.layerCount = 1;
-    
-    vkCmdClearColorImage(cmd, biome_images[0], VK_IMAGE_LAYOUT_GENERAL, &clearColor, 1, &range);
-    vkCmdClearColorImage(cmd, biome_images[1], VK_IMAGE_LAYOUT_GENERAL, &clearColor, 1, &range);
-    
-    // Memory barrier after clear
-    VkMemoryBarrier memBarrier = {};
-    memBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-    memBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    memBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memBarrier, 0, nullptr, 0, nullptr);
-    
-    // Now run biome CA to set height-based biomes
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_pipeline);
-    
-    // Push constants
-    biomePushConstants.time = 0.0f;
-    vkCmdPushConstants(cmd, biome_ca_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BiomePushConstants), &biomePushConstants);
-    
-    // Dispatch to both biome images
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_pipeline_layout, 0, 1, &compute_descriptor_sets[0], 0, nullptr);
-    vkCmdDispatch(cmd, simWidth/16, simHeight/16, 1);
-    
-    memBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-    memBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memBarrier, 0, nullptr, 0, nullptr);
-    
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_pipeline_layout, 0, 1, &compute_descriptor_sets[1], 0, nullptr);
-    vkCmdDispatch(cmd, simWidth/16, simHeight/16, 1);
-    
-    vkEndCommandBuffer(cmd);
-    
-    VkSubmitInfo submitInfo = {};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &cmd;
-    vkQueueSubmit(graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphics_queue);
-    vkFreeCommandBuffers(device.device, command_pool, 1, &cmd);
-}
+    VkShaderModule temporalShader;
+    if (!load_shader_module("shaders/sim_temporal.comp.spv", &temporalShader)) {
+        std::cerr << "Failed to load shaders/sim_temporal.comp.spv\n";
+        abort();
+    }
 
-void LivingWorlds::init_viz_pipeline() {
-    VkDescriptorSetLayoutBinding bindings[4] = {};
-    bindings[0].binding = 0;
-    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    bindings[0].descriptorCount = 1;
-    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    // K (constant 0) + HEIGHT_LEVELS (constant 10)
+    struct { int32_t k; float heightLevels; } specData = {temporalK, heightLevels};
+    VkSpecializationMapEntry specEntries[2] = {
+        {0, offsetof(decltype(specData), k), sizeof(int32_t)},
+        {10, offsetof(decltype(specData), heightLevels), sizeof(float)},
+    };
 
-    bindings[1].binding = 1;
-    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    bindings[1].descriptorCount = 1;
-    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    VkSpecializationInfo specInfo = {};
+    specInfo.mapEntryCount = 2;
+    specInfo.pMapEntries = specEntries;
+    specInfo.dataSize = sizeof(specData);
+    specInfo.pData = &specData;
 
-    bindings[2].binding = 2;
-    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    bindings[2].descriptorCount = 1;
-    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    VkPipelineShaderStageCreateInfo shaderStageInfo = {};
+    shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shaderStageInfo.module = temporalShader;
+    shaderStageInfo.pName = "main";
+    shaderStageInfo.pSpecializationInfo = &specInfo;
 
-    bindings[3].binding = 3;
-    bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    bindings[3].descriptorCount = 1;
-    bindings[3].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(TemporalPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &compute_descriptor_layout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    VK_CHECK(vkCreatePipelineLayout(device.device, &pipelineLayoutInfo, nullptr, &temporal_pipeline_layout));
+
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = shaderStageInfo;
+    pipelineInfo.layout = temporal_pipeline_layout;
 
+    VK_CHECK(vkCreateComputePipelines(device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &temporal_pipeline));
+
+    vkDestroyShaderModule(device.device, temporalShader, nullptr);
+}
+
+// Active tiles: per-tile change flags and compacted tile lists, each double
+// buffered by parity. Set 1 of the active pipelines, per parity p:
+//   0: flags[p] (read by compaction)      1: flags[1-p] (last change kept as bit 1, then set by kernels)
+//   2: list[p] (built, then dispatched)   3: list[1-p] (count reset)
+void LivingWorlds::init_active_tiles() {
+    if (config.fusedSim || config.temporalK > 0) {
+        std::cout << "Active tiles: only supported with the two-pass kernels, disabled\n";
+        config.activeTiles = false;
+        return;
+    }
+    
+    tilesX = (simWidth + 15) / 16;
+    tilesY = (simHeight + 15) / 16;
+    VkDeviceSize flagSize = sizeof(uint32_t) * tilesX * tilesY;
+    VkDeviceSize listSize = sizeof(VkDispatchIndirectCommand) + sizeof(uint32_t) * tilesX * tilesY;
+    
+    for (int i = 0; i < 2; i++) {
+        create_buffer(flagSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                      VMA_MEMORY_USAGE_GPU_ONLY, tile_flag_buffers[i], tile_flag_allocations[i]);
+        create_buffer(listSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                      VMA_MEMORY_USAGE_GPU_ONLY, tile_list_buffers[i], tile_list_allocations[i]);
+        track_vram("Active tiles", tile_flag_allocations[i]);
+        track_vram("Active tiles", tile_list_allocations[i]);
+    }
+    
+    // Layout (set 1)
+    VkDescriptorSetLayoutBinding bindings[4] = {};
+    for (int i = 0; i < 4; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    
     VkDescriptorSetLayoutCreateInfo layoutInfo = {};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfo.bindingCount = 4;
     layoutInfo.pBindings = bindings;
-
-    VK_CHECK(vkCreateDescriptorSetLayout(device.device, &layoutInfo, nullptr, &viz_descriptor_layout));
+    VK_CHECK(vkCreateDescriptorSetLayout(device.device, &layoutInfo, nullptr, &active_tile_layout));
     
-    // Allocate 2 sets (one for each heightmap)
-    // We can reuse the main descriptor pool if it has space, but we didn't allocate enough.
-    // Let's create a small local pool for Viz.
     VkDescriptorPoolSize poolSize = {};
-    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     poolSize.descriptorCount = 8; // 2 sets * 4 bindings
-
+    
     VkDescriptorPoolCreateInfo poolInfo = {};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     poolInfo.poolSizeCount = 1;
     poolInfo.pPoolSizes = &poolSize;
     poolInfo.maxSets = 2;
+    VK_CHECK(vkCreateDescriptorPool(device.device, &poolInfo, nullptr, &active_tile_pool));
+    
+    VkDescriptorSetLayout layouts[2] = {active_tile_layout, active_tile_layout};
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = active_tile_pool;
+    allocInfo.descriptorSetCount = 2;
+    allocInfo.pSetLayouts = layouts;
+    VK_CHECK(vkAllocateDescriptorSets(device.device, &allocInfo, active_tile_sets));
+    
+    for (int p = 0; p < 2; p++) {
+        VkDescriptorBufferInfo infos[4] = {
+            {tile_flag_buffers[p], 0, VK_WHOLE_SIZE},
+            {tile_flag_buffers[1 - p], 0, VK_WHOLE_SIZE},
+            {tile_list_buffers[p], 0, VK_WHOLE_SIZE},
+            {tile_list_buffers[1 - p], 0, VK_WHOLE_SIZE},
+        };
+        VkWriteDescriptorSet writes[4] = {};
+        for (int b = 0; b < 4; b++) {
+            writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[b].dstSet = active_tile_sets[p];
+            writes[b].dstBinding = b;
+            writes[b].descriptorCount = 1;
+            writes[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[b].pBufferInfo = &infos[b];
+        }
+        vkUpdateDescriptorSets(device.device, 4, writes, 0, nullptr);
+    }
+    
+    // One layout for compaction and the kernel variants; the push range
+    // covers the largest block (BiomePushConstants)
+    VkDescriptorSetLayout setLayouts[2] = {compute_descriptor_layout, active_tile_layout};
+    
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(BiomePushConstants);
+    
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 2;
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK(vkCreatePipelineLayout(device.device, &pipelineLayoutInfo, nullptr, &active_pipeline_layout));
+    
+    auto create_pipeline = [&](const char* path, VkPipeline* pipeline) {
+        VkShaderModule shader;
+        if (!load_shader_module(path, &shader)) {
+            std::cerr << "Failed to load " << path << "\n";
+            abort();
+        }
+        
+        VkComputePipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = shader;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.stage.pSpecializationInfo = &heightSpecInfo;
+        pipelineInfo.layout = active_pipeline_layout;
+        VK_CHECK(vkCreateComputePipelines(device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, pipeline));
+        
+        vkDestroyShaderModule(device.device, shader, nullptr);
+    };
+    create_pipeline("shaders/tile_compact.comp.spv", &tile_compact_pipeline);
+    create_pipeline("shaders/erosion_active.comp.spv", &erosion_active_pipeline);
+    create_pipeline("shaders/biome_ca_active.comp.spv", &biome_ca_active_pipeline);
+    
+    std::cout << "Active tiles: " << tilesX << "x" << tilesY << " erosion tiles\n";
+}
+
+// Re-activates the tiles covering a cell rectangle edited outside the sim
+void LivingWorlds::mark_dirty_tiles(int x0, int y0, int x1, int y1) {
+    if (!config.activeTiles) return;
+    int tx0 = x0 / 16, ty0 = y0 / 16, tx1 = x1 / 16, ty1 = y1 / 16;
+    if (hasDirtyTiles) {
+        tx0 = std::min(tx0, dirtyTileRect[0]);
+        ty0 = std::min(ty0, dirtyTileRect[1]);
+        tx1 = std::max(tx1, dirtyTileRect[2]);
+        ty1 = std::max(ty1, dirtyTileRect[3]);
+    }
+    dirtyTileRect[0] = tx0; dirtyTileRect[1] = ty0;
+    dirtyTileRect[2] = tx1; dirtyTileRect[3] = ty1;
+    hasDirtyTiles = true;
+}
+
+// Active-tile version of the two-pass step loop. Per step:
+//   compact (flags of the last two steps -> list) -> erosion indirect -> biome CA full
+// Erosion at step N reads the biome the CA wrote at step N-2, so a change
+// keeps its tiles active for two steps; with that, skipping a tile is exact
+// (same inputs, same output). The biome CA's rules draw from a time-seeded
+// hash and can fire on a settled tile, so it runs over the whole grid and
+// only reports its changes; results match the full two-pass path.
+void LivingWorlds::record_active_tile_steps(VkCommandBuffer cmd, uint32_t steps) {
+    VkMemoryBarrier memBar = {};
+    memBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memBar.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    memBar.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    VkPipelineStageFlags allStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+    
+    if (activeTilesNeedClear) {
+        // Both lists start empty with a 1x1 dispatch tail; both flag sets clear
+        for (int i = 0; i < 2; i++) {
+            vkCmdFillBuffer(cmd, tile_flag_buffers[i], 0, VK_WHOLE_SIZE, 0);
+            VkDispatchIndirectCommand empty = {0, 1, 1};
+            vkCmdUpdateBuffer(cmd, tile_list_buffers[i], 0, sizeof(empty), &empty);
+        }
+        activeTilesNeedClear = false;
+        activeTilesForce = true;
+    }
+    
+    if (hasDirtyTiles) {
+        // Spawn edits: raise the flags the next compaction reads
+        int x0 = std::clamp(dirtyTileRect[0], 0, (int)tilesX - 1);
+        int x1 = std::clamp(dirtyTileRect[2], 0, (int)tilesX - 1);
+        int y0 = std::clamp(dirtyTileRect[1], 0, (int)tilesY - 1);
+        int y1 = std::clamp(dirtyTileRect[3], 0, (int)tilesY - 1);
+        for (int ty = y0; ty <= y1; ty++) {
+            VkDeviceSize offset = sizeof(uint32_t) * (ty * tilesX + x0);
+            vkCmdFillBuffer(cmd, tile_flag_buffers[activeParity], offset, sizeof(uint32_t) * (x1 - x0 + 1), 1);
+        }
+        hasDirtyTiles = false;
+    }
+    
+    // Erosion slider changes can wake any tile
+    if (memcmp(&erosionParams, &lastErosionParams, sizeof(ErosionPushConstants)) != 0) {
+        activeTilesForce = true;
+        lastErosionParams = erosionParams;
+    }
+    
+    struct { int32_t tileCountX, tileCountY; uint32_t forceAll; } compactParams;
+    compactParams.tileCountX = static_cast<int32_t>(tilesX);
+    compactParams.tileCountY = static_cast<int32_t>(tilesY);
+    
+    for (uint32_t i = 0; i < steps; i++) {
+        size_t in_idx = current_heightmap_index;
+        size_t out_idx = (in_idx + 1) % 2;
+        VkDescriptorSet activeSet = active_tile_sets[activeParity];
+        VkBuffer list = tile_list_buffers[activeParity];
+        
+        compactParams.forceAll = activeTilesForce ? 1u : 0u;
+        activeTilesForce = false;
+        
+        // Previous step (or fills above) -> compaction
+        vkCmdPipelineBarrier(cmd, allStages, allStages, 0, 1, &memBar, 0, nullptr, 0, nullptr);
+        
+        // 0. COMPACTION
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, tile_compact_pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, active_pipeline_layout, 1, 1, &activeSet, 0, nullptr);
+        vkCmdPushConstants(cmd, active_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(compactParams), &compactParams);
+        vkCmdDispatch(cmd, (tilesX + 15) / 16, (tilesY + 15) / 16, 1);
+        
+        vkCmdPipelineBarrier(cmd, allStages, allStages, 0, 1, &memBar, 0, nullptr, 0, nullptr);
+        
+        // 1. EROSION (active tiles only)
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, erosion_active_pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, active_pipeline_layout, 0, 1, &compute_descriptor_sets[in_idx], 0, nullptr);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, active_pipeline_layout, 1, 1, &activeSet, 0, nullptr);
+        vkCmdPushConstants(cmd, active_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ErosionPushConstants), &erosionParams);
+        vkCmdDispatchIndirect(cmd, list, 0);
+        
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memBar, 0, nullptr, 0, nullptr);
+        
+        // 2. DISCRETE BIOME CA (every tile, marks its changes)
+        simStep++;
+        biomePushConstants.time = static_cast<float>(simStep);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_active_pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, active_pipeline_layout, 0, 1, &compute_descriptor_sets[out_idx], 0, nullptr);
+        vkCmdPushConstants(cmd, active_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BiomePushConstants), &biomePushConstants);
+        vkCmdDispatch(cmd, simWidth/16, simHeight/16, 1);
+        
+        current_heightmap_index = out_idx;
+        activeParity = 1 - activeParity;
+    }
+}
+
+// Bit-sliced biomes: 4 bitplanes per generation (0.5 byte/cell), ping-ponged
+// like the R8 images. Set 1 per parity p: 0 = planes[p], 1 = planes[1-p].
+void LivingWorlds::init_bitsliced_biome() {
+    if (config.fusedSim || config.temporalK > 0 || config.activeTiles) {
+        std::cout << "Bit-sliced biomes: only supported with the two-pass kernels, disabled\n";
+        config.bitslicedBiome = false;
+        return;
+    }
+    if (simWidth % 32 != 0) {
+        std::cout << "Bit-sliced biomes: grid width must be a multiple of 32, disabled\n";
+        config.bitslicedBiome = false;
+        return;
+    }
+    
+    VkDeviceSize planeSize = sizeof(uint32_t) * 4 * (simWidth / 32) * simHeight;
+    for (int i = 0; i < 2; i++) {
+        create_buffer(planeSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY,
+                      biome_plane_buffers[i], biome_plane_allocations[i]);
+        track_vram("Biome bitplanes", biome_plane_allocations[i]);
+    }
+    
+    VkDescriptorSetLayoutBinding bindings[2] = {};
+    for (int i = 0; i < 2; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = bindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(device.device, &layoutInfo, nullptr, &biome_plane_layout));
+    
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 4; // 2 sets * 2 bindings
+    
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 2;
+    VK_CHECK(vkCreateDescriptorPool(device.device, &poolInfo, nullptr, &biome_plane_pool));
+    
+    VkDescriptorSetLayout layouts[2] = {biome_plane_layout, biome_plane_layout};
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = biome_plane_pool;
+    allocInfo.descriptorSetCount = 2;
+    allocInfo.pSetLayouts = layouts;
+    VK_CHECK(vkAllocateDescriptorSets(device.device, &allocInfo, biome_plane_sets));
+    
+    for (int p = 0; p < 2; p++) {
+        VkDescriptorBufferInfo infos[2] = {
+            {biome_plane_buffers[p], 0, VK_WHOLE_SIZE},
+            {biome_plane_buffers[1 - p], 0, VK_WHOLE_SIZE},
+        };
+        VkWriteDescriptorSet writes[2] = {};
+        for (int b = 0; b < 2; b++) {
+            writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[b].dstSet = biome_plane_sets[p];
+            writes[b].dstBinding = b;
+            writes[b].descriptorCount = 1;
+            writes[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[b].pBufferInfo = &infos[b];
+        }
+        vkUpdateDescriptorSets(device.device, 2, writes, 0, nullptr);
+    }
+    
+    // One layout for erosion, the CA and the converter; the push range
+    // covers the largest block (BiomePushConstants)
+    VkDescriptorSetLayout setLayouts[2] = {compute_descriptor_layout, biome_plane_layout};
+    
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(BiomePushConstants);
+    
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 2;
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK(vkCreatePipelineLayout(device.device, &pipelineLayoutInfo, nullptr, &bitsliced_pipeline_layout));
+    
+    auto create_pipeline = [&](const char* path, VkPipeline* pipeline) {
+        VkShaderModule shader;
+        if (!load_shader_module(path, &shader)) {
+            std::cerr << "Failed to load " << path << "\n";
+            abort();
+        }
+        
+        VkComputePipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = shader;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = bitsliced_pipeline_layout;
+        VK_CHECK(vkCreateComputePipelines(device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, pipeline));
+        
+        vkDestroyShaderModule(device.device, shader, nullptr);
+    };
+    if (config.enableErosion) create_pipeline("shaders/erosion_bitsliced.comp.spv", &erosion_bitsliced_pipeline);
+    create_pipeline("shaders/biome_ca_bitsliced.comp.spv", &biome_ca_bitsliced_pipeline);
+    create_pipeline("shaders/biome_planes_convert.comp.spv", &biome_convert_pipeline);
+    
+    std::cout << "Bit-sliced biomes: " << (2 * planeSize) / (1024 * 1024) << " MB of bitplanes\n";
+}
+
+// Bit-sliced version of the two-pass step loop. Same ping-pong and
+// one-barrier-per-step pattern (see record_simulation_steps), with planes[i]
+// standing in for Bio[i]. The R8 images are packed when something outside
+// the sim wrote them, and unpacked once at the end of the batch.
+void LivingWorlds::record_bitsliced_steps(VkCommandBuffer cmd, uint32_t steps) {
+    VkMemoryBarrier memBar = {};
+    memBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memBar.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memBar.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    
+    uint32_t toPlanes = 1;
+    uint32_t convertGroupsX = (simWidth / 32 + 63) / 64;
+    
+    if (biomePlanesNeedPack) {
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memBar, 0, nullptr, 0, nullptr);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_convert_pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, bitsliced_pipeline_layout, 0, 1, &compute_descriptor_sets[0], 0, nullptr);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, bitsliced_pipeline_layout, 1, 1, &biome_plane_sets[0], 0, nullptr);
+        vkCmdPushConstants(cmd, bitsliced_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &toPlanes);
+        vkCmdDispatch(cmd, convertGroupsX, simHeight, 1);
+        biomePlanesNeedPack = false;
+    }
+    if (steps == 0) return;
+    
+    // Previous batch / pack -> first erosion
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memBar, 0, nullptr, 0, nullptr);
+    
+    for (uint32_t i = 0; i < steps; i++) {
+        size_t in_idx = current_heightmap_index;
+        size_t out_idx = (in_idx + 1) % 2;
+
+        // 1. EROSION (reads H[in] + planes[in], writes H[out])
+        if (config.enableErosion) {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, erosion_bitsliced_pipeline);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, bitsliced_pipeline_layout, 0, 1, &compute_descriptor_sets[in_idx], 0, nullptr);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, bitsliced_pipeline_layout, 1, 1, &biome_plane_sets[in_idx], 0, nullptr);
+            vkCmdPushConstants(cmd, bitsliced_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ErosionPushConstants), &erosionParams);
+            vkCmdDispatch(cmd, simWidth/16, simHeight/16, 1);
+
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memBar, 0, nullptr, 0, nullptr);
+        }
+
+        // 2. BIT-SLICED BIOME CA (planes[out] -> planes[in], 32 cells per invocation)
+        simStep++;
+        biomePushConstants.time = static_cast<float>(simStep);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_bitsliced_pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, bitsliced_pipeline_layout, 0, 1, &compute_descriptor_sets[out_idx], 0, nullptr);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, bitsliced_pipeline_layout, 1, 1, &biome_plane_sets[out_idx], 0, nullptr);
+        vkCmdPushConstants(cmd, bitsliced_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BiomePushConstants), &biomePushConstants);
+        vkCmdDispatch(cmd, (simWidth / 32 + 7) / 8, (simHeight + 7) / 8, 1);
+
+        current_heightmap_index = out_idx;
+    }
+    
+    // Unpack both generations for the renderer / stats / display copy
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memBar, 0, nullptr, 0, nullptr);
+    toPlanes = 0;
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_convert_pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, bitsliced_pipeline_layout, 0, 1, &compute_descriptor_sets[0], 0, nullptr);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, bitsliced_pipeline_layout, 1, 1, &biome_plane_sets[0], 0, nullptr);
+    vkCmdPushConstants(cmd, bitsliced_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &toPlanes);
+    vkCmdDispatch(cmd, convertGroupsX, simHeight, 1);
+}
+
+// Convergence detection: sim_stats.comp reduces the last step of each batch
+// into a host-visible slot, read once the fence/timeline for that batch passed
+void LivingWorlds::init_sim_stats() {
+    create_buffer(sizeof(SimStats) * SIM_STATS_SLOTS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                  VMA_MEMORY_USAGE_GPU_TO_CPU, sim_stats_buffer, sim_stats_allocation);
+    track_vram("Sim stats", sim_stats_allocation);
+    void* mapped;
+    vmaMapMemory(allocator, sim_stats_allocation, &mapped);
+    sim_stats_mapped = static_cast<SimStats*>(mapped);
+    memset(sim_stats_mapped, 0, sizeof(SimStats) * SIM_STATS_SLOTS);
+    vmaFlushAllocation(allocator, sim_stats_allocation, 0, VK_WHOLE_SIZE);
+    
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+    VK_CHECK(vkCreateDescriptorSetLayout(device.device, &layoutInfo, nullptr, &sim_stats_layout));
+    
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 1;
+    
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+    VK_CHECK(vkCreateDescriptorPool(device.device, &poolInfo, nullptr, &sim_stats_pool));
+    
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = sim_stats_pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &sim_stats_layout;
+    VK_CHECK(vkAllocateDescriptorSets(device.device, &allocInfo, &sim_stats_set));
+    
+    VkDescriptorBufferInfo bufferInfo = {sim_stats_buffer, 0, VK_WHOLE_SIZE};
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = sim_stats_set;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+    vkUpdateDescriptorSets(device.device, 1, &write, 0, nullptr);
+    
+    VkDescriptorSetLayout setLayouts[2] = {compute_descriptor_layout, sim_stats_layout};
+    
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(uint32_t);
+    
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 2;
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK(vkCreatePipelineLayout(device.device, &pipelineLayoutInfo, nullptr, &sim_stats_pipeline_layout));
+    
+    VkShaderModule statsShader;
+    if (!load_shader_module("shaders/sim_stats.comp.spv", &statsShader)) {
+        std::cerr << "Failed to load sim_stats.comp.spv\n";
+        abort();
+    }
+    
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = statsShader;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = sim_stats_pipeline_layout;
+    VK_CHECK(vkCreateComputePipelines(device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &sim_stats_pipeline));
+    
+    vkDestroyShaderModule(device.device, statsShader, nullptr);
+}
+
+// Appends the stats reduction for the batch just recorded. The step it
+// samples read from index 1 - current_heightmap_index.
+void LivingWorlds::record_sim_stats(VkCommandBuffer cmd, int slot, uint32_t steps) {
+    if (!sim_stats_pipeline || steps == 0) return;
+    
+    // Last step's input and output generation -> stats
+    size_t in_idx = 1 - current_heightmap_index;
+    frame_graph.add_pass("sim stats", VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         {fg_height[0], fg_height[1], fg_biome[0], fg_biome[1]}, {fg_stats},
+                         [this, slot, in_idx](VkCommandBuffer c) {
+        uint32_t slotIndex = static_cast<uint32_t>(slot);
+        vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, sim_stats_pipeline);
+        vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, sim_stats_pipeline_layout, 0, 1, &compute_descriptor_sets[in_idx], 0, nullptr);
+        vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, sim_stats_pipeline_layout, 1, 1, &sim_stats_set, 0, nullptr);
+        vkCmdPushConstants(c, sim_stats_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &slotIndex);
+        vkCmdDispatch(c, (simWidth + 15) / 16, (simHeight + 15) / 16, 1);
+        
+        // Stats -> host read after the fence/timeline wait (outside the graph)
+        VkMemoryBarrier hostBar = {};
+        hostBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        hostBar.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        hostBar.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(c, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 1, &hostBar, 0, nullptr, 0, nullptr);
+    });
+    frame_graph.execute(cmd);
+    
+    statsPendingSteps[slot] = steps;
+}
+
+// Reads a finished slot and updates the idle state. Only called once the
+// batch that wrote it is known complete, so it never stalls.
+void LivingWorlds::read_sim_stats(int slot) {
+    uint32_t steps = statsPendingSteps[slot];
+    if (steps == 0) return;
+    statsPendingSteps[slot] = 0;
+    
+    vmaInvalidateAllocation(allocator, sim_stats_allocation, 0, VK_WHOLE_SIZE);
+    lastStats = sim_stats_mapped[slot];
+    // Re-zero from the host: the next submit using this slot sees it without
+    // a fill + transfer barrier on the GPU
+    sim_stats_mapped[slot] = SimStats{};
+    vmaFlushAllocation(allocator, sim_stats_allocation, sizeof(SimStats) * slot, sizeof(SimStats));
+    
+    uint32_t quietLimit = static_cast<uint32_t>(config.idleThreshold * simWidth * simHeight);
+    if (lastStats.changedCells <= quietLimit) {
+        quietSteps += steps;
+    } else {
+        quietSteps = 0;
+        simIdling = false;
+    }
+    
+    if (config.autoIdle && !simIdling && quietSteps >= static_cast<uint32_t>(std::max(config.idleSteps, 1))) {
+        simIdling = true;
+        std::cout << "Auto-idle: world converged after step " << simStep
+                  << ", ticking every " << IDLE_INTERVAL << "s\n";
+    }
+}
+
+// Spawn, reset and parameter edits can restart a converged world
+void LivingWorlds::wake_simulation() {
+    quietSteps = 0;
+    simIdling = false;
+}
+
+// --verify only: a host-visible result buffer for state_hash.comp, bound
+// after the compute set like the sim stats, and with --verify-reference a
+// readback buffer for the four ping-pong images
+void LivingWorlds::init_state_hash() {
+    create_buffer(sizeof(uint32_t) * 4, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU,
+                  state_hash_buffer, state_hash_allocation);
+    void* mapped;
+    vmaMapMemory(allocator, state_hash_allocation, &mapped);
+    state_hash_mapped = static_cast<uint32_t*>(mapped);
+    memset(state_hash_mapped, 0, sizeof(uint32_t) * 4);
+    vmaFlushAllocation(allocator, state_hash_allocation, 0, VK_WHOLE_SIZE);
+    
+    if (config.verifyReference) {
+        VkDeviceSize texels = static_cast<VkDeviceSize>(simWidth) * simHeight;
+        VkDeviceSize heightBytes = texels * height_bytes_per_texel(height_encoding());
+        create_buffer(2 * heightBytes + 2 * texels, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU,
+                      verify_readback_buffer, verify_readback_allocation);
+        vmaMapMemory(allocator, verify_readback_allocation, &mapped);
+        verify_readback_mapped = static_cast<uint8_t*>(mapped);
+    }
+    
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+    VK_CHECK(vkCreateDescriptorSetLayout(device.device, &layoutInfo, nullptr, &state_hash_layout));
+    
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 1;
+    
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+    VK_CHECK(vkCreateDescriptorPool(device.device, &poolInfo, nullptr, &state_hash_pool));
+    
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = state_hash_pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &state_hash_layout;
+    VK_CHECK(vkAllocateDescriptorSets(device.device, &allocInfo, &state_hash_set));
+    
+    VkDescriptorBufferInfo bufferInfo = {state_hash_buffer, 0, VK_WHOLE_SIZE};
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = state_hash_set;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+    vkUpdateDescriptorSets(device.device, 1, &write, 0, nullptr);
+    
+    VkDescriptorSetLayout setLayouts[2] = {compute_descriptor_layout, state_hash_layout};
+    
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 2;
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
+    VK_CHECK(vkCreatePipelineLayout(device.device, &pipelineLayoutInfo, nullptr, &state_hash_pipeline_layout));
+    
+    VkShaderModule hashShader;
+    if (!load_shader_module("shaders/state_hash.comp.spv", &hashShader)) {
+        std::cerr << "Failed to load state_hash.comp.spv\n";
+        abort();
+    }
+    
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = hashShader;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.stage.pSpecializationInfo = &heightSpecInfo;
+    pipelineInfo.layout = state_hash_pipeline_layout;
+    VK_CHECK(vkCreateComputePipelines(device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &state_hash_pipeline));
+    
+    vkDestroyShaderModule(device.device, hashShader, nullptr);
+}
+
+// Hashes H[cur] and Bio[1 - cur], the pair record_export() would read back
+void LivingWorlds::record_state_hash(VkCommandBuffer cmd) {
+    size_t cur = current_heightmap_index;
+    frame_graph.add_pass("state hash", VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         {fg_height[cur], fg_biome[1 - cur]}, {fg_state_hash},
+                         [this, cur](VkCommandBuffer c) {
+        vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, state_hash_pipeline);
+        vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, state_hash_pipeline_layout, 0, 1, &compute_descriptor_sets[cur], 0, nullptr);
+        vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, state_hash_pipeline_layout, 1, 1, &state_hash_set, 0, nullptr);
+        vkCmdDispatch(c, (simWidth + 15) / 16, (simHeight + 15) / 16, 1);
+        
+        VkMemoryBarrier hostBar = {};
+        hostBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        hostBar.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        hostBar.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(c, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 1, &hostBar, 0, nullptr, 0, nullptr);
+    });
+    frame_graph.execute(cmd);
+}
+
+// Both ping-pong slots of both layers: the reference restarts from all of
+// them, since erosion reads the biome slot the CA step didn't just write
+void LivingWorlds::record_verify_readback(VkCommandBuffer cmd) {
+    if (!verify_readback_buffer) return;
+    VkDeviceSize heightBytes = static_cast<VkDeviceSize>(simWidth) * simHeight * height_bytes_per_texel(height_encoding());
+    frame_graph.add_pass("verify readback", VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         {fg_height[0], fg_height[1], fg_biome[0], fg_biome[1]}, {},
+                         [this, heightBytes](VkCommandBuffer c) {
+        VkDeviceSize texels = static_cast<VkDeviceSize>(simWidth) * simHeight;
+        VkBufferImageCopy region = {};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {simWidth, simHeight, 1};
+        for (int i = 0; i < 2; i++) {
+            region.bufferOffset = heightBytes * i;
+            vkCmdCopyImageToBuffer(c, heightmap_images[i], VK_IMAGE_LAYOUT_GENERAL, verify_readback_buffer, 1, &region);
+            region.bufferOffset = 2 * heightBytes + texels * i;
+            vkCmdCopyImageToBuffer(c, biome_images[i], VK_IMAGE_LAYOUT_GENERAL, verify_readback_buffer, 1, &region);
+        }
+        
+        VkMemoryBarrier hostBar = {};
+        hostBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        hostBar.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        hostBar.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(c, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 1, &hostBar, 0, nullptr, 0, nullptr);
+    });
+    frame_graph.execute(cmd);
+}
+
+// Submit must be complete. Re-zeroes the lanes for the next hash.
+StateHash LivingWorlds::read_state_hash() {
+    vmaInvalidateAllocation(allocator, state_hash_allocation, 0, VK_WHOLE_SIZE);
+    StateHash hash = state_hash_from_lanes(state_hash_mapped);
+    memset(state_hash_mapped, 0, sizeof(uint32_t) * 4);
+    vmaFlushAllocation(allocator, state_hash_allocation, 0, VK_WHOLE_SIZE);
+    return hash;
+}
+
+void LivingWorlds::destroy_state_hash() {
+    if (!state_hash_buffer) return;
+    vkDestroyPipeline(device.device, state_hash_pipeline, nullptr);
+    vkDestroyPipelineLayout(device.device, state_hash_pipeline_layout, nullptr);
+    vkDestroyDescriptorPool(device.device, state_hash_pool, nullptr);
+    vkDestroyDescriptorSetLayout(device.device, state_hash_layout, nullptr);
+    vmaUnmapMemory(allocator, state_hash_allocation);
+    vmaDestroyBuffer(allocator, state_hash_buffer, state_hash_allocation);
+    state_hash_buffer = VK_NULL_HANDLE;
+    if (verify_readback_buffer) {
+        vmaUnmapMemory(allocator, verify_readback_allocation);
+        vmaDestroyBuffer(allocator, verify_readback_buffer, verify_readback_allocation);
+        verify_readback_buffer = VK_NULL_HANDLE;
+    }
+}
+
+// Brush edits: a persistent host-visible arena with one MAX_BRUSH_EVENTS
+// region per frame in flight plus one for the async batch, each reused only
+// after the fence/timeline of its previous submit
+void LivingWorlds::init_brush_pipeline() {
+    VkDeviceSize arenaSize = sizeof(BrushEvent) * MAX_BRUSH_EVENTS * (MAX_FRAMES_IN_FLIGHT + 1);
+    create_buffer(arenaSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
+                  brush_buffer, brush_allocation);
+    track_vram("Brush arena", brush_allocation);
+    void* mapped;
+    vmaMapMemory(allocator, brush_allocation, &mapped);
+    brush_mapped = static_cast<BrushEvent*>(mapped);
+    
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+    VK_CHECK(vkCreateDescriptorSetLayout(device.device, &layoutInfo, nullptr, &brush_layout));
+    
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 1;
+    
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+    VK_CHECK(vkCreateDescriptorPool(device.device, &poolInfo, nullptr, &brush_pool));
+    
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = brush_pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &brush_layout;
+    VK_CHECK(vkAllocateDescriptorSets(device.device, &allocInfo, &brush_set));
+    
+    VkDescriptorBufferInfo bufferInfo = {brush_buffer, 0, VK_WHOLE_SIZE};
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = brush_set;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+    vkUpdateDescriptorSets(device.device, 1, &write, 0, nullptr);
+    
+    VkDescriptorSetLayout setLayouts[2] = {compute_descriptor_layout, brush_layout};
+    
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(BrushPushConstants);
+    
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 2;
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK(vkCreatePipelineLayout(device.device, &pipelineLayoutInfo, nullptr, &brush_pipeline_layout));
+    
+    VkShaderModule brushShader;
+    if (!load_shader_module("shaders/brush.comp.spv", &brushShader)) {
+        std::cerr << "Failed to load brush.comp.spv\n";
+        abort();
+    }
+    
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = brushShader;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.stage.pSpecializationInfo = &heightSpecInfo;
+    pipelineInfo.layout = brush_pipeline_layout;
+    VK_CHECK(vkCreateComputePipelines(device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &brush_pipeline));
+    
+    vkDestroyShaderModule(device.device, brushShader, nullptr);
+}
+
+// Turns a click or drag sample into a brush event for the next frame
+void LivingWorlds::queue_brush(float u, float v) {
+    BrushEvent e = {};
+    e.centerX = u * simWidth;
+    e.centerY = v * simHeight;
+    e.radius = spawnRadius + 0.5f;
+    e.falloff = brushFalloff;
+    e.biome = -1;
+    switch (spawnMode) {
+        case SPAWN_FOREST:   e.biome = 3; break;
+        case SPAWN_DESERT:   e.biome = 4; break;
+        case SPAWN_WATER:    e.biome = 0; break;
+        case SPAWN_MOUNTAIN: e.biome = 5; break; // ROCK
+        case SPAWN_GRASS:    e.biome = 2; break;
+        case SPAWN_RAISE:    e.heightDelta = brushStrength; break;
+        case SPAWN_LOWER:    e.heightDelta = -brushStrength; break;
+        default: return;
+    }
+    brushQueue.push_back(e);
+    displayDirty = true; // Async mode: submit a batch even if no step is due
+}
+
+// Uploads this frame's queued events into the arena region and applies them
+// with one dispatch over their bounding box
+void LivingWorlds::record_brush(VkCommandBuffer cmd, int region) {
+    if (!brush_pipeline || brushQueue.empty()) return;
+    
+    uint32_t count = static_cast<uint32_t>(std::min<size_t>(brushQueue.size(), MAX_BRUSH_EVENTS));
+    uint32_t offset = static_cast<uint32_t>(region) * MAX_BRUSH_EVENTS;
+    memcpy(brush_mapped + offset, brushQueue.data(), sizeof(BrushEvent) * count);
+    vmaFlushAllocation(allocator, brush_allocation, sizeof(BrushEvent) * offset, sizeof(BrushEvent) * count);
+    
+    float minX = static_cast<float>(simWidth), minY = static_cast<float>(simHeight);
+    float maxX = 0.0f, maxY = 0.0f;
+    bool paintsBiome = false, paintsHeight = false;
+    for (uint32_t i = 0; i < count; i++) {
+        const BrushEvent& e = brushQueue[i];
+        minX = std::min(minX, e.centerX - e.radius);
+        minY = std::min(minY, e.centerY - e.radius);
+        maxX = std::max(maxX, e.centerX + e.radius);
+        maxY = std::max(maxY, e.centerY + e.radius);
+        paintsBiome |= e.biome >= 0;
+        paintsHeight |= e.heightDelta != 0.0f;
+    }
+    brushQueue.erase(brushQueue.begin(), brushQueue.begin() + count); // Any rest goes next frame
+    
+    int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+    int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+    int x1 = std::min(static_cast<int>(simWidth) - 1, static_cast<int>(std::ceil(maxX)));
+    int y1 = std::min(static_cast<int>(simHeight) - 1, static_cast<int>(std::ceil(maxY)));
+    if (x1 < x0 || y1 < y0) return;
+    
+    BrushPushConstants pc = {x0, y0, offset, count};
+    uint32_t groupsX = static_cast<uint32_t>(x1 - x0 + 16) / 16;
+    uint32_t groupsY = static_cast<uint32_t>(y1 - y0 + 16) / 16;
+    frame_graph.add_pass("brush", VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         {fg_height[0], fg_height[1], fg_biome[0], fg_biome[1]},
+                         {fg_height[0], fg_height[1], fg_biome[0], fg_biome[1]},
+                         [this, pc, groupsX, groupsY](VkCommandBuffer c) {
+        VkDescriptorSet sets[2] = {compute_descriptor_sets[0], brush_set};
+        vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, brush_pipeline);
+        vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, brush_pipeline_layout, 0, 2, sets, 0, nullptr);
+        vkCmdPushConstants(c, brush_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BrushPushConstants), &pc);
+        vkCmdDispatch(c, groupsX, groupsY, 1);
+    });
+    frame_graph.execute(cmd);
+    
+    mark_dirty_tiles(x0, y0, x1, y1);
+    if (paintsBiome) biomePlanesNeedPack = true;
+    if (paintsHeight) {
+        pickRefreshDue = true;
+        mark_height_pyramid_dirty(x0, y0, x1, y1);
+    }
+    wake_simulation();
+}
+
+// Week 5.5: Discrete Biome CA Pipeline
+void LivingWorlds::init_biome_ca_pipeline() {
+    const char* shaderPath = config.biomeCADirect ? "shaders/biome_ca_baseline.comp.spv" : "shaders/biome_ca.comp.spv";
+    VkShaderModule biomeCaShader;
+    if (!load_shader_module(shaderPath, &biomeCaShader)) {
+        std::cerr << "Failed to load " << shaderPath << "\n";
+        abort();
+    }
+
+    VkPipelineShaderStageCreateInfo shaderStageInfo = {};
+    shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shaderStageInfo.module = biomeCaShader;
+    shaderStageInfo.pName = "main";
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(BiomePushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &compute_descriptor_layout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    VK_CHECK(vkCreatePipelineLayout(device.device, &pipelineLayoutInfo, nullptr, &biome_ca_pipeline_layout));
+
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = shaderStageInfo;
+    pipelineInfo.layout = biome_ca_pipeline_layout;
+
+    VK_CHECK(vkCreateComputePipelines(device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &biome_ca_pipeline));
+
+    vkDestroyShaderModule(device.device, biomeCaShader, nullptr);
+}
+
+void LivingWorlds::dispatch_biome_ca_init() {
+    // Initialize discrete biome layer: All land = GRASS (2), Water = WATER (0)
+    // First clear the biome images to 0
+    
+    VkCommandBuffer cmd;
+    VkCommandBufferAllocateInfo cmdAllocInfo = {};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.commandPool = command_pool;
+    cmdAllocInfo.commandBufferCount = 1;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    vkAllocateCommandBuffers(device.device, &cmdAllocInfo, &cmd);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cmd, &beginInfo);
+    
+    // Clear both biome images to 0 (WATER) first
+    VkClearColorValue clearColor = {};
+    clearColor.uint32[0] = 0; // WATER = 0
+    VkImageSubresourceRange range = {};
+    range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    range.baseMipLevel = 0;
+    range.levelCount = 1;
+    range.baseArrayLayer = 0;
+    range.layerCount = 1;
+    
+    vkCmdClearColorImage(cmd, biome_images[0], VK_IMAGE_LAYOUT_GENERAL, &clearColor, 1, &range);
+    vkCmdClearColorImage(cmd, biome_images[1], VK_IMAGE_LAYOUT_GENERAL, &clearColor, 1, &range);
+    
+    // Memory barrier after clear
+    VkMemoryBarrier memBarrier = {};
+    memBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memBarrier, 0, nullptr, 0, nullptr);
+    
+    // Now run biome CA to set height-based biomes
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_pipeline);
+    
+    // Push constants
+    biomePushConstants.time = 0.0f;
+    vkCmdPushConstants(cmd, biome_ca_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BiomePushConstants), &biomePushConstants);
+    
+    // Dispatch to both biome images
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_pipeline_layout, 0, 1, &compute_descriptor_sets[0], 0, nullptr);
+    vkCmdDispatch(cmd, simWidth/16, simHeight/16, 1);
+    
+    memBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memBarrier, 0, nullptr, 0, nullptr);
+    
+    // With the CA stage off both slots are the same image, and this pass
+    // would read and write it at once
+    if (config.enableBiomeCA) {
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_pipeline_layout, 0, 1, &compute_descriptor_sets[1], 0, nullptr);
+        vkCmdDispatch(cmd, simWidth/16, simHeight/16, 1);
+    }
+    
+    vkEndCommandBuffer(cmd);
+    
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmd;
+    vkQueueSubmit(graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(graphics_queue);
+    vkFreeCommandBuffers(device.device, command_pool, 1, &cmd);
+}
+
+void LivingWorlds::init_viz_pipeline() {
+    VkDescriptorSetLayoutBinding bindings[4] = {};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[3].binding = 3;
+    bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[3].descriptorCount = 1;
+    bindings[3].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 4;
+    layoutInfo.pBindings = bindings;
+
+    VK_CHECK(vkCreateDescriptorSetLayout(device.device, &layoutInfo, nullptr, &viz_descriptor_layout));
+    
+    // Allocate 2 sets (one for each heightmap)
+    // We can reuse the main descriptor pool if it has space, but we didn't allocate enough.
+    // Let's create a small local pool for Viz.
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSize.descriptorCount = 8; // 2 sets * 4 bindings
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 2;
+    
+    // VkDescriptorPool viz_pool; // We will leak this handle for now as it's destroyed with device, technically clean would be member.
+    // Ideally we add viz_descriptor_pool to class members. But for speed, let's just make it static or assume we won't resize.
+    // Actually, `descriptor_pool` in init_descriptors is a member. I can just USE IT if I resize it?
+    // No, existing sets are allocated. 
+    // I'll create a new pool and store it in a static variable (ugly) or just leak the pool handle (it gets destroyed when device is destroyed? No, need explicit destroy).
+    // Let's just add `VkDescriptorPool viz_descriptor_pool` to header via another edit to be clean.
+    // Wait, I can't do multiple file edits easily.
+    // Fine, I'll use a globally defined pool in this translation unit or just `descriptor_pool` if I hadn't capped it.
+    // Re-reading `init_descriptors`: `poolInfo.maxSets = 2;`. It is capped.
+    // OK, I will perform a separate replace_file_content to add `viz_descriptor_pool` to header. 
+    VK_CHECK(vkCreateDescriptorPool(device.device, &poolInfo, nullptr, &viz_descriptor_pool));
+
+    // Allocate 2 sets (One for each Heightmap ping-pong state)
+    viz_descriptor_sets.resize(2);
+    std::vector<VkDescriptorSetLayout> layouts(2, viz_descriptor_layout);
     
-    // VkDescriptorPool viz_pool; // We will leak this handle for now as it's destroyed with device, technically clean would be member.
-    // Ideally we add viz_descriptor_pool to class members. But for speed, let's just make it static or assume we won't resize.
-    // Actually, `descriptor_pool` in init_descriptors is a member. I can just USE IT if I resize it?
-    // No, existing sets are allocated. 
-    // I'll create a new pool and store it in a static variable (ugly) or just leak the pool handle (it gets destroyed when device is destroyed? No, need explicit destroy).
-    // Let's just add `VkDescriptorPool viz_descriptor_pool` to header via another edit to be clean.
-    // Wait, I can't do multiple file edits easily.
-    // Fine, I'll use a globally defined pool in this translation unit or just `descriptor_pool` if I hadn't capped it.
-    // Re-reading `init_descriptors`: `poolInfo.maxSets = 2;`. It is capped.
-    // OK, I will perform a separate replace_file_content to add `viz_descriptor_pool` to header. 
-    VK_CHECK(vkCreateDescriptorPool(device.device, &poolInfo, nullptr, &viz_descriptor_pool));
-
-    // Allocate 2 sets (One for each Heightmap ping-pong state)
-    viz_descriptor_sets.resize(2);
-    std::vector<VkDescriptorSetLayout> layouts(2, viz_descriptor_layout);
-    
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = viz_descriptor_pool;
@@ -1255,11 +2603,25 @@ void LivingWorlds::initialize_grid_pattern(Pattern pattern) {
 }
 
 void LivingWorlds::draw() {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point waitStart = Clock::now();
     VK_CHECK(vkWaitForFences(device.device, 1, &in_flight_fences[current_frame], true, 1000000000));
+    lastFrameWaitMs = std::chrono::duration<float, std::milli>(Clock::now() - waitStart).count();
+    read_sim_stats(current_frame); // Written by this frame slot's last submit
+    double gpuMs = gpuProfiler.collect(current_frame);
+    if (gpuMs >= 0.0) {
+        frameTimings.set_gpu(profiledFrame[current_frame], static_cast<float>(gpuMs));
+        frameTimings.add_stages(profiledFrame[current_frame], gpuProfiler.collected());
+    }
+    poll_exports();
+    poll_pick_refresh();
+    poll_checkpoint();
     
     uint32_t swapchain_image_index;
+    waitStart = Clock::now();
     VkResult result = vkAcquireNextImageKHR(device.device, swapchain.swapchain, 1000000000, 
                                             image_available_semaphores[current_frame], nullptr, &swapchain_image_index);
+    lastFrameWaitMs += std::chrono::duration<float, std::milli>(Clock::now() - waitStart).count();
     if (result == VK_ERROR_OUT_OF_DATE_KHR) return;
     else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) abort();
 
@@ -1273,30 +2635,8 @@ void LivingWorlds::draw() {
     cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
     VK_CHECK(vkBeginCommandBuffer(cmd, &cmdBeginInfo));
-
-    // 1. COMPUTE DISPATCH (Ping Pong)
-    uint32_t use_set_index = current_sim_output_index; 
-    
-    VkImageMemoryBarrier computeBarriers[2];
-    for(int i=0; i<2; i++) {
-        computeBarriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        computeBarriers[i].pNext = nullptr;
-        computeBarriers[i].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-        computeBarriers[i].newLayout = VK_IMAGE_LAYOUT_GENERAL;
-        computeBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        computeBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        computeBarriers[i].image = storage_images[i];
-        computeBarriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        computeBarriers[i].subresourceRange.baseMipLevel = 0;
-        computeBarriers[i].subresourceRange.levelCount = 1;
-        computeBarriers[i].subresourceRange.baseArrayLayer = 0;
-        computeBarriers[i].subresourceRange.layerCount = 1;
-        computeBarriers[i].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
-        computeBarriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-    }
-    
-    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
-                         0, 0, nullptr, 0, nullptr, 2, computeBarriers);
+    gpuProfiler.begin_frame(cmd, current_frame, graphics_queue_family);
+    profiledFrame[current_frame] = frameTimings.next_frame();
 
     // ---------------------------------------------------------
     // COMPUTE DISPATCH (Simulation Loop)
@@ -1315,243 +2655,150 @@ void LivingWorlds::draw() {
     // Handle Reset from UI
     if (needsReset) {
         needsReset = false;
+        wait_simulation_idle();
         currentSeed = static_cast<float>(glfwGetTime() * 1000.0);
         dispatch_noise_init();
         dispatch_biome_init();
         dispatch_biome_ca_init();
-        current_heightmap_index = 0;
+        current_heightmap_index = 1;
         simAccumulator = 0.0f;
+        simStep = 0;
+        lastExportStep = 0;
+        lastPickRefreshStep = 0;
+        pickRefreshDue = true;
+        heightPyramidFull = true;
+        displayDirty = true;
+        activeTilesForce = true;
+        biomePlanesNeedPack = true;
+        frame_graph.invalidate(); // One-shot dispatches rewrote everything
+        wake_simulation();
     }
     
-    // Handle pending mouse click spawning
-    if (pendingClick && spawnMode != SPAWN_NONE) {
-        pendingClick = false;
-        
-        // Convert UV to pixel coordinates
-        int px = static_cast<int>(clickU * simWidth);
-        int py = static_cast<int>(clickV * simHeight);
-        
-        // Determine biome to spawn
-        uint8_t biomeId = 2; // Default: GRASS
-        switch (spawnMode) {
-            case SPAWN_FOREST:   biomeId = 3; break;
-            case SPAWN_DESERT:   biomeId = 4; break;
-            case SPAWN_WATER:    biomeId = 0; break;
-            case SPAWN_MOUNTAIN: biomeId = 5; break; // ROCK
-            case SPAWN_GRASS:    biomeId = 2; break;
-            default: break;
-        }
-        
-        // Calculate region to modify
-        int radius = spawnRadius;
-        int x0 = std::max(0, px - radius);
-        int y0 = std::max(0, py - radius);
-        int x1 = std::min((int)simWidth - 1, px + radius);
-        int y1 = std::min((int)simHeight - 1, py + radius);
-        int regionWidth = x1 - x0 + 1;
-        int regionHeight = y1 - y0 + 1;
-        
-        if (regionWidth > 0 && regionHeight > 0) {
-            // Create staging buffer with biome data
-            VkDeviceSize bufferSize = regionWidth * regionHeight;
-            std::vector<uint8_t> spawnData(bufferSize, biomeId);
-            
-            VkBuffer stagingBuffer;
-            VmaAllocation stagingAlloc;
-            create_buffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                          VMA_MEMORY_USAGE_CPU_TO_GPU, stagingBuffer, stagingAlloc);
-            
-            // Copy data to staging buffer
-            void* data;
-            vmaMapMemory(allocator, stagingAlloc, &data);
-            memcpy(data, spawnData.data(), bufferSize);
-            vmaUnmapMemory(allocator, stagingAlloc);
-            
-            // Create one-shot command buffer for the copy
-            VkCommandBufferAllocateInfo allocInfo = {};
-            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-            allocInfo.commandPool = command_pool;
-            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            allocInfo.commandBufferCount = 1;
-            
-            VkCommandBuffer copyCmd;
-            vkAllocateCommandBuffers(device.device, &allocInfo, &copyCmd);
-            
-            VkCommandBufferBeginInfo beginInfo = {};
-            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-            vkBeginCommandBuffer(copyCmd, &beginInfo);
-            
-            // Buffer to image copy region
-            VkBufferImageCopy region = {};
-            region.bufferOffset = 0;
-            region.bufferRowLength = regionWidth;
-            region.bufferImageHeight = regionHeight;
-            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            region.imageSubresource.layerCount = 1;
-            region.imageOffset = {x0, y0, 0};
-            region.imageExtent = {(uint32_t)regionWidth, (uint32_t)regionHeight, 1};
-            
-            // Copy to both biome images
-            vkCmdCopyBufferToImage(copyCmd, stagingBuffer, biome_images[0],
-                                   VK_IMAGE_LAYOUT_GENERAL, 1, &region);
-            vkCmdCopyBufferToImage(copyCmd, stagingBuffer, biome_images[1],
-                                   VK_IMAGE_LAYOUT_GENERAL, 1, &region);
-            
-            vkEndCommandBuffer(copyCmd);
-            
-            // Submit and wait
-            VkSubmitInfo submitInfo = {};
-            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers = &copyCmd;
-            
-            vkQueueSubmit(graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
-            vkQueueWaitIdle(graphics_queue);
-            
-            // Now safe to cleanup
-            vkFreeCommandBuffers(device.device, command_pool, 1, &copyCmd);
-            vmaDestroyBuffer(allocator, stagingBuffer, stagingAlloc);
-            
-            std::cout << "Spawned " << (spawnMode == SPAWN_FOREST ? "Forest" : 
-                                        spawnMode == SPAWN_DESERT ? "Desert" :
-                                        spawnMode == SPAWN_WATER ? "Water" :
-                                        spawnMode == SPAWN_MOUNTAIN ? "Mountain" : "Grass")
-                      << " at (" << px << ", " << py << ") radius " << radius << std::endl;
-        }
-    }
-
     // ---------------------------------------------------------
     // COMPUTE DISPATCH (Simulation Loop)
     // ---------------------------------------------------------
-    // Use static local for proper ping-pong (avoids race with in-flight frames)
-    static int hmap_idx = 1;  // Start at 1 so first erosion outputs to 0 (where noise wrote)
-    int erosion_output_idx = hmap_idx;
-    
-    bool run_simulation = false;
-    if (!paused && simAccumulator >= simInterval) {
-        run_simulation = true;
-        simAccumulator -= simInterval;
-        if(simAccumulator > simInterval) simAccumulator = 0.0f;
+    // Batch every step the accumulator holds into this command buffer,
+    // capped by the per-frame budget so a slow frame can't snowball.
+    // In async mode a new batch only starts once the previous one finished;
+    // until then the backlog stays in the accumulator.
+    // A converged world (auto-idle) keeps ticking slowly so stochastic
+    // changes can still wake it.
+    bool simIdle = simulation_idle();
+    if (simIdle) {
+        read_sim_stats(MAX_FRAMES_IN_FLIGHT); // Async batch slot
+        double computeMs = gpuProfiler.collect(MAX_FRAMES_IN_FLIGHT);
+        if (computeMs >= 0.0) {
+            frameTimings.set_compute(profiledFrame[MAX_FRAMES_IN_FLIGHT], static_cast<float>(computeMs));
+            frameTimings.add_stages(profiledFrame[MAX_FRAMES_IN_FLIGHT], gpuProfiler.collected());
+        }
     }
-
-    if (run_simulation) {
-        erosion_output_idx = (hmap_idx + 1) % 2;
-        
-        // 1. EROSION
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, erosion_pipeline);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, erosion_pipeline_layout, 0, 1, &compute_descriptor_sets[hmap_idx], 0, nullptr);
-        vkCmdPushConstants(cmd, erosion_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ErosionPushConstants), &erosionParams);
-        vkCmdDispatch(cmd, simWidth/16, simHeight/16, 1);
-
-        // Update hmap_idx for NEXT step
-        hmap_idx = erosion_output_idx;
-        
-        // Barrier for Erosion Output -> Biome Input
-        VkImageMemoryBarrier erosionBarrier = {};
-        erosionBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        erosionBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-        erosionBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-        erosionBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        erosionBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        erosionBarrier.image = heightmap_images[erosion_output_idx];
-        erosionBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        erosionBarrier.subresourceRange.baseMipLevel = 0;
-        erosionBarrier.subresourceRange.levelCount = 1;
-        erosionBarrier.subresourceRange.baseArrayLayer = 0;
-        erosionBarrier.subresourceRange.layerCount = 1;
-        erosionBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-        erosionBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        
-        // Barrier for Erosion Output -> Biome CA
-        VkMemoryBarrier memBar = {};
-        memBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-        memBar.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-        memBar.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memBar, 0, nullptr, 0, nullptr);
-        
-        // 2. DISCRETE BIOME CA
-        static uint32_t simStep = 0;
-        simStep++;
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_pipeline);
-        biomePushConstants.time = static_cast<float>(simStep);
-        vkCmdPushConstants(cmd, biome_ca_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BiomePushConstants), &biomePushConstants);
-        // Biome CA reads from the UPDATED hmap_idx (same buffer erosion just wrote)
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_pipeline_layout, 0, 1, &compute_descriptor_sets[erosion_output_idx], 0, nullptr);
-        vkCmdDispatch(cmd, simWidth/16, simHeight/16, 1);
+    float interval = simIdling ? std::max(simInterval, IDLE_INTERVAL) : simInterval;
+    uint32_t steps = 0;
+    if (paused) {
+        simAccumulator = 0.0f;
+    } else if (simIdle && simAccumulator >= interval) {
+        uint32_t budget = static_cast<uint32_t>(std::max(config.maxStepsPerFrame, 1));
+        steps = static_cast<uint32_t>(simAccumulator / interval);
+        simAccumulator -= steps * interval; // Only the partial step carries over
+        steps = std::min(steps, budget);    // Whole steps past the budget are dropped
     }
 
-    // ---------------------------------------------------------
-    // GRAPHICS BARRIERS (Transition for Reading)
-    // ---------------------------------------------------------
-    // Barrier for Heightmap -> Graphics Input (Vertex reads height)
-    // FIXED: Barrier the buffer that erosion just wrote (erosion_output_idx)
-    VkImageMemoryBarrier heightmapBarrier = {};
-    heightmapBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    heightmapBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-    heightmapBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-    heightmapBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    heightmapBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    heightmapBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-    heightmapBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    heightmapBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    heightmapBarrier.subresourceRange.baseMipLevel = 0;
-    heightmapBarrier.subresourceRange.levelCount = 1;
-    heightmapBarrier.subresourceRange.baseArrayLayer = 0;
-    heightmapBarrier.subresourceRange.layerCount = 1;
-    heightmapBarrier.image = heightmap_images[erosion_output_idx];  // FIXED: use dynamic index
-    
-    vkCmdPipelineBarrier(cmd, 
-                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
-                         VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-                         0, 0, nullptr, 0, nullptr, 1, &heightmapBarrier);
+    lastFrameSteps = static_cast<int>(steps);
+    stepsThisSecond += static_cast<int>(steps);
+
+    size_t texture_set_index = current_heightmap_index;
+    int renderSlot = -1;
+    
+    if (asyncCompute) {
+        // Render the newest finished generation; the new batch (if any)
+        // runs on the compute queue alongside this frame
+        renderSlot = display_latest;
+        if (!simIdle) {
+            if (display_ready_value[1 - display_latest] != 0) renderSlot = 1 - display_latest;
+        } else if (steps > 0 || displayDirty) {
+            int slot = 1 - display_latest;
+            submit_async_simulation(steps, slot);
+            display_latest = slot;
+            displayDirty = !brushQueue.empty(); // Events past one arena region
+            if (display_ready_value[renderSlot] == 0) renderSlot = slot; // Nothing published yet
+        }
+        texture_set_index = static_cast<size_t>(renderSlot);
+        if (display_ready_value[renderSlot] != heightPyramidSource) {
+            heightPyramidSource = display_ready_value[renderSlot];
+            heightPyramidFull = true;
+        }
+    } else {
+        record_brush(cmd, static_cast<int>(current_frame));
+        record_simulation_steps(cmd, steps);
+        if (steps > 0) heightPyramidFull = true;
+        record_sim_stats(cmd, current_frame, steps);
+        record_export(cmd, static_cast<int>(current_frame));
+        record_pick_refresh(cmd, static_cast<int>(current_frame));
+        record_checkpoint(cmd, static_cast<int>(current_frame));
+    }
 
     // 3. 2.5D VISUALIZATION (Graphics Pipeline)
     update_uniform_buffer(current_frame);
+    select_terrain_patches(current_frame);
+    record_height_pyramid(cmd, texture_set_index);
+    record_terrain_cull(cmd, current_frame, texture_set_index);
+    
+    // Vertex shader reads the heightmap, fragment shader reads heightmap + biome.
+    // Terrain and ImGui share the render pass, so they are one graph pass.
+    // Async mode samples the display copies, ordered by the timelines instead.
+    auto recordTerrain = [&](VkCommandBuffer cmd) {
+        // Begin Render Pass
+        VkRenderPassBeginInfo renderPassInfo = {};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = render_pass;
+        renderPassInfo.framebuffer = framebuffers[swapchain_image_index];
+        renderPassInfo.renderArea.offset = {0, 0};
+        renderPassInfo.renderArea.extent = swapchain.extent;
+
+        std::array<VkClearValue, 2> clearValues{};
+        clearValues[0].color = {{0.35f, 0.50f, 0.70f, 1.0f}}; // Darker sky blue
+        clearValues[1].depthStencil = {1.0f, 0};
+
+        renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+        renderPassInfo.pClearValues = clearValues.data();
+
+        vkCmdBeginRenderPass(cmd, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, terrain_pipeline);
+
+        vkCmdBindIndexBuffer(cmd, patchIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+
+        // Bind Descriptors
+        // Set 0: UBO + terrain patches (per frame)
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, terrain_pipeline_layout, 
+                                0, 1, &ubo_descriptor_sets[current_frame], 0, nullptr);
+
+        // Set 1: Textures - read from the buffer the last erosion step wrote
+        // (or its display copy in async mode)
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, terrain_pipeline_layout, 
+                                1, 1, &texture_descriptor_sets[texture_set_index], 0, nullptr);
+
+        // One instance of the patch mesh per visible LOD node (count from the cull pass)
+        vkCmdDrawIndexedIndirect(cmd, terrainDrawArgsBuffers[current_frame], 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+
+        // ImGui Rendering
+        render_ui();
+        gpuProfiler.begin(cmd, "imgui");
+        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
+        gpuProfiler.end(cmd);
+
+        vkCmdEndRenderPass(cmd);
+    };
     
-    // Begin Render Pass
-    VkRenderPassBeginInfo renderPassInfo = {};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = render_pass;
-    renderPassInfo.framebuffer = framebuffers[swapchain_image_index];
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = swapchain.extent;
-
-    std::array<VkClearValue, 2> clearValues{};
-    clearValues[0].color = {{0.35f, 0.50f, 0.70f, 1.0f}}; // Darker sky blue
-    clearValues[1].depthStencil = {1.0f, 0};
-
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
-
-    vkCmdBeginRenderPass(cmd, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, terrain_pipeline);
-
-    VkBuffer vertexBuffers[] = {vertexBuffer};
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(cmd, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-    // Bind Descriptors
-    // Set 0: UBO (per frame)
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, terrain_pipeline_layout, 
-                            0, 1, &ubo_descriptor_sets[current_frame], 0, nullptr);
-    
-    // Set 1: Textures - FIXED: use erosion_output_idx to read from eroded buffer
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, terrain_pipeline_layout, 
-                            1, 1, &texture_descriptor_sets[erosion_output_idx], 0, nullptr);
-
-    vkCmdDrawIndexed(cmd, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
-
-    // ImGui Rendering
-    render_ui();
-    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
-
-    vkCmdEndRenderPass(cmd);
-
-    // Update state for next frame
-    current_heightmap_index = erosion_output_idx;
+    const VkPipelineStageFlags terrainStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    if (asyncCompute) {
+        frame_graph.add_pass("terrain", terrainStages, {}, {}, recordTerrain);
+    } else {
+        frame_graph.add_pass("terrain", terrainStages, {fg_height[texture_set_index], fg_biome[texture_set_index]}, {}, recordTerrain);
+    }
+    frame_graph.execute(cmd);
+    lastFrameBarriers = frame_graph.barriers_emitted();
+    frame_graph.reset_counters();
 
     VK_CHECK(vkEndCommandBuffer(cmd));
 
@@ -1565,6 +2812,34 @@ void LivingWorlds::draw() {
     submit.pSignalSemaphores = &render_finished_semaphores[swapchain_image_index]; // Per Image
     submit.commandBufferCount = 1;
     submit.pCommandBuffers = &cmd;
+    
+    // Async: also wait for the sim batch that published renderSlot, and
+    // signal render_timeline so compute knows when the slot is free again
+    VkSemaphore waitSemaphores[2] = {image_available_semaphores[current_frame], sim_timeline};
+    VkPipelineStageFlags waitStages[2] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT};
+    VkSemaphore signalSemaphores[2] = {render_finished_semaphores[swapchain_image_index], render_timeline};
+    uint64_t waitValues[2] = {0, 0};
+    uint64_t signalValues[2] = {0, 0};
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    if (asyncCompute) {
+        waitValues[1] = display_ready_value[renderSlot];
+        signalValues[1] = ++render_timeline_value;
+        display_last_read[renderSlot] = render_timeline_value;
+        
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.waitSemaphoreValueCount = 2;
+        timelineInfo.pWaitSemaphoreValues = waitValues;
+        timelineInfo.signalSemaphoreValueCount = 2;
+        timelineInfo.pSignalSemaphoreValues = signalValues;
+        
+        submit.pNext = &timelineInfo;
+        submit.waitSemaphoreCount = 2;
+        submit.pWaitSemaphores = waitSemaphores;
+        submit.pWaitDstStageMask = waitStages;
+        submit.signalSemaphoreCount = 2;
+        submit.pSignalSemaphores = signalSemaphores;
+    }
 
     VK_CHECK(vkQueueSubmit(graphics_queue, 1, &submit, in_flight_fences[current_frame]));
 
@@ -1581,18 +2856,752 @@ void LivingWorlds::draw() {
     current_sim_output_index = (current_sim_output_index + 1) % 2;
     current_frame = (current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
     
-    // FPS Counter
-    double current_time = glfwGetTime();
-    frames_this_second++;
-    if (current_time - last_timestamp >= 1.0) {
-        fps = static_cast<float>(frames_this_second);
-        frames_this_second = 0;
-        last_timestamp = current_time;
+    // FPS Counter
+    double current_time = glfwGetTime();
+    frames_this_second++;
+    if (current_time - last_timestamp >= 1.0) {
+        fps = static_cast<float>(frames_this_second);
+        stepsPerSecond = static_cast<float>(stepsThisSecond);
+        gpuProfiler.roll(static_cast<uint32_t>(frames_this_second));
+        frames_this_second = 0;
+        stepsThisSecond = 0;
+        last_timestamp = current_time;
+    }
+}
+
+// Stages are registered up front so they keep the CSV column order; the
+// frame graph times each pass it records. A slot needs room for erosion +
+// biome CA on every step of the largest batch (the UI slider can raise
+// --max-steps to MAX_STEPS_PER_FRAME_LIMIT), plus one scope per other stage.
+void LivingWorlds::init_gpu_profiler() {
+    for (const char* stage : GPU_PROFILE_STAGES) gpuProfiler.add_stage(stage);
+    uint32_t maxSteps = static_cast<uint32_t>(std::max(config.maxStepsPerFrame, MAX_STEPS_PER_FRAME_LIMIT));
+    uint32_t scopes = maxSteps * SIM_SCOPES_PER_STEP + static_cast<uint32_t>(std::size(GPU_PROFILE_STAGES));
+    gpuProfiler.init(device.device, physical_device.physical_device, MAX_FRAMES_IN_FLIGHT + 1, scopes);
+    frame_graph.set_profiler(&gpuProfiler);
+}
+
+// Registers the ping-pong images with the frame graph. A disabled stage's
+// aliased pair maps to one resource. Called after the one-shot init
+// dispatches, so the first graph pass synchronizes against them.
+void LivingWorlds::init_frame_graph() {
+    fg_height[0] = frame_graph.add_resource("height0");
+    fg_height[1] = config.enableErosion ? frame_graph.add_resource("height1") : fg_height[0];
+    fg_biome[0] = frame_graph.add_resource("biome0");
+    fg_biome[1] = config.enableBiomeCA ? frame_graph.add_resource("biome1") : fg_biome[0];
+    fg_stats = frame_graph.add_resource("simStats");
+    fg_height_pyramid = frame_graph.add_resource("heightPyramid");
+    fg_state_hash = frame_graph.add_resource("stateHash");
+    frame_graph.invalidate();
+}
+
+// Records `steps` ping-pong erosion -> biome CA steps into cmd. Each pass
+// declares what it touches and the frame graph places the barriers; for the
+// two-pass kernels that works out to one per step: erosion of step N+1 reads
+// H[out] and Bio[out], which step N's biome CA only read, and writes H[in],
+// which the erosion -> biome CA barrier of step N already ordered. That same
+// barrier of step N+1 covers biome CA N -> biome CA N+1.
+void LivingWorlds::record_simulation_steps(VkCommandBuffer cmd, uint32_t steps) {
+    const VkPipelineStageFlags compute = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    
+    if (config.activeTiles || config.bitslicedBiome) {
+        // These batches keep their own per-step barriers around the tile
+        // list / bitplane buffers; to the graph a batch is one pass
+        frame_graph.add_pass("sim batch", compute,
+                             {fg_height[0], fg_height[1], fg_biome[0], fg_biome[1]},
+                             {fg_height[0], fg_height[1], fg_biome[0], fg_biome[1]},
+                             [this, steps](VkCommandBuffer c) {
+            if (config.activeTiles) record_active_tile_steps(c, steps);
+            else record_bitsliced_steps(c, steps);
+        });
+        frame_graph.execute(cmd);
+        return;
+    }
+
+    if (temporal_pipeline && config.temporalK > 0) {
+        // Up to K generations per dispatch; ping-pong flips once per dispatch
+        // since each dispatch reads H[in]/Bio[out] and writes H[out]/Bio[in]
+        TemporalPushConstants temporalParams;
+        temporalParams.fused.erosion = erosionParams;
+        uint32_t remaining = steps;
+        while (remaining > 0) {
+            uint32_t generations = std::min(remaining, static_cast<uint32_t>(temporalK));
+            size_t in_idx = current_heightmap_index;
+            size_t out_idx = (in_idx + 1) % 2;
+            biomePushConstants.time = static_cast<float>(simStep + 1);
+            temporalParams.fused.biome = biomePushConstants;
+            temporalParams.generations = static_cast<int>(generations);
+            frame_graph.add_pass("temporal", compute, {fg_height[in_idx], fg_biome[out_idx]}, {fg_height[out_idx], fg_biome[in_idx]},
+                                 [this, in_idx, temporalParams](VkCommandBuffer c) {
+                vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, temporal_pipeline);
+                vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, temporal_pipeline_layout, 0, 1, &compute_descriptor_sets[in_idx], 0, nullptr);
+                vkCmdPushConstants(c, temporal_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(TemporalPushConstants), &temporalParams);
+                vkCmdDispatch(c, simWidth/16, simHeight/16, 1);
+            });
+            simStep += generations;
+            remaining -= generations;
+            current_heightmap_index = out_idx;
+        }
+        frame_graph.execute(cmd);
+        return;
+    }
+
+    if (config.fusedSim) {
+        // One dispatch per step, same resource pattern as a temporal dispatch
+        FusedPushConstants fusedParams;
+        fusedParams.erosion = erosionParams;
+        for (uint32_t i = 0; i < steps; i++) {
+            size_t in_idx = current_heightmap_index;
+            size_t out_idx = (in_idx + 1) % 2;
+            simStep++;
+            biomePushConstants.time = static_cast<float>(simStep);
+            fusedParams.biome = biomePushConstants;
+            frame_graph.add_pass("fused", compute, {fg_height[in_idx], fg_biome[out_idx]}, {fg_height[out_idx], fg_biome[in_idx]},
+                                 [this, in_idx, fusedParams](VkCommandBuffer c) {
+                vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, fused_pipeline);
+                vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, fused_pipeline_layout, 0, 1, &compute_descriptor_sets[in_idx], 0, nullptr);
+                vkCmdPushConstants(c, fused_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(FusedPushConstants), &fusedParams);
+                vkCmdDispatch(c, simWidth/16, simHeight/16, 1);
+            });
+            current_heightmap_index = out_idx;
+        }
+        frame_graph.execute(cmd);
+        return;
+    }
+
+    for (uint32_t i = 0; i < steps; i++) {
+        size_t in_idx = current_heightmap_index;
+        size_t out_idx = (in_idx + 1) % 2;
+
+        // 1. EROSION (reads H[in] + Bio[in], writes H[out])
+        if (config.enableErosion) {
+            ErosionPushConstants params = erosionParams;
+            frame_graph.add_pass("erosion", compute, {fg_height[in_idx], fg_biome[in_idx]}, {fg_height[out_idx]},
+                                 [this, in_idx, params](VkCommandBuffer c) {
+                vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, erosion_pipeline);
+                vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, erosion_pipeline_layout, 0, 1, &compute_descriptor_sets[in_idx], 0, nullptr);
+                vkCmdPushConstants(c, erosion_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ErosionPushConstants), &params);
+                vkCmdDispatch(c, simWidth/16, simHeight/16, 1);
+            });
+        }
+
+        // 2. DISCRETE BIOME CA (reads the height erosion just wrote + Bio[out], writes Bio[in])
+        simStep++;
+        if (config.enableBiomeCA) {
+            biomePushConstants.time = static_cast<float>(simStep);
+            BiomePushConstants params = biomePushConstants;
+            frame_graph.add_pass("biome CA", compute, {fg_height[out_idx], fg_biome[out_idx]}, {fg_biome[in_idx]},
+                                 [this, out_idx, params](VkCommandBuffer c) {
+                vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_pipeline);
+                vkCmdPushConstants(c, biome_ca_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BiomePushConstants), &params);
+                vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, biome_ca_pipeline_layout, 0, 1, &compute_descriptor_sets[out_idx], 0, nullptr);
+                vkCmdDispatch(c, simWidth/16, simHeight/16, 1);
+            });
+        }
+
+        current_heightmap_index = out_idx;
+    }
+    frame_graph.execute(cmd);
+}
+
+bool LivingWorlds::simulation_idle() {
+    if (!asyncCompute) return true;
+    uint64_t completed = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(device.device, sim_timeline, &completed));
+    return completed >= sim_timeline_value;
+}
+
+// Blocks until the compute queue is done with the ping-pong images, so
+// one-shot graphics work (reset, spawn) can safely write them
+void LivingWorlds::wait_simulation_idle() {
+    if (!asyncCompute) return;
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &sim_timeline;
+    waitInfo.pValues = &sim_timeline_value;
+    VK_CHECK(vkWaitSemaphores(device.device, &waitInfo, UINT64_MAX));
+}
+
+// Runs `steps` sim steps on the compute queue, then copies the resulting
+// height/biome pair into display slot `slot` for the renderer.
+void LivingWorlds::submit_async_simulation(uint32_t steps, int slot) {
+    VkCommandBuffer cmd = compute_command_buffer;
+    VK_CHECK(vkResetCommandBuffer(cmd, 0));
+    
+    VkCommandBufferBeginInfo cmdBeginInfo = {};
+    cmdBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(cmd, &cmdBeginInfo));
+    gpuProfiler.begin_frame(cmd, MAX_FRAMES_IN_FLIGHT, compute_queue_family);
+    profiledFrame[MAX_FRAMES_IN_FLIGHT] = frameTimings.next_frame();
+    
+    // Barriers against the previous batch (steps + copy) come from the graph
+    record_brush(cmd, MAX_FRAMES_IN_FLIGHT);
+    record_simulation_steps(cmd, steps);
+    record_sim_stats(cmd, MAX_FRAMES_IN_FLIGHT, steps);
+    
+    // Same height/biome pair texture_descriptor_sets[current_heightmap_index]
+    // samples. The display slot itself is guarded by the timelines below.
+    size_t cur = current_heightmap_index;
+    frame_graph.add_pass("display copy", VK_PIPELINE_STAGE_TRANSFER_BIT, {fg_height[cur], fg_biome[cur]}, {},
+                         [this, cur, slot](VkCommandBuffer c) {
+        VkImageCopy region = {};
+        region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.srcSubresource.layerCount = 1;
+        region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.dstSubresource.layerCount = 1;
+        region.extent = {simWidth, simHeight, 1};
+        vkCmdCopyImage(c, heightmap_images[cur], VK_IMAGE_LAYOUT_GENERAL,
+                       display_height_images[slot], VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+        vkCmdCopyImage(c, biome_images[cur], VK_IMAGE_LAYOUT_GENERAL,
+                       display_biome_images[slot], VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+    });
+    frame_graph.execute(cmd);
+    record_export(cmd, -1);
+    record_pick_refresh(cmd, -1);
+    record_checkpoint(cmd, -1);
+    
+    VK_CHECK(vkEndCommandBuffer(cmd));
+    
+    // Wait until the last frame that sampled this slot is done with it
+    uint64_t waitValue = display_last_read[slot];
+    uint64_t signalValue = ++sim_timeline_value;
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = 1;
+    timelineInfo.pWaitSemaphoreValues = &waitValue;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &signalValue;
+    
+    VkSubmitInfo submit = {};
+    submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit.pNext = &timelineInfo;
+    submit.waitSemaphoreCount = 1;
+    submit.pWaitSemaphores = &render_timeline;
+    submit.pWaitDstStageMask = &waitStage;
+    submit.commandBufferCount = 1;
+    submit.pCommandBuffers = &cmd;
+    submit.signalSemaphoreCount = 1;
+    submit.pSignalSemaphores = &sim_timeline;
+    
+    VK_CHECK(vkQueueSubmit(compute_queue, 1, &submit, VK_NULL_HANDLE));
+    display_ready_value[slot] = signalValue;
+}
+
+// Times every sim kernel in isolation at the current grid size, for
+// LivingWorldsBench. Each stage runs on its own, ping-ponging between the
+// two compute descriptor sets with a barrier per step like the sim does;
+// the bytes it reports count every image texel read and written once
+// (stencil neighbours are assumed to hit in cache).
+KernelBenchReport LivingWorlds::benchmark_kernels(uint32_t warmup, uint32_t iterations) {
+    config.headless = true;
+    config.climate = true; // biome_growth steps the temperature/humidity layers
+    config.enableErosion = true;
+    config.enableBiomeCA = true;
+    config.fusedSim = false;
+    config.temporalK = 0;
+    config.activeTiles = false;
+    config.bitslicedBiome = false;
+    init_headless();
+    gpuProfiler.init(device.device, physical_device.physical_device, 1, 1); // One scope per kernel
+    
+    KernelBenchReport report;
+    report.device = physical_device.name;
+    report.heightFormat = heightLevels == 65535.0f ? "r16" : heightLevels == 0.0f ? "r32f" : "rgba8";
+    
+    const uint64_t cells = static_cast<uint64_t>(simWidth) * simHeight;
+    const uint64_t heightBytes = heightLevels == 65535.0f ? 2 : 4;
+    const uint64_t biomeBytes = 1;   // R8_UINT
+    const uint64_t climateBytes = 4; // R32_SFLOAT temperature, humidity
+    PushConsts noisePush = {currentSeed};
+    
+    struct Kernel {
+        const char* name;
+        VkPipeline pipeline;
+        VkPipelineLayout layout;
+        const void* push;
+        uint32_t pushSize;
+        uint64_t bytesPerCell;
+    };
+    const Kernel kernels[] = {
+        {"noise_init", noise_pipeline, noise_pipeline_layout, &noisePush, sizeof(PushConsts),
+         heightBytes},                                  // H out
+        {"erosion", erosion_pipeline, erosion_pipeline_layout, &erosionParams, sizeof(ErosionPushConstants),
+         2 * heightBytes + biomeBytes},                 // H + biome in, H out
+        {"biome_ca", biome_ca_pipeline, biome_ca_pipeline_layout, &biomePushConstants, sizeof(BiomePushConstants),
+         heightBytes + 2 * biomeBytes},                 // H + biome in, biome out
+        {"biome_growth", biome_growth_pipeline, biome_growth_pipeline_layout, nullptr, 0,
+         heightBytes + 4 * climateBytes},               // H + temp/hum in, temp/hum out
+    };
+    
+    // Records `count` dispatches into a one-shot command buffer and waits;
+    // returns the elapsed ms and whether GPU timestamps measured it
+    auto runKernel = [&](const Kernel& k, uint32_t count, bool& gpuTimed) {
+        VkCommandBuffer cmd;
+        VkCommandBufferAllocateInfo cmdAllocInfo = {};
+        cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cmdAllocInfo.commandPool = command_pool;
+        cmdAllocInfo.commandBufferCount = 1;
+        cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        VK_CHECK(vkAllocateCommandBuffers(device.device, &cmdAllocInfo, &cmd));
+        
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
+        gpuProfiler.begin_frame(cmd, 0, graphics_queue_family);
+        gpuProfiler.begin(cmd, k.name);
+        
+        VkMemoryBarrier memBarrier = {};
+        memBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        memBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, k.pipeline);
+        if (k.pushSize) vkCmdPushConstants(cmd, k.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, k.pushSize, k.push);
+        for (uint32_t i = 0; i < count; i++) {
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, k.layout, 0, 1, &compute_descriptor_sets[i % 2], 0, nullptr);
+            vkCmdDispatch(cmd, simWidth/16, simHeight/16, 1);
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0, 1, &memBarrier, 0, nullptr, 0, nullptr);
+        }
+        gpuProfiler.end(cmd);
+        VK_CHECK(vkEndCommandBuffer(cmd));
+        
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &cmd;
+        auto start = std::chrono::steady_clock::now();
+        VK_CHECK(vkQueueSubmit(graphics_queue, 1, &submitInfo, VK_NULL_HANDLE));
+        VK_CHECK(vkQueueWaitIdle(graphics_queue));
+        double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        vkFreeCommandBuffers(device.device, command_pool, 1, &cmd);
+        
+        double gpuMs = gpuProfiler.collect(0);
+        gpuTimed = gpuMs >= 0.0;
+        return gpuTimed ? gpuMs : wallMs;
+    };
+    
+    for (const Kernel& k : kernels) {
+        bool gpuTimed = false;
+        if (warmup > 0) runKernel(k, warmup, gpuTimed);
+        double ms = runKernel(k, iterations, gpuTimed);
+        report.kernels.push_back({k.name, ms / iterations, k.bytesPerCell * cells, gpuTimed});
+    }
+    
+    cleanup_headless();
+    return report;
+}
+
+// Steps the simulation config.headlessSteps times in batches of
+// maxStepsPerFrame, keeping up to MAX_FRAMES_IN_FLIGHT batches queued.
+void LivingWorlds::run_headless() {
+    uint32_t batch = static_cast<uint32_t>(std::max(config.maxStepsPerFrame, 1));
+    uint64_t total = static_cast<uint64_t>(std::max(config.headlessSteps, 0));
+    uint64_t submitted = 0;
+    
+    std::cout << "=== HEADLESS MODE ===\n"
+              << "Grid: " << simWidth << "x" << simHeight << "\n"
+              << "Steps: " << total << " (batch " << batch << ")\n";
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    while (submitted < total) {
+        VK_CHECK(vkWaitForFences(device.device, 1, &in_flight_fences[current_frame], true, UINT64_MAX));
+        poll_exports();
+        poll_checkpoint();
+        VK_CHECK(vkResetFences(device.device, 1, &in_flight_fences[current_frame]));
+        
+        VkCommandBuffer cmd = command_buffers[current_frame];
+        VK_CHECK(vkResetCommandBuffer(cmd, 0));
+        
+        VkCommandBufferBeginInfo cmdBeginInfo = {};
+        cmdBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CHECK(vkBeginCommandBuffer(cmd, &cmdBeginInfo));
+        
+        uint32_t steps = static_cast<uint32_t>(std::min<uint64_t>(batch, total - submitted));
+        record_simulation_steps(cmd, steps);
+        record_export(cmd, static_cast<int>(current_frame));
+        record_checkpoint(cmd, static_cast<int>(current_frame));
+        submitted += steps;
+        
+        VK_CHECK(vkEndCommandBuffer(cmd));
+        
+        VkSubmitInfo submit = {};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.commandBufferCount = 1;
+        submit.pCommandBuffers = &cmd;
+        VK_CHECK(vkQueueSubmit(graphics_queue, 1, &submit, in_flight_fences[current_frame]));
+        
+        current_frame = (current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+    }
+    
+    VK_CHECK(vkQueueWaitIdle(graphics_queue));
+    auto end = std::chrono::steady_clock::now();
+    
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double stepsPerSec = seconds > 0.0 ? total / seconds : 0.0;
+    double cellsPerSec = stepsPerSec * simWidth * simHeight;
+    
+    std::cout << "Elapsed: " << seconds << "s\n"
+              << "Steps/s: " << stepsPerSec << "\n"
+              << "Cells/s: " << cellsPerSec << "\n";
+    
+    if (config.benchmarkMode) {
+        std::string filename = "benchmark_headless_" + std::to_string(config.gridSize) + ".csv";
+        std::ofstream csv(filename);
+        csv << "grid_size,steps,seconds,steps_per_second,cells_per_second\n"
+            << config.gridSize << "," << total << "," << seconds << ","
+            << stepsPerSec << "," << cellsPerSec << "\n";
+        std::cout << "Logged to: " << filename << std::endl;
+    }
+}
+
+// Same loop and report as run_headless(), on CpuSim. Only the two-pass
+// erosion + biome CA path exists there; GPU-side options are ignored.
+bool LivingWorlds::run_cpu() {
+    simWidth = static_cast<uint32_t>(config.gridSize);
+    simHeight = static_cast<uint32_t>(config.gridSize);
+    currentSeed = config.seed;
+    erosionParams.bidrEnabled = config.bidirErosion ? 1.0f : 0.0f;
+    if (config.fusedSim || config.temporalK > 0 || config.activeTiles || config.bitslicedBiome || config.climate) {
+        std::cout << "CPU backend runs the two-pass erosion + biome CA; fused/temporal/active-tile/bit-sliced/climate options ignored\n";
+    }
+    if (!config.saveStatePath.empty() || !config.loadStatePath.empty() || config.exportEvery > 0 || config.verifySteps > 0) {
+        std::cout << "Snapshots, exports and --verify need the GPU backend, ignored\n";
+    }
+    switch (config.heightFormat) {
+        case VK_FORMAT_R16_UNORM:  heightLevels = 65535.0f; break;
+        case VK_FORMAT_R32_SFLOAT: heightLevels = 0.0f; break;
+        default:                   heightLevels = 255.0f; break;
+    }
+    if (config.checkIsa) return check_cpu_isas();
+    
+    uint64_t total = static_cast<uint64_t>(std::max(config.headlessSteps, 0));
+    CpuSim sim(simWidth, simHeight, heightLevels, config.enableErosion, config.enableBiomeCA,
+               static_cast<uint32_t>(std::max(config.cpuThreads, 0)));
+    
+    std::cout << "=== HEADLESS MODE (CPU) ===\n"
+              << "Grid: " << simWidth << "x" << simHeight << "\n"
+              << "Steps: " << total << "\n"
+              << "Threads: " << sim.threads() << ", erosion kernel: " << sim.isa() << "\n";
+    
+    sim.init_terrain(currentSeed);
+    sim.init_biomes(biomePushConstants);
+    
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < total; i++) {
+        sim.step(erosionParams, biomePushConstants);
+    }
+    auto end = std::chrono::steady_clock::now();
+    simStep = sim.steps();
+    
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double stepsPerSec = seconds > 0.0 ? total / seconds : 0.0;
+    double cellsPerSec = stepsPerSec * simWidth * simHeight;
+    
+    std::cout << "Elapsed: " << seconds << "s\n"
+              << "Steps/s: " << stepsPerSec << "\n"
+              << "Cells/s: " << cellsPerSec << "\n";
+    
+    if (config.benchmarkMode) {
+        std::string filename = "benchmark_headless_cpu_" + std::to_string(config.gridSize) + ".csv";
+        std::ofstream csv(filename);
+        csv << "grid_size,steps,seconds,steps_per_second,cells_per_second,threads\n"
+            << config.gridSize << "," << total << "," << seconds << ","
+            << stepsPerSec << "," << cellsPerSec << "," << sim.threads() << "\n";
+        std::cout << "Logged to: " << filename << std::endl;
+    }
+    return true;
+}
+
+// --check-isa: the run above on every CpuSim path this CPU has, hashing the
+// float bits after each step. The GPU is checked against the default path
+// with exact biomes, so the others must match it bit for bit.
+bool LivingWorlds::check_cpu_isas() {
+    uint32_t total = static_cast<uint32_t>(std::max(config.headlessSteps, 0));
+    uint32_t cells = simWidth * simHeight;
+    
+    std::cout << "=== CPU ISA CHECK ===\n"
+              << "Grid: " << simWidth << "x" << simHeight << "\n"
+              << "Steps: " << total << "\n";
+    
+    std::vector<StateHash> expected;
+    const char* expectedIsa = nullptr;
+    for (const char* isa : CpuSim::ISAS) {
+        CpuSim sim(simWidth, simHeight, heightLevels, config.enableErosion, config.enableBiomeCA,
+                   static_cast<uint32_t>(std::max(config.cpuThreads, 0)));
+        if (!sim.set_isa(isa)) {
+            std::cout << isa << ": not available, skipped\n";
+            continue;
+        }
+        BiomePushConstants params = biomePushConstants;
+        sim.init_terrain(currentSeed);
+        sim.init_biomes(params);
+        
+        std::vector<StateHash> hashes;
+        hashes.reserve(total + 1);
+        hashes.push_back(hash_state(sim.heightmap(), sim.biomemap(), cells, 0.0f));
+        for (uint32_t i = 0; i < total; i++) {
+            sim.step(erosionParams, params);
+            hashes.push_back(hash_state(sim.heightmap(), sim.biomemap(), cells, 0.0f));
+        }
+        
+        if (!expectedIsa) {
+            expected = std::move(hashes);
+            expectedIsa = isa;
+            std::cout << isa << ": reference\n";
+            continue;
+        }
+        for (uint32_t step = 0; step <= total; step++) {
+            if (hashes[step] != expected[step]) {
+                std::cerr << isa << ": differs from " << expectedIsa << " at step " << step << "\n";
+                return false;
+            }
+        }
+        std::cout << isa << ": matches " << expectedIsa << "\n";
+    }
+    return true;
+}
+
+// --verify N: steps the GPU sim and hashes its state after every step
+// (every dispatch with --temporal), checking the hashes against a golden
+// file and/or a CpuSim stepped in lockstep from each GPU state. The params
+// name the step order rather than the kernel path: fused and temporal
+// erosion read the newest biome, the two-pass kernels (and active tiles,
+// bitplanes) the one before it. A rewrite can be checked against a golden
+// recorded with any kernels of the same order.
+bool LivingWorlds::run_verify() {
+    static const char* const ENCODING_NAMES[] = {"r16", "r32f", "rgba8"};
+    uint32_t cells = simWidth * simHeight;
+    uint32_t total = static_cast<uint32_t>(config.verifySteps);
+    bool temporal = temporal_pipeline && config.temporalK > 0;
+    bool fusedOrder = temporal || config.fusedSim;
+    uint32_t batch = temporal ? static_cast<uint32_t>(temporalK) : 1;
+    
+    char params[256];
+    snprintf(params, sizeof(params), "grid=%ux%u seed=%g height=%s erosion=%d biome_ca=%d bidir=%d order=%s",
+             simWidth, simHeight, currentSeed, ENCODING_NAMES[static_cast<int>(height_encoding())],
+             config.enableErosion ? 1 : 0, config.enableBiomeCA ? 1 : 0, config.bidirErosion ? 1 : 0,
+             fusedOrder ? "fused" : "two-pass");
+    GoldenHashes recorded{params, physical_device.name, {}};
+    if (!config.loadStatePath.empty()) recorded.params += " load=" + config.loadStatePath;
+    
+    GoldenHashes golden;
+    bool useGolden = !config.goldenPath.empty();
+    if (useGolden) {
+        if (!read_golden(config.goldenPath, golden)) {
+            std::cerr << "Failed to read golden file " << config.goldenPath << "\n";
+            return false;
+        }
+        if (golden.params != recorded.params) {
+            std::cerr << "Golden file params differ:\n  golden: " << golden.params
+                      << "\n  run:    " << recorded.params << "\n";
+            return false;
+        }
+        if (golden.device != recorded.device) {
+            std::cout << "Warning: golden file recorded on " << golden.device
+                      << "; exact state is only expected on the same device and driver\n";
+        }
+    }
+    
+    std::unique_ptr<CpuSim> reference;
+    if (config.verifyReference) {
+        reference = std::make_unique<CpuSim>(simWidth, simHeight, heightLevels, config.enableErosion, config.enableBiomeCA,
+                                             static_cast<uint32_t>(std::max(config.cpuThreads, 0)));
+        reference->set_fused(fusedOrder);
+    }
+    
+    std::cout << "=== VERIFY MODE ===\n"
+              << "Params: " << recorded.params << "\n"
+              << "Steps: " << total << " (hashed every " << batch << ")\n"
+              << "Golden: " << (useGolden ? config.goldenPath : std::string("none")) << "\n"
+              << "Reference: " << (reference ? "CPU, " + std::to_string(reference->threads()) + " threads" : std::string("off")) << "\n";
+    
+    VkDeviceSize heightBytes = static_cast<VkDeviceSize>(cells) * height_bytes_per_texel(height_encoding());
+    std::vector<float> gpuHeight(reference ? cells : 0);
+    
+    // Readback slot i as floats, the way the shaders see the stored format
+    auto readback_height = [&](uint32_t slot, float* out) {
+        const uint8_t* src = verify_readback_mapped + heightBytes * slot;
+        switch (height_encoding()) {
+            case HeightEncoding::R16:
+                for (uint32_t c = 0; c < cells; c++) {
+                    uint16_t v;
+                    memcpy(&v, src + c * 2, sizeof(v));
+                    out[c] = v / 65535.0f;
+                }
+                break;
+            case HeightEncoding::R32F:
+                memcpy(out, src, cells * sizeof(float));
+                break;
+            case HeightEncoding::RGBA8:
+                for (uint32_t c = 0; c < cells; c++) out[c] = src[c * 4] / 255.0f;
+                break;
+        }
+    };
+    auto readback_biome = [&](uint32_t slot) {
+        return verify_readback_mapped + 2 * heightBytes + static_cast<VkDeviceSize>(cells) * slot;
+    };
+    
+    // GPU state vs the reference's latest: heights within one stored level
+    // (compilers may contract the erosion math differently), biomes exact
+    // unless --verify-tolerance allows a fraction of cells to differ
+    float heightSlack = heightLevels > 0.0f ? 1.0f / heightLevels + 1e-6f : 1e-6f;
+    auto compare_reference = [&](uint32_t step) {
+        uint32_t cur = static_cast<uint32_t>(current_heightmap_index);
+        readback_height(cur, gpuHeight.data());
+        const uint8_t* gpuBiome = readback_biome(1 - cur);
+        const float* cpuHeight = reference->heightmap();
+        const uint8_t* cpuBiome = reference->biomemap();
+        
+        float maxDiff = 0.0f;
+        uint32_t biomeDiffs = 0;
+        for (uint32_t c = 0; c < cells; c++) {
+            maxDiff = std::max(maxDiff, std::abs(gpuHeight[c] - cpuHeight[c]));
+            biomeDiffs += gpuBiome[c] != cpuBiome[c];
+        }
+        float biomeFraction = static_cast<float>(biomeDiffs) / cells;
+        if (maxDiff > heightSlack || biomeFraction > config.verifyTolerance) {
+            std::cerr << "Step " << step << ": GPU differs from the CPU reference (max height diff "
+                      << maxDiff << ", " << biomeDiffs << " biome cells)\n";
+            return false;
+        }
+        return true;
+    };
+    
+    // Next batch starts from the GPU state, so differences don't compound
+    auto restart_reference = [&]() {
+        for (uint32_t i = 0; i < 2; i++) {
+            readback_height(i, reference->height_data(i));
+            memcpy(reference->biome_data(i), readback_biome(i), cells);
+        }
+        reference->set_position(static_cast<uint32_t>(current_heightmap_index), simStep);
+    };
+    
+    // Hash (and read back) the current state, stepping `steps` first
+    auto submit = [&](uint32_t steps) {
+        VK_CHECK(vkWaitForFences(device.device, 1, &in_flight_fences[0], true, UINT64_MAX));
+        VK_CHECK(vkResetFences(device.device, 1, &in_flight_fences[0]));
+        
+        VkCommandBuffer cmd = command_buffers[0];
+        VK_CHECK(vkResetCommandBuffer(cmd, 0));
+        
+        VkCommandBufferBeginInfo cmdBeginInfo = {};
+        cmdBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CHECK(vkBeginCommandBuffer(cmd, &cmdBeginInfo));
+        
+        if (steps > 0) record_simulation_steps(cmd, steps);
+        record_state_hash(cmd);
+        record_verify_readback(cmd);
+        
+        VK_CHECK(vkEndCommandBuffer(cmd));
+        
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &cmd;
+        VK_CHECK(vkQueueSubmit(graphics_queue, 1, &submitInfo, in_flight_fences[0]));
+        VK_CHECK(vkWaitForFences(device.device, 1, &in_flight_fences[0], true, UINT64_MAX));
+        if (verify_readback_buffer) vmaInvalidateAllocation(allocator, verify_readback_allocation, 0, VK_WHOLE_SIZE);
+        return read_state_hash();
+    };
+    
+    // Returns false on the first mismatch
+    size_t goldenNext = 0;
+    auto check = [&](uint32_t step, const StateHash& hash) {
+        recorded.steps.push_back({step, hash});
+        
+        if (reference) {
+            // The reduction itself, against the same state hashed on the host
+            uint32_t cur = static_cast<uint32_t>(current_heightmap_index);
+            readback_height(cur, gpuHeight.data());
+            StateHash host = hash_state(gpuHeight.data(), readback_biome(1 - cur), cells, heightLevels);
+            if (host != hash) {
+                std::cerr << "Step " << step << ": state_hash.comp disagrees with the host hash of the same state\n";
+                return false;
+            }
+        }
+        
+        if (useGolden) {
+            while (goldenNext < golden.steps.size() && golden.steps[goldenNext].first < step) goldenNext++;
+            if (goldenNext < golden.steps.size() && golden.steps[goldenNext].first == step) {
+                const StateHash& expected = golden.steps[goldenNext].second;
+                if (expected.height != hash.height) {
+                    std::cerr << "Step " << step << ": height hash " << std::hex << hash.height
+                              << " != golden " << expected.height << std::dec << "\n";
+                    return false;
+                }
+                if (expected.biome != hash.biome) {
+                    std::cerr << "Step " << step << ": biome hash " << std::hex << hash.biome
+                              << " != golden " << expected.biome << std::dec << "\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    
+    auto start = std::chrono::steady_clock::now();
+    bool ok = true;
+    
+    // Step 0: the initial state. The reference only generates it itself for a
+    // freshly seeded two-layer world.
+    StateHash initial = submit(0);
+    ok = check(simStep, initial);
+    if (ok && reference) {
+        if (config.loadStatePath.empty() && !config.climate) {
+            reference->init_terrain(currentSeed);
+            reference->init_biomes(biomePushConstants);
+            ok = compare_reference(simStep);
+        }
+        restart_reference();
+    }
+    
+    uint32_t done = 0;
+    while (ok && done < total) {
+        uint32_t steps = std::min(batch, total - done);
+        StateHash hash = submit(steps);
+        done += steps;
+        ok = check(simStep, hash);
+        if (ok && reference) {
+            BiomePushConstants params = biomePushConstants;
+            for (uint32_t i = 0; i < steps; i++) reference->step(erosionParams, params);
+            ok = compare_reference(simStep);
+            if (ok) restart_reference();
+        }
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    if (useGolden && ok && !golden.steps.empty() && recorded.steps.back().first < golden.steps.back().first) {
+        std::cout << "Note: golden file continues to step " << golden.steps.back().first << "\n";
+    }
+    if (!config.writeGoldenPath.empty()) {
+        if (write_golden(config.writeGoldenPath, recorded)) {
+            std::cout << "Golden hashes written to: " << config.writeGoldenPath << "\n";
+        } else {
+            std::cerr << "Failed to write " << config.writeGoldenPath << "\n";
+            ok = false;
+        }
     }
+    
+    std::cout << (ok ? "PASS" : "FAIL") << ": " << done << " steps, "
+              << recorded.steps.size() << " hashes in " << seconds << "s\n";
+    return ok;
 }
 
 void LivingWorlds::main_loop() {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point lastFrameStart;
+    
     while (!glfwWindowShouldClose(window)) {
+        Clock::time_point frameStart = Clock::now();
         glfwPollEvents();
         draw();
         
@@ -1600,6 +3609,15 @@ void LivingWorlds::main_loop() {
         if (config.benchmarkMode) {
             double elapsed = glfwGetTime() - benchmarkStartTime;
             
+            // Every frame into the timing ring (no I/O until exit). CPU time
+            // leaves out draw()'s fence and acquire waits, logged separately.
+            float busyMs = std::chrono::duration<float, std::milli>(Clock::now() - frameStart).count();
+            float cpuMs = std::max(busyMs - lastFrameWaitMs, 0.0f);
+            float intervalMs = lastFrameStart == Clock::time_point{} ? busyMs
+                             : std::chrono::duration<float, std::milli>(frameStart - lastFrameStart).count();
+            frameTimings.record(elapsed, intervalMs, cpuMs, lastFrameWaitMs, static_cast<uint32_t>(lastFrameSteps));
+            lastFrameStart = frameStart;
+            
             // Write to CSV every second
             if (elapsed - lastCSVWrite >= 1.0) {
                 float frameMs = fps > 0 ? 1000.0f / fps : 0.0f;
@@ -1609,12 +3627,20 @@ void LivingWorlds::main_loop() {
                              << config.gridSize << ","
                              << config.simSpeed << ","
                              << (config.enableErosion ? "true" : "false") << ","
-                             << (config.enableBiomeCA ? "true" : "false") << "\n";
+                             << (config.enableBiomeCA ? "true" : "false") << ","
+                             << stepsPerSecond;
+                // GPU ms per frame over the last second; blank without timestamps
+                // (stages were registered in GPU_PROFILE_STAGES order)
+                for (size_t i = 0; i < std::size(GPU_PROFILE_STAGES); i++) {
+                    benchmarkCSV << ",";
+                    if (gpuProfiler.enabled()) benchmarkCSV << gpuProfiler.stages()[i].avgMs;
+                }
+                benchmarkCSV << "\n";
                 benchmarkCSV.flush();
                 lastCSVWrite = elapsed;
                 
                 std::cout << "\r[" << static_cast<int>(elapsed) << "/" << config.duration 
-                          << "s] FPS: " << fps << std::flush;
+                          << "s] FPS: " << fps << " Steps/s: " << stepsPerSecond << std::flush;
             }
             
             // Auto-exit after duration
@@ -1631,11 +3657,39 @@ void LivingWorlds::main_loop() {
     }
     
     vkDeviceWaitIdle(device.device);
+    if (config.benchmarkMode) write_frame_timings();
     std::cout << "\nTerminating...\n";
 }
 
+// Per-frame log, percentile summary and histogram next to the benchmark CSV.
+// Called after vkDeviceWaitIdle, so the frames still in flight get their
+// GPU times too.
+void LivingWorlds::write_frame_timings() {
+    for (int slot = 0; slot <= MAX_FRAMES_IN_FLIGHT; slot++) {
+        double ms = gpuProfiler.collect(slot);
+        if (ms < 0.0) continue;
+        if (slot == MAX_FRAMES_IN_FLIGHT) frameTimings.set_compute(profiledFrame[slot], static_cast<float>(ms));
+        else frameTimings.set_gpu(profiledFrame[slot], static_cast<float>(ms));
+        frameTimings.add_stages(profiledFrame[slot], gpuProfiler.collected());
+    }
+    
+    bool ok = frameTimings.write_frames(benchmarkName + "_frames.csv") &&
+              frameTimings.write_summary(benchmarkName + "_summary.csv") &&
+              frameTimings.write_histogram(benchmarkName + "_histogram.csv");
+    if (ok) {
+        std::cout << "Frame timings: " << benchmarkName << "_{frames,summary,histogram}.csv\n";
+    } else {
+        std::cerr << "Failed to write frame timings for " << benchmarkName << "\n";
+    }
+}
+
 void LivingWorlds::cleanup() {
     vkDeviceWaitIdle(device.device);
+    shutdown_export();
+    finish_checkpoint();
+    if (pickBuild.valid()) pickBuild.wait(); // Reads the mapped readback
+    release_aliased_images();
+    gpuProfiler.destroy();
     
     // ImGui
     cleanup_imgui(); 
@@ -1655,6 +3709,56 @@ void LivingWorlds::cleanup() {
     // Week 5.5: Biome CA Pipeline cleanup
     vkDestroyPipeline(device.device, biome_ca_pipeline, nullptr);
     vkDestroyPipelineLayout(device.device, biome_ca_pipeline_layout, nullptr);
+    if (fused_pipeline) vkDestroyPipeline(device.device, fused_pipeline, nullptr);
+    if (fused_pipeline_layout) vkDestroyPipelineLayout(device.device, fused_pipeline_layout, nullptr);
+    if (temporal_pipeline) vkDestroyPipeline(device.device, temporal_pipeline, nullptr);
+    if (temporal_pipeline_layout) vkDestroyPipelineLayout(device.device, temporal_pipeline_layout, nullptr);
+    if (sim_stats_pipeline_layout) {
+        vkDestroyPipeline(device.device, sim_stats_pipeline, nullptr);
+        vkDestroyPipelineLayout(device.device, sim_stats_pipeline_layout, nullptr);
+        vkDestroyDescriptorPool(device.device, sim_stats_pool, nullptr);
+        vkDestroyDescriptorSetLayout(device.device, sim_stats_layout, nullptr);
+        vmaUnmapMemory(allocator, sim_stats_allocation);
+        vmaDestroyBuffer(allocator, sim_stats_buffer, sim_stats_allocation);
+    }
+    if (pick_readback_buffer) {
+        vmaUnmapMemory(allocator, pick_readback_allocation);
+        vmaDestroyBuffer(allocator, pick_readback_buffer, pick_readback_allocation);
+    }
+    if (brush_pipeline_layout) {
+        vkDestroyPipeline(device.device, brush_pipeline, nullptr);
+        vkDestroyPipelineLayout(device.device, brush_pipeline_layout, nullptr);
+        vkDestroyDescriptorPool(device.device, brush_pool, nullptr);
+        vkDestroyDescriptorSetLayout(device.device, brush_layout, nullptr);
+        vmaUnmapMemory(allocator, brush_allocation);
+        vmaDestroyBuffer(allocator, brush_buffer, brush_allocation);
+    }
+    if (snapshot_readback_buffer) {
+        vmaDestroyBuffer(allocator, snapshot_readback_buffer, snapshot_readback_allocation);
+    }
+    if (bitsliced_pipeline_layout) {
+        vkDestroyPipeline(device.device, erosion_bitsliced_pipeline, nullptr);
+        vkDestroyPipeline(device.device, biome_ca_bitsliced_pipeline, nullptr);
+        vkDestroyPipeline(device.device, biome_convert_pipeline, nullptr);
+        vkDestroyPipelineLayout(device.device, bitsliced_pipeline_layout, nullptr);
+        vkDestroyDescriptorPool(device.device, biome_plane_pool, nullptr);
+        vkDestroyDescriptorSetLayout(device.device, biome_plane_layout, nullptr);
+        for (int i = 0; i < 2; i++) {
+            vmaDestroyBuffer(allocator, biome_plane_buffers[i], biome_plane_allocations[i]);
+        }
+    }
+    if (active_pipeline_layout) {
+        vkDestroyPipeline(device.device, tile_compact_pipeline, nullptr);
+        vkDestroyPipeline(device.device, erosion_active_pipeline, nullptr);
+        vkDestroyPipeline(device.device, biome_ca_active_pipeline, nullptr);
+        vkDestroyPipelineLayout(device.device, active_pipeline_layout, nullptr);
+        vkDestroyDescriptorPool(device.device, active_tile_pool, nullptr);
+        vkDestroyDescriptorSetLayout(device.device, active_tile_layout, nullptr);
+        for (int i = 0; i < 2; i++) {
+            vmaDestroyBuffer(allocator, tile_flag_buffers[i], tile_flag_allocations[i]);
+            vmaDestroyBuffer(allocator, tile_list_buffers[i], tile_list_allocations[i]);
+        }
+    }
     
     // Terrain Pipeline Cleanup
     vkDestroyPipeline(device.device, terrain_pipeline, nullptr);
@@ -1670,8 +3774,26 @@ void LivingWorlds::cleanup() {
         vmaDestroyBuffer(allocator, uniformBuffers[i], uniformBuffersAllocation[i]);
     }
     
-    vmaDestroyBuffer(allocator, vertexBuffer, vertexBufferAllocation);
-    vmaDestroyBuffer(allocator, indexBuffer, indexBufferAllocation);
+    vkDestroyPipeline(device.device, height_pyramid_pipeline, nullptr);
+    vkDestroyPipelineLayout(device.device, height_pyramid_pipeline_layout, nullptr);
+    vkDestroyDescriptorSetLayout(device.device, height_pyramid_layout, nullptr);
+    vkDestroyDescriptorPool(device.device, height_pyramid_pool, nullptr);
+    vmaDestroyBuffer(allocator, height_pyramid_counter_buffer, height_pyramid_counter_allocation);
+    for (VkImageView view : height_pyramid_level_views) vkDestroyImageView(device.device, view, nullptr);
+    vkDestroyImageView(device.device, height_pyramid_view, nullptr);
+    vmaDestroyImage(allocator, height_pyramid_image, height_pyramid_allocation);
+    vkDestroyPipeline(device.device, terrain_cull_pipeline, nullptr);
+    vkDestroyPipelineLayout(device.device, terrain_cull_pipeline_layout, nullptr);
+    vkDestroyDescriptorSetLayout(device.device, terrain_cull_layout, nullptr);
+    vkDestroyDescriptorPool(device.device, terrain_cull_pool, nullptr);
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        vmaUnmapMemory(allocator, terrainPatchAllocations[i]);
+        vmaDestroyBuffer(allocator, terrainPatchBuffers[i], terrainPatchAllocations[i]);
+        vmaDestroyBuffer(allocator, visiblePatchBuffers[i], visiblePatchAllocations[i]);
+        vmaDestroyBuffer(allocator, terrainDrawArgsBuffers[i], terrainDrawArgsAllocations[i]);
+    }
+    
+    vmaDestroyBuffer(allocator, patchIndexBuffer, patchIndexAllocation);
     
     vkDestroyImageView(device.device, depthImageView, nullptr);
     vmaDestroyImage(allocator, depthImage, depthImageAllocation);
@@ -1697,6 +3819,19 @@ void LivingWorlds::cleanup() {
         vmaDestroyImage(allocator, biome_images[i], biome_allocations[i]);
     }
 
+    // Async Compute
+    if (asyncCompute) {
+        for(int i=0; i<2; i++) {
+            vkDestroyImageView(device.device, display_height_views[i], nullptr);
+            vmaDestroyImage(allocator, display_height_images[i], display_height_allocations[i]);
+            vkDestroyImageView(device.device, display_biome_views[i], nullptr);
+            vmaDestroyImage(allocator, display_biome_images[i], display_biome_allocations[i]);
+        }
+        vkDestroySemaphore(device.device, sim_timeline, nullptr);
+        vkDestroySemaphore(device.device, render_timeline, nullptr);
+        vkDestroyCommandPool(device.device, compute_command_pool, nullptr);
+    }
+
     // Sync
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         if(in_flight_fences[i]) vkDestroyFence(device.device, in_flight_fences[i], nullptr);
@@ -1724,6 +3859,668 @@ void LivingWorlds::cleanup() {
     glfwTerminate();
 }
 
+void LivingWorlds::cleanup_headless() {
+    vkDeviceWaitIdle(device.device);
+    shutdown_export();
+    finish_checkpoint();
+    release_aliased_images();
+    
+    vkDestroyPipeline(device.device, noise_pipeline, nullptr);
+    vkDestroyPipelineLayout(device.device, noise_pipeline_layout, nullptr);
+    vkDestroyPipeline(device.device, biome_pipeline, nullptr);
+    vkDestroyPipelineLayout(device.device, biome_pipeline_layout, nullptr);
+    vkDestroyPipeline(device.device, biome_growth_pipeline, nullptr);
+    vkDestroyPipelineLayout(device.device, biome_growth_pipeline_layout, nullptr);
+    vkDestroyPipeline(device.device, erosion_pipeline, nullptr);
+    vkDestroyPipelineLayout(device.device, erosion_pipeline_layout, nullptr);
+    vkDestroyPipeline(device.device, biome_ca_pipeline, nullptr);
+    vkDestroyPipelineLayout(device.device, biome_ca_pipeline_layout, nullptr);
+    if (fused_pipeline) vkDestroyPipeline(device.device, fused_pipeline, nullptr);
+    if (fused_pipeline_layout) vkDestroyPipelineLayout(device.device, fused_pipeline_layout, nullptr);
+    if (temporal_pipeline) vkDestroyPipeline(device.device, temporal_pipeline, nullptr);
+    if (temporal_pipeline_layout) vkDestroyPipelineLayout(device.device, temporal_pipeline_layout, nullptr);
+    gpuProfiler.destroy();
+    destroy_state_hash();
+    if (snapshot_readback_buffer) {
+        vmaDestroyBuffer(allocator, snapshot_readback_buffer, snapshot_readback_allocation);
+    }
+    if (bitsliced_pipeline_layout) {
+        vkDestroyPipeline(device.device, erosion_bitsliced_pipeline, nullptr);
+        vkDestroyPipeline(device.device, biome_ca_bitsliced_pipeline, nullptr);
+        vkDestroyPipeline(device.device, biome_convert_pipeline, nullptr);
+        vkDestroyPipelineLayout(device.device, bitsliced_pipeline_layout, nullptr);
+        vkDestroyDescriptorPool(device.device, biome_plane_pool, nullptr);
+        vkDestroyDescriptorSetLayout(device.device, biome_plane_layout, nullptr);
+        for (int i = 0; i < 2; i++) {
+            vmaDestroyBuffer(allocator, biome_plane_buffers[i], biome_plane_allocations[i]);
+        }
+    }
+    if (active_pipeline_layout) {
+        vkDestroyPipeline(device.device, tile_compact_pipeline, nullptr);
+        vkDestroyPipeline(device.device, erosion_active_pipeline, nullptr);
+        vkDestroyPipeline(device.device, biome_ca_active_pipeline, nullptr);
+        vkDestroyPipelineLayout(device.device, active_pipeline_layout, nullptr);
+        vkDestroyDescriptorPool(device.device, active_tile_pool, nullptr);
+        vkDestroyDescriptorSetLayout(device.device, active_tile_layout, nullptr);
+        for (int i = 0; i < 2; i++) {
+            vmaDestroyBuffer(allocator, tile_flag_buffers[i], tile_flag_allocations[i]);
+            vmaDestroyBuffer(allocator, tile_list_buffers[i], tile_list_allocations[i]);
+        }
+    }
+    
+    vkDestroyDescriptorPool(device.device, descriptor_pool, nullptr);
+    vkDestroyDescriptorSetLayout(device.device, compute_descriptor_layout, nullptr);
+    
+    for(int i=0; i<2; i++) {
+        vkDestroyImageView(device.device, storage_image_views[i], nullptr);
+        vmaDestroyImage(allocator, storage_images[i], storage_image_allocations[i]);
+        vkDestroyImageView(device.device, heightmap_views[i], nullptr);
+        vmaDestroyImage(allocator, heightmap_images[i], heightmap_allocations[i]);
+        vkDestroyImageView(device.device, temp_views[i], nullptr);
+        vmaDestroyImage(allocator, temp_images[i], temp_allocations[i]);
+        vkDestroyImageView(device.device, humidity_views[i], nullptr);
+        vmaDestroyImage(allocator, humidity_images[i], humidity_allocations[i]);
+        vkDestroyImageView(device.device, biome_views[i], nullptr);
+        vmaDestroyImage(allocator, biome_images[i], biome_allocations[i]);
+    }
+    
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        vkDestroyFence(device.device, in_flight_fences[i], nullptr);
+        vkDestroySemaphore(device.device, image_available_semaphores[i], nullptr);
+    }
+    vkDestroyCommandPool(device.device, command_pool, nullptr);
+    
+    vmaDestroyAllocator(allocator);
+    vkDestroyDevice(device.device, nullptr);
+    vkb::destroy_debug_utils_messenger(instance.instance, debug_messenger);
+    vkDestroyInstance(instance.instance, nullptr);
+}
+
+// =================================================================================================
+// Snapshots (--save-state / --load-state)
+// =================================================================================================
+
+// Sim image behind a snapshot layer, or VK_NULL_HANDLE when this run doesn't
+// have it (climate off) or the slot aliases slot 0 (stage disabled)
+VkImage LivingWorlds::snapshot_image(uint32_t kind, uint32_t slot) {
+    if (slot > 1) return VK_NULL_HANDLE;
+    VkImage* images = nullptr;
+    switch (kind) {
+        case snapshot::LAYER_HEIGHT:      images = heightmap_images; break;
+        case snapshot::LAYER_BIOME:       images = biome_images; break;
+        case snapshot::LAYER_TEMPERATURE: images = temp_images; break;
+        case snapshot::LAYER_HUMIDITY:    images = humidity_images; break;
+        default: return VK_NULL_HANDLE;
+    }
+    if (slot == 1 && images[1] == images[0]) return VK_NULL_HANDLE;
+    return images[slot];
+}
+
+// Both ping-pong slots of every live layer: the next step reads the older
+// biome generation too, so resuming exactly needs all of them
+void LivingWorlds::fill_snapshot_layers(snapshot::Header& header) {
+    header.layerCount = 0;
+    auto add = [&](uint32_t kind, VkFormat format, uint32_t bytesPerTexel) {
+        for (uint32_t slot = 0; slot < 2; slot++) {
+            if (!snapshot_image(kind, slot)) continue;
+            snapshot::Layer& layer = header.layers[header.layerCount++];
+            layer.kind = kind;
+            layer.slot = slot;
+            layer.format = static_cast<uint32_t>(format);
+            layer.bytesPerTexel = bytesPerTexel;
+        }
+    };
+    add(snapshot::LAYER_HEIGHT, config.heightFormat, config.heightFormat == VK_FORMAT_R16_UNORM ? 2 : 4);
+    add(snapshot::LAYER_BIOME, VK_FORMAT_R8_UINT, 1);
+    add(snapshot::LAYER_TEMPERATURE, VK_FORMAT_R32_SFLOAT, 4);
+    add(snapshot::LAYER_HUMIDITY, VK_FORMAT_R32_SFLOAT, 4);
+}
+
+// One VkBufferImageCopy per tile; the buffer uses the file layout
+static std::vector<VkBufferImageCopy> snapshot_regions(const snapshot::Header& header, const snapshot::Layer& layer) {
+    std::vector<VkBufferImageCopy> regions;
+    uint32_t tilesX = snapshot::tiles_x(header);
+    uint32_t tilesY = snapshot::tiles_y(header);
+    uint64_t tileBytes = snapshot::tile_bytes(header, layer);
+    for (uint32_t ty = 0; ty < tilesY; ty++) {
+        for (uint32_t tx = 0; tx < tilesX; tx++) {
+            VkBufferImageCopy region = {};
+            region.bufferOffset = layer.offset + (static_cast<uint64_t>(ty) * tilesX + tx) * tileBytes;
+            region.bufferRowLength = header.tileSize;
+            region.bufferImageHeight = header.tileSize;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {static_cast<int32_t>(tx * header.tileSize), static_cast<int32_t>(ty * header.tileSize), 0};
+            region.imageExtent = {std::min(header.tileSize, header.width - tx * header.tileSize),
+                                  std::min(header.tileSize, header.height - ty * header.tileSize), 1};
+            regions.push_back(region);
+        }
+    }
+    return regions;
+}
+
+// Header for the state as of the last recorded step, with the file layout
+snapshot::Header LivingWorlds::snapshot_header() {
+    snapshot::Header header;
+    header.width = simWidth;
+    header.height = simHeight;
+    header.heightmapIndex = static_cast<uint32_t>(current_heightmap_index);
+    header.simStep = simStep;
+    header.seed = currentSeed;
+    header.erosionSize = sizeof(ErosionPushConstants);
+    header.biomeSize = sizeof(BiomePushConstants);
+    memcpy(header.erosion, &erosionParams, sizeof(ErosionPushConstants));
+    memcpy(header.biome, &biomePushConstants, sizeof(BiomePushConstants));
+    fill_snapshot_layers(header);
+    uint64_t fileSize = snapshot::layout(header);
+    
+    // Kept between saves; only reallocated if the layout grows. Callers make
+    // sure no checkpoint still owns it.
+    if (fileSize > snapshot_readback_size) {
+        if (snapshot_readback_buffer) vmaDestroyBuffer(allocator, snapshot_readback_buffer, snapshot_readback_allocation);
+        create_buffer(fileSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU,
+                      snapshot_readback_buffer, snapshot_readback_allocation);
+        snapshot_readback_size = fileSize;
+    }
+    return header;
+}
+
+void LivingWorlds::record_snapshot_copies(VkCommandBuffer cmd, const snapshot::Header& header) {
+    for (uint32_t i = 0; i < header.layerCount; i++) {
+        const snapshot::Layer& layer = header.layers[i];
+        std::vector<VkBufferImageCopy> regions = snapshot_regions(header, layer);
+        vkCmdCopyImageToBuffer(cmd, snapshot_image(layer.kind, layer.slot), VK_IMAGE_LAYOUT_GENERAL,
+                               snapshot_readback_buffer, static_cast<uint32_t>(regions.size()), regions.data());
+    }
+    
+    VkMemoryBarrier hostBar = {};
+    hostBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    hostBar.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBar.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 1, &hostBar, 0, nullptr, 0, nullptr);
+}
+
+// Reads every live sim image back in file layout and hands it to the
+// writer, which replaces the file atomically and only rewrites tiles that
+// changed since the spare it reuses was written. Blocks on the GPU and the
+// disk, so it only runs on exit; --checkpoint-steps goes through
+// record_checkpoint() instead.
+void LivingWorlds::save_state(const std::string& path) {
+    finish_checkpoint(); // Shares the readback buffer and the writer
+    wait_simulation_idle();
+    
+    snapshot::Header header = snapshot_header();
+    VkCommandBuffer cmd = begin_one_shot_commands();
+    
+    // Whatever the frames in flight wrote -> readback
+    VkMemoryBarrier memBar = {};
+    memBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memBar.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    memBar.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &memBar, 0, nullptr, 0, nullptr);
+    record_snapshot_copies(cmd, header);
+    submit_one_shot_commands(cmd);
+    
+    void* mapped;
+    vmaMapMemory(allocator, snapshot_readback_allocation, &mapped);
+    vmaInvalidateAllocation(allocator, snapshot_readback_allocation, 0, VK_WHOLE_SIZE);
+    snapshot::Writer::Result result = snapshot_writer.write(path, header, static_cast<const uint8_t*>(mapped));
+    vmaUnmapMemory(allocator, snapshot_readback_allocation);
+    
+    if (result.ok) {
+        std::cout << "Saved state to " << path << " at step " << simStep << " ("
+                  << result.tilesWritten << "/" << result.tilesTotal << " tiles written)\n";
+    }
+    lastCheckpointStep = simStep;
+}
+
+// Wraps host memory (the snapshot mapping) in a transfer-source buffer
+// without copying it. Fails on drivers that reject file-backed pages.
+bool LivingWorlds::import_host_buffer(const void* ptr, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory) {
+    if (!hostImportSupported) return false;
+    
+    VkPhysicalDeviceExternalMemoryHostPropertiesEXT hostProps = {};
+    hostProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2 props2 = {};
+    props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    props2.pNext = &hostProps;
+    vkGetPhysicalDeviceProperties2(physical_device.physical_device, &props2);
+    VkDeviceSize alignment = hostProps.minImportedHostPointerAlignment;
+    if (alignment == 0 || reinterpret_cast<uintptr_t>(ptr) % alignment != 0 || size % alignment != 0) return false;
+    
+    auto getHostPointerProperties = reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(
+        vkGetDeviceProcAddr(device.device, "vkGetMemoryHostPointerPropertiesEXT"));
+    VkMemoryHostPointerPropertiesEXT pointerProps = {};
+    pointerProps.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+    if (!getHostPointerProperties ||
+        getHostPointerProperties(device.device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, ptr, &pointerProps) != VK_SUCCESS) {
+        return false;
+    }
+    
+    VkExternalMemoryBufferCreateInfo externalInfo = {};
+    externalInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+    externalInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.pNext = &externalInfo;
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device.device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) return false;
+    
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device.device, buffer, &requirements);
+    uint32_t typeBits = requirements.memoryTypeBits & pointerProps.memoryTypeBits;
+    if (typeBits == 0) {
+        vkDestroyBuffer(device.device, buffer, nullptr);
+        return false;
+    }
+    
+    VkImportMemoryHostPointerInfoEXT importInfo = {};
+    importInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+    importInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+    importInfo.pHostPointer = const_cast<void*>(ptr);
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext = &importInfo;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = static_cast<uint32_t>(__builtin_ctz(typeBits));
+    if (vkAllocateMemory(device.device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        vkDestroyBuffer(device.device, buffer, nullptr);
+        return false;
+    }
+    VK_CHECK(vkBindBufferMemory(device.device, buffer, memory, 0));
+    return true;
+}
+
+// Replaces the freshly generated world with a snapshot. Layers come
+// straight from the mapping: imported as-is with --import-host-memory,
+// otherwise one memcpy into a staging buffer.
+bool LivingWorlds::load_state(const std::string& path) {
+    snapshot::MappedFile file;
+    if (!file.open(path)) return false;
+    const snapshot::Header& header = file.header();
+    
+    if (header.width != simWidth || header.height != simHeight) {
+        std::cerr << "Snapshot " << path << " is " << header.width << "x" << header.height
+                  << ", grid is " << simWidth << "x" << simHeight << " (use --grid " << header.width << ")\n";
+        return false;
+    }
+    const snapshot::Layer* height0 = snapshot::find_layer(header, snapshot::LAYER_HEIGHT, 0);
+    if (!height0 || height0->format != static_cast<uint32_t>(config.heightFormat)) {
+        std::cerr << "Snapshot " << path << " has a different height format (--height-format)\n";
+        return false;
+    }
+    
+    // Every image this run has; a slot the snapshot lacks (stage was off
+    // when it was saved) gets slot 0's data. All of them are checked against
+    // the live image formats before any copy is recorded.
+    snapshot::Header live;
+    fill_snapshot_layers(live);
+    struct Upload { VkImage image; const snapshot::Layer* layer; };
+    std::vector<Upload> uploads;
+    const uint32_t kinds[4] = {snapshot::LAYER_HEIGHT, snapshot::LAYER_BIOME,
+                               snapshot::LAYER_TEMPERATURE, snapshot::LAYER_HUMIDITY};
+    for (uint32_t kind : kinds) {
+        for (uint32_t slot = 0; slot < 2; slot++) {
+            VkImage image = snapshot_image(kind, slot);
+            if (!image) continue;
+            const snapshot::Layer* layer = snapshot::find_layer(header, kind, slot);
+            if (!layer) layer = snapshot::find_layer(header, kind, 0);
+            if (!layer) continue; // e.g. climate layers the snapshot didn't have
+            const snapshot::Layer* expected = snapshot::find_layer(live, kind, slot);
+            if (!expected || layer->format != expected->format || layer->bytesPerTexel != expected->bytesPerTexel) {
+                std::cerr << "Snapshot " << path << ": layer " << kind << " slot " << slot
+                          << " doesn't match this run's image format\n";
+                return false;
+            }
+            uploads.push_back({image, layer});
+        }
+    }
+    
+    VkBuffer staging = VK_NULL_HANDLE;
+    VmaAllocation stagingAlloc = VK_NULL_HANDLE;
+    VkDeviceMemory importedMemory = VK_NULL_HANDLE;
+    bool imported = config.importHostMemory && import_host_buffer(file.data(), file.size(), staging, importedMemory);
+    if (!imported) {
+        create_buffer(file.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, staging, stagingAlloc);
+        void* mapped;
+        vmaMapMemory(allocator, stagingAlloc, &mapped);
+        memcpy(mapped, file.data(), file.size());
+        vmaUnmapMemory(allocator, stagingAlloc);
+    }
+    
+    wait_simulation_idle();
+    VkCommandBuffer cmd = begin_one_shot_commands();
+    
+    // Frames in flight -> overwrite
+    VkMemoryBarrier memBar = {};
+    memBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memBar.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    memBar.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &memBar, 0, nullptr, 0, nullptr);
+    
+    for (const Upload& upload : uploads) {
+        std::vector<VkBufferImageCopy> regions = snapshot_regions(header, *upload.layer);
+        vkCmdCopyBufferToImage(cmd, staging, upload.image, VK_IMAGE_LAYOUT_GENERAL,
+                               static_cast<uint32_t>(regions.size()), regions.data());
+    }
+    submit_one_shot_commands(cmd);
+    
+    if (imported) {
+        vkDestroyBuffer(device.device, staging, nullptr);
+        vkFreeMemory(device.device, importedMemory, nullptr);
+    } else {
+        vmaDestroyBuffer(allocator, staging, stagingAlloc);
+    }
+    
+    current_heightmap_index = header.heightmapIndex % 2;
+    simStep = static_cast<uint32_t>(header.simStep);
+    currentSeed = header.seed;
+    if (header.erosionSize == sizeof(ErosionPushConstants)) memcpy(&erosionParams, header.erosion, sizeof(ErosionPushConstants));
+    if (header.biomeSize == sizeof(BiomePushConstants)) memcpy(&biomePushConstants, header.biome, sizeof(BiomePushConstants));
+    lastCheckpointStep = simStep;
+    lastExportStep = simStep;
+    pickRefreshDue = true;
+    heightPyramidFull = true;
+    
+    displayDirty = true;
+    activeTilesForce = true;
+    biomePlanesNeedPack = true;
+    frame_graph.invalidate();
+    wake_simulation();
+    
+    std::cout << "Loaded state from " << path << " at step " << simStep
+              << (imported ? " (imported host memory)" : "") << "\n";
+    return true;
+}
+
+// --checkpoint-steps: appends the snapshot readback to the batch just
+// recorded, if one is due. Same discipline as the pick refresh: one
+// checkpoint at a time, and a due one waits for the previous write rather
+// than stalling the frame.
+void LivingWorlds::record_checkpoint(VkCommandBuffer cmd, int frame) {
+    if (config.saveStatePath.empty() || config.checkpointSteps <= 0) return;
+    if (checkpointState != CHECKPOINT_IDLE) return;
+    if (simStep - lastCheckpointStep < static_cast<uint32_t>(config.checkpointSteps)) return;
+    
+    checkpointHeader = snapshot_header();
+    frame_graph.add_pass("checkpoint", VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         {fg_height[0], fg_height[1], fg_biome[0], fg_biome[1]}, {},
+                         [this](VkCommandBuffer c) { record_snapshot_copies(c, checkpointHeader); });
+    frame_graph.execute(cmd);
+    
+    checkpointFrame = frame;
+    checkpointTimeline = sim_timeline_value + 1; // Signalled by the submit that follows
+    checkpointState = CHECKPOINT_IN_FLIGHT;
+    lastCheckpointStep = simStep;
+}
+
+// Starts the write once the copies landed (hashing and file I/O run on a
+// worker) and reports a finished one. Called right after a fence wait,
+// like poll_exports().
+void LivingWorlds::poll_checkpoint() {
+    if (checkpointState == CHECKPOINT_IN_FLIGHT) {
+        bool complete;
+        if (checkpointFrame >= 0) {
+            complete = vkGetFenceStatus(device.device, in_flight_fences[checkpointFrame]) == VK_SUCCESS;
+        } else {
+            uint64_t simCompleted = 0;
+            vkGetSemaphoreCounterValue(device.device, sim_timeline, &simCompleted);
+            complete = simCompleted >= checkpointTimeline;
+        }
+        if (complete) {
+            void* mapped;
+            vmaMapMemory(allocator, snapshot_readback_allocation, &mapped);
+            vmaInvalidateAllocation(allocator, snapshot_readback_allocation, 0, VK_WHOLE_SIZE);
+            snapshot::Writer* writer = &snapshot_writer;
+            std::string path = config.saveStatePath;
+            snapshot::Header header = checkpointHeader;
+            const uint8_t* data = static_cast<const uint8_t*>(mapped);
+            checkpointWrite = std::async(std::launch::async, [writer, path, header, data] {
+                return writer->write(path, header, data);
+            });
+            checkpointState = CHECKPOINT_WRITING;
+        }
+    }
+    if (checkpointState == CHECKPOINT_WRITING &&
+        checkpointWrite.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        snapshot::Writer::Result result = checkpointWrite.get();
+        vmaUnmapMemory(allocator, snapshot_readback_allocation);
+        if (result.ok) {
+            std::cout << "Checkpoint " << config.saveStatePath << " at step " << checkpointHeader.simStep << " ("
+                      << result.tilesWritten << "/" << result.tilesTotal << " tiles written)\n";
+        }
+        checkpointState = CHECKPOINT_IDLE;
+    }
+}
+
+// Blocks until an outstanding checkpoint is on disk
+void LivingWorlds::finish_checkpoint() {
+    if (checkpointState == CHECKPOINT_IN_FLIGHT) {
+        if (checkpointFrame >= 0) {
+            VK_CHECK(vkWaitForFences(device.device, 1, &in_flight_fences[checkpointFrame], true, UINT64_MAX));
+        } else {
+            VkSemaphoreWaitInfo waitInfo = {};
+            waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            waitInfo.semaphoreCount = 1;
+            waitInfo.pSemaphores = &sim_timeline;
+            waitInfo.pValues = &checkpointTimeline;
+            VK_CHECK(vkWaitSemaphores(device.device, &waitInfo, UINT64_MAX));
+        }
+        poll_checkpoint();
+    }
+    if (checkpointState == CHECKPOINT_WRITING) {
+        checkpointWrite.wait();
+        poll_checkpoint();
+    }
+}
+
+// --export-every: a small ring of host-cached readback buffers. Copies are
+// recorded into the step's own command buffer, so exporting never waits on
+// the GPU; encoding and file writes happen on the exporter's threads.
+void LivingWorlds::init_export() {
+    if (config.exportEvery <= 0) return;
+    std::filesystem::create_directories(config.exportDir);
+    
+    VkDeviceSize texels = static_cast<VkDeviceSize>(simWidth) * simHeight;
+    VkDeviceSize heightBytes = texels * (config.heightFormat == VK_FORMAT_R16_UNORM ? 2 : 4);
+    for (ExportSlot& slot : export_slots) {
+        create_buffer(heightBytes + texels, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU,
+                      slot.buffer, slot.allocation);
+        track_vram("Export ring", slot.allocation);
+        void* mapped;
+        vmaMapMemory(allocator, slot.allocation, &mapped);
+        slot.mapped = static_cast<uint8_t*>(mapped);
+    }
+    
+    unsigned threads = std::max(2u, std::thread::hardware_concurrency() / 2);
+    exporter.start(config.exportDir, config.exportRaw ? StateExporter::Format::Raw : StateExporter::Format::Png, threads);
+    lastExportStep = simStep;
+    std::cout << "Export: every " << config.exportEvery << " steps to " << config.exportDir
+              << (config.exportRaw ? " (raw" : " (png") << ", " << threads << " threads)\n";
+}
+
+// Appends the readback for the batch just recorded, if one is due. With every
+// slot still in flight or encoding the export is deferred to the next batch
+// rather than stalling the frame.
+void LivingWorlds::record_export(VkCommandBuffer cmd, int frame) {
+    if (config.exportEvery <= 0) return;
+    if (simStep - lastExportStep < static_cast<uint32_t>(config.exportEvery)) return;
+    
+    ExportSlot* slot = nullptr;
+    for (ExportSlot& s : export_slots) {
+        if (s.state.load() == EXPORT_FREE) { slot = &s; break; }
+    }
+    if (!slot) {
+        exportsDeferred++;
+        return;
+    }
+    
+    // Latest height and the biome the last CA step derived from it
+    size_t cur = current_heightmap_index;
+    VkDeviceSize heightBytes = static_cast<VkDeviceSize>(simWidth) * simHeight *
+                               (config.heightFormat == VK_FORMAT_R16_UNORM ? 2 : 4);
+    frame_graph.add_pass("export", VK_PIPELINE_STAGE_TRANSFER_BIT, {fg_height[cur], fg_biome[1 - cur]}, {},
+                         [this, cur, slot, heightBytes](VkCommandBuffer c) {
+        VkBufferImageCopy region = {};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {simWidth, simHeight, 1};
+        vkCmdCopyImageToBuffer(c, heightmap_images[cur], VK_IMAGE_LAYOUT_GENERAL, slot->buffer, 1, &region);
+        region.bufferOffset = heightBytes;
+        vkCmdCopyImageToBuffer(c, biome_images[1 - cur], VK_IMAGE_LAYOUT_GENERAL, slot->buffer, 1, &region);
+        
+        // Readback -> host read after the fence/timeline (outside the graph)
+        VkMemoryBarrier hostBar = {};
+        hostBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        hostBar.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        hostBar.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(c, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 1, &hostBar, 0, nullptr, 0, nullptr);
+    });
+    frame_graph.execute(cmd);
+    
+    slot->frame = frame;
+    slot->timelineValue = sim_timeline_value + 1; // Signalled by the submit that follows
+    slot->step = simStep;
+    slot->state = EXPORT_IN_FLIGHT;
+    lastExportStep = simStep;
+}
+
+// Hands completed readbacks to the exporter. Called right after a fence wait
+// (before the reset), so a slot's fence is never observed mid-reuse.
+void LivingWorlds::poll_exports() {
+    if (config.exportEvery <= 0) return;
+    
+    uint64_t simCompleted = 0;
+    if (config.asyncCompute) vkGetSemaphoreCounterValue(device.device, sim_timeline, &simCompleted);
+    
+    for (ExportSlot& slot : export_slots) {
+        if (slot.state.load() != EXPORT_IN_FLIGHT) continue;
+        bool complete = slot.frame >= 0
+            ? vkGetFenceStatus(device.device, in_flight_fences[slot.frame]) == VK_SUCCESS
+            : simCompleted >= slot.timelineValue;
+        if (!complete) continue;
+        
+        vmaInvalidateAllocation(allocator, slot.allocation, 0, VK_WHOLE_SIZE);
+        StateExporter::Frame frame;
+        frame.heightData = slot.mapped;
+        frame.biomeData = slot.mapped + static_cast<size_t>(simWidth) * simHeight * height_bytes_per_texel(height_encoding());
+        frame.heightEncoding = height_encoding();
+        frame.width = simWidth;
+        frame.height = simHeight;
+        frame.step = slot.step;
+        slot.state = EXPORT_ENCODING;
+        ExportSlot* done = &slot;
+        exporter.submit(frame, [done] { done->state = EXPORT_FREE; });
+        exportsQueued++;
+    }
+}
+
+// Device must be idle: flushes the last readbacks, then waits for the writers
+void LivingWorlds::shutdown_export() {
+    if (config.exportEvery <= 0) return;
+    poll_exports();
+    exporter.shutdown();
+    for (ExportSlot& slot : export_slots) {
+        if (!slot.buffer) continue;
+        vmaUnmapMemory(allocator, slot.allocation);
+        vmaDestroyBuffer(allocator, slot.buffer, slot.allocation);
+        slot.buffer = VK_NULL_HANDLE;
+    }
+    if (exportsQueued > 0) {
+        std::cout << "Export: " << exportsQueued << " frames written to " << config.exportDir;
+        if (exportsDeferred > 0) std::cout << " (" << exportsDeferred << " batches deferred, ring full)";
+        std::cout << "\n";
+    }
+}
+
+HeightEncoding LivingWorlds::height_encoding() const {
+    switch (config.heightFormat) {
+        case VK_FORMAT_R16_UNORM:  return HeightEncoding::R16;
+        case VK_FORMAT_R32_SFLOAT: return HeightEncoding::R32F;
+        default:                   return HeightEncoding::RGBA8;
+    }
+}
+
+void LivingWorlds::init_picking() {
+    VkDeviceSize size = static_cast<VkDeviceSize>(simWidth) * simHeight * height_bytes_per_texel(height_encoding());
+    create_buffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU,
+                  pick_readback_buffer, pick_readback_allocation);
+    track_vram("Picking readback", pick_readback_allocation);
+    void* mapped;
+    vmaMapMemory(allocator, pick_readback_allocation, &mapped);
+    pick_readback_mapped = static_cast<uint8_t*>(mapped);
+    pickRefreshDue = true;
+}
+
+// Appends a copy of the rendered height (H[current]) when the pyramid is
+// stale and the previous refresh has finished building
+void LivingWorlds::record_pick_refresh(VkCommandBuffer cmd, int frame) {
+    if (!pick_readback_buffer || pickReadbackState != PICK_IDLE) return;
+    if (!pickRefreshDue && simStep - lastPickRefreshStep < static_cast<uint32_t>(std::max(config.pickRefreshSteps, 1))) return;
+    
+    size_t cur = current_heightmap_index;
+    frame_graph.add_pass("pick readback", VK_PIPELINE_STAGE_TRANSFER_BIT, {fg_height[cur]}, {},
+                         [this, cur](VkCommandBuffer c) {
+        VkBufferImageCopy region = {};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {simWidth, simHeight, 1};
+        vkCmdCopyImageToBuffer(c, heightmap_images[cur], VK_IMAGE_LAYOUT_GENERAL, pick_readback_buffer, 1, &region);
+        
+        VkMemoryBarrier hostBar = {};
+        hostBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        hostBar.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        hostBar.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(c, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 1, &hostBar, 0, nullptr, 0, nullptr);
+    });
+    frame_graph.execute(cmd);
+    
+    pickReadbackFrame = frame;
+    pickReadbackTimeline = sim_timeline_value + 1; // Signalled by the submit that follows
+    pickReadbackState = PICK_IN_FLIGHT;
+    pickRefreshDue = false;
+    lastPickRefreshStep = simStep;
+}
+
+// Starts the pyramid build once the copy landed, and swaps in a finished
+// build. Never waits: a pick just uses the previous pyramid until then.
+void LivingWorlds::poll_pick_refresh() {
+    if (pickReadbackState == PICK_IN_FLIGHT) {
+        bool complete;
+        if (pickReadbackFrame >= 0) {
+            complete = vkGetFenceStatus(device.device, in_flight_fences[pickReadbackFrame]) == VK_SUCCESS;
+        } else {
+            uint64_t simCompleted = 0;
+            vkGetSemaphoreCounterValue(device.device, sim_timeline, &simCompleted);
+            complete = simCompleted >= pickReadbackTimeline;
+        }
+        if (complete) {
+            vmaInvalidateAllocation(allocator, pick_readback_allocation, 0, VK_WHOLE_SIZE);
+            const uint8_t* texels = pick_readback_mapped;
+            HeightEncoding encoding = height_encoding();
+            uint32_t width = simWidth, height = simHeight;
+            pickBuild = std::async(std::launch::async, [texels, encoding, width, height] {
+                auto pyramid = std::make_shared<HeightPyramid>();
+                pyramid->build(texels, encoding, width, height);
+                return std::shared_ptr<const HeightPyramid>(std::move(pyramid));
+            });
+            pickReadbackState = PICK_BUILDING;
+        }
+    }
+    if (pickReadbackState == PICK_BUILDING &&
+        pickBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        pickPyramid = pickBuild.get();
+        pickReadbackState = PICK_IDLE;
+    }
+}
+
 // =================================================================================================
 // Week 5: 2.5D Rendering Resources
 // =================================================================================================
@@ -1735,16 +4532,49 @@ void LivingWorlds::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, Vm
     bufferInfo.usage = usage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-    VmaAllocationCreateInfo allocInfo = {};
-    allocInfo.usage = memoryUsage;
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = memoryUsage;
+
+    if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create buffer!");
+    }
+}
+
+void LivingWorlds::copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+    // Single time command buffer
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = command_pool;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    vkAllocateCommandBuffers(device.device, &allocInfo, &commandBuffer);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    VkBufferCopy copyRegion = {};
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
 
-    if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, nullptr) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create buffer!");
-    }
+    vkQueueSubmit(graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(graphics_queue);
+    
+    vkFreeCommandBuffers(device.device, command_pool, 1, &commandBuffer);
 }
 
-void LivingWorlds::copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-    // Single time command buffer
+VkCommandBuffer LivingWorlds::begin_one_shot_commands() {
     VkCommandBufferAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -1757,13 +4587,12 @@ void LivingWorlds::copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceS
     VkCommandBufferBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
     vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    return commandBuffer;
+}
 
-    VkBufferCopy copyRegion = {};
-    copyRegion.size = size;
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
+// Ends, submits on the graphics queue and waits
+void LivingWorlds::submit_one_shot_commands(VkCommandBuffer commandBuffer) {
     vkEndCommandBuffer(commandBuffer);
 
     VkSubmitInfo submitInfo = {};
@@ -1771,7 +4600,7 @@ void LivingWorlds::copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceS
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
+    VK_CHECK(vkQueueSubmit(graphics_queue, 1, &submitInfo, VK_NULL_HANDLE));
     vkQueueWaitIdle(graphics_queue);
     
     vkFreeCommandBuffers(device.device, command_pool, 1, &commandBuffer);
@@ -1802,7 +4631,7 @@ void LivingWorlds::transition_image_layout(VkImage image, VkFormat format, VkIma
     barrier.image = image;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS; // Height pyramid has a chain
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
 
@@ -1841,39 +4670,23 @@ void LivingWorlds::transition_image_layout(VkImage image, VkFormat format, VkIma
     vkFreeCommandBuffers(device.device, command_pool, 1, &commandBuffer);
 }
 
-void LivingWorlds::create_grid_mesh() {
-    // Grid size matches texture size for 1:1 mapping
-    // But for performance, maybe subsample? 
-    // Let's try 1:1 first (1024x1024 = 1M verts, 2M tris). Modern GPUs can handle it.
-    // Actually, to be safe, let's just do 512x512 first.
-    int gridW = simWidth;
-    int gridH = simHeight;
-    
-    // Optimization: Depending on FPS, we might want to scale down.
-    // Vertices
-    vertices.resize(gridW * gridH);
-    for (int y = 0; y < gridH; y++) {
-        for (int x = 0; x < gridW; x++) {
-            // Normalized 0..1 coordinates
-            float u = (float)x / (gridW - 1);
-            float v = (float)y / (gridH - 1);
-            // Center at 0,0
-            vertices[y * gridW + x] = Vertex{ {u, v} };
-        }
-    }
+void LivingWorlds::create_patch_index_buffer() {
+    // One PATCH_QUADS^2 patch; every CDLOD node draws an instance of it,
+    // scaled to its level in terrain.vert. Indices are vertex ids in the
+    // (PATCH_QUADS + 1)^2 grid, which the shader turns back into (x, y).
+    const uint32_t quads = TerrainLod::PATCH_QUADS;
+    const uint32_t side = quads + 1;
+    static_assert((TerrainLod::PATCH_QUADS + 1) * (TerrainLod::PATCH_QUADS + 1) <= 65536, "patch must fit 16-bit indices");
     
-    // Indices (Triangle Strip or List)
-    // List is easier for standard pipelines.
-    // (W-1) * (H-1) quads * 6 indices
-    indices.resize((gridW - 1) * (gridH - 1) * 6);
+    std::vector<uint16_t> indices(quads * quads * 6);
     int idx = 0;
-    for (int y = 0; y < gridH - 1; y++) {
-        for (int x = 0; x < gridW - 1; x++) {
+    for (uint32_t y = 0; y < quads; y++) {
+        for (uint32_t x = 0; x < quads; x++) {
             // Quad: TL, BL, BR, TL, BR, TR
-            uint32_t tl = y * gridW + x;
-            uint32_t bl = (y + 1) * gridW + x;
-            uint32_t br = (y + 1) * gridW + (x + 1);
-            uint32_t tr = y * gridW + (x + 1);
+            uint16_t tl = static_cast<uint16_t>(y * side + x);
+            uint16_t bl = static_cast<uint16_t>((y + 1) * side + x);
+            uint16_t br = static_cast<uint16_t>((y + 1) * side + (x + 1));
+            uint16_t tr = static_cast<uint16_t>(y * side + (x + 1));
             
             indices[idx++] = tl;
             indices[idx++] = bl;
@@ -1884,30 +4697,8 @@ void LivingWorlds::create_grid_mesh() {
             indices[idx++] = tr;
         }
     }
+    patchIndexCount = static_cast<uint32_t>(indices.size());
     
-    std::cout << "Generated Grid Mesh: " << vertices.size() << " vertices, " << indices.size() << " indices.\n";
-}
-
-void LivingWorlds::create_vertex_buffer() {
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-    
-    VkBuffer stagingBuffer;
-    VmaAllocation stagingBufferAllocation;
-    create_buffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, stagingBuffer, stagingBufferAllocation);
-    
-    void* data;
-    vmaMapMemory(allocator, stagingBufferAllocation, &data);
-    memcpy(data, vertices.data(), (size_t)bufferSize);
-    vmaUnmapMemory(allocator, stagingBufferAllocation);
-    
-    create_buffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY, vertexBuffer, vertexBufferAllocation);
-    
-    copy_buffer(stagingBuffer, vertexBuffer, bufferSize);
-    
-    vmaDestroyBuffer(allocator, stagingBuffer, stagingBufferAllocation);
-}
-
-void LivingWorlds::create_index_buffer() {
     VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
     
     VkBuffer stagingBuffer;
@@ -1919,9 +4710,10 @@ void LivingWorlds::create_index_buffer() {
     memcpy(data, indices.data(), (size_t)bufferSize);
     vmaUnmapMemory(allocator, stagingBufferAllocation);
     
-    create_buffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY, indexBuffer, indexBufferAllocation);
+    create_buffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY, patchIndexBuffer, patchIndexAllocation);
+    track_vram("Terrain patch", patchIndexAllocation);
     
-    copy_buffer(stagingBuffer, indexBuffer, bufferSize);
+    copy_buffer(stagingBuffer, patchIndexBuffer, bufferSize);
     
     vmaDestroyBuffer(allocator, stagingBuffer, stagingBufferAllocation);
 }
@@ -1939,6 +4731,43 @@ void LivingWorlds::create_uniform_buffers() {
     }
 }
 
+void LivingWorlds::create_terrain_patch_buffers() {
+    VkDeviceSize bufferSize = sizeof(TerrainPatch) * MAX_TERRAIN_PATCHES;
+    
+    terrainPatchBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    terrainPatchAllocations.resize(MAX_FRAMES_IN_FLIGHT);
+    terrainPatchMapped.resize(MAX_FRAMES_IN_FLIGHT);
+    terrainPatches.reserve(MAX_TERRAIN_PATCHES);
+    
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        create_buffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, terrainPatchBuffers[i], terrainPatchAllocations[i]);
+        track_vram("Terrain patches", terrainPatchAllocations[i]);
+        vmaMapMemory(allocator, terrainPatchAllocations[i], &terrainPatchMapped[i]);
+    }
+    
+    // Culling output: what the terrain pass actually draws
+    visiblePatchBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    visiblePatchAllocations.resize(MAX_FRAMES_IN_FLIGHT);
+    terrainDrawArgsBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    terrainDrawArgsAllocations.resize(MAX_FRAMES_IN_FLIGHT);
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        create_buffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY, visiblePatchBuffers[i], visiblePatchAllocations[i]);
+        track_vram("Terrain patches", visiblePatchAllocations[i]);
+        create_buffer(sizeof(VkDrawIndexedIndirectCommand),
+                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                      VMA_MEMORY_USAGE_GPU_ONLY, terrainDrawArgsBuffers[i], terrainDrawArgsAllocations[i]);
+        track_vram("Terrain patches", terrainDrawArgsAllocations[i]);
+    }
+}
+
+// CDLOD selection for this frame's camera (needs update_uniform_buffer first,
+// which moves the isometric camera)
+void LivingWorlds::select_terrain_patches(uint32_t currentImage) {
+    terrainLod.configure(simWidth, glm::radians(45.0f), swapchain.extent.height, config.lodPixelError);
+    terrainLod.select(camera.position, terrainPatches, MAX_TERRAIN_PATCHES);
+    memcpy(terrainPatchMapped[currentImage], terrainPatches.data(), terrainPatches.size() * sizeof(TerrainPatch));
+}
+
 void LivingWorlds::update_uniform_buffer(uint32_t currentImage) {
     static auto startTime = std::chrono::high_resolution_clock::now();
     
@@ -2010,6 +4839,7 @@ void LivingWorlds::create_depth_resources() {
     allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
     
     vmaCreateImage(allocator, &imageInfo, &allocInfo, &depthImage, &depthImageAllocation, nullptr);
+    track_vram("Depth buffer", depthImageAllocation);
     
     VkImageViewCreateInfo viewInfo = {};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -2031,28 +4861,36 @@ void LivingWorlds::create_depth_resources() {
 
 void LivingWorlds::create_ubo_descriptors() {
     // 1. Layout
-    VkDescriptorSetLayoutBinding uboLayoutBinding{};
-    uboLayoutBinding.binding = 0;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    VkDescriptorSetLayoutBinding uboLayoutBindings[2] = {};
+    uboLayoutBindings[0].binding = 0;
+    uboLayoutBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uboLayoutBindings[0].descriptorCount = 1;
+    uboLayoutBindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    
+    // Terrain patches that survived culling (CDLOD instances)
+    uboLayoutBindings[1].binding = 1;
+    uboLayoutBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    uboLayoutBindings[1].descriptorCount = 1;
+    uboLayoutBindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = 1;
-    layoutInfo.pBindings = &uboLayoutBinding;
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = uboLayoutBindings;
 
     VK_CHECK(vkCreateDescriptorSetLayout(device.device, &layoutInfo, nullptr, &ubo_descriptor_layout));
 
     // 2. Pool
-    VkDescriptorPoolSize poolSize{};
-    poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSize.descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    VkDescriptorPoolSize poolSizes[2] = {};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = 1;
-    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes = poolSizes;
     poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
 
     VK_CHECK(vkCreateDescriptorPool(device.device, &poolInfo, nullptr, &ubo_descriptor_pool));
@@ -2075,16 +4913,29 @@ void LivingWorlds::create_ubo_descriptors() {
         bufferInfo.offset = 0;
         bufferInfo.range = sizeof(UniformBufferObject);
 
-        VkWriteDescriptorSet descriptorWrite{};
-        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = ubo_descriptor_sets[i];
-        descriptorWrite.dstBinding = 0;
-        descriptorWrite.dstArrayElement = 0;
-        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        descriptorWrite.descriptorCount = 1;
-        descriptorWrite.pBufferInfo = &bufferInfo;
-
-        vkUpdateDescriptorSets(device.device, 1, &descriptorWrite, 0, nullptr);
+        VkDescriptorBufferInfo patchInfo{};
+        patchInfo.buffer = visiblePatchBuffers[i];
+        patchInfo.offset = 0;
+        patchInfo.range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet descriptorWrites[2] = {};
+        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet = ubo_descriptor_sets[i];
+        descriptorWrites[0].dstBinding = 0;
+        descriptorWrites[0].dstArrayElement = 0;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pBufferInfo = &bufferInfo;
+
+        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet = ubo_descriptor_sets[i];
+        descriptorWrites[1].dstBinding = 1;
+        descriptorWrites[1].dstArrayElement = 0;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pBufferInfo = &patchInfo;
+
+        vkUpdateDescriptorSets(device.device, 2, descriptorWrites, 0, nullptr);
     }
 }
 
@@ -2110,32 +4961,38 @@ void LivingWorlds::create_texture_descriptors() {
 
     VK_CHECK(vkCreateSampler(device.device, &samplerInfo, nullptr, &textureSampler));
 
-    // 2. Layout - Only Height (0) and Biome (1)
-    VkDescriptorSetLayoutBinding bindings[2] = {};
+    // 2. Layout - Height (0), Biome (1) and the height pyramid (2)
+    VkDescriptorSetLayoutBinding bindings[3] = {};
     
-    // Height
+    // Height (also read by terrain_cull.comp)
     bindings[0].binding = 0;
     bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     bindings[0].descriptorCount = 1;
-    bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
     
     // Biome (R8_UINT)
     bindings[1].binding = 1;
     bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     bindings[1].descriptorCount = 1;
     bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    
+    // Height pyramid (RGBA16_UINT min/max/mean, every level)
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
 
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = 2;
+    layoutInfo.bindingCount = 3;
     layoutInfo.pBindings = bindings;
 
     VK_CHECK(vkCreateDescriptorSetLayout(device.device, &layoutInfo, nullptr, &texture_descriptor_layout));
 
-    // 3. Pool (2 bindings * 2 sets = 4)
+    // 3. Pool (3 bindings * 2 sets = 6)
     VkDescriptorPoolSize poolSizes[1];
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[0].descriptorCount = 4;
+    poolSizes[0].descriptorCount = 6;
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -2156,19 +5013,25 @@ void LivingWorlds::create_texture_descriptors() {
     texture_descriptor_sets.resize(2);
     VK_CHECK(vkAllocateDescriptorSets(device.device, &allocInfo, texture_descriptor_sets.data()));
 
-    // 5. Update Sets
+    // 5. Update Sets (async compute samples the display copies instead)
     for (int i = 0; i < 2; i++) {
         VkDescriptorImageInfo heightInfo{};
         heightInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-        heightInfo.imageView = heightmap_views[i];
+        heightInfo.imageView = asyncCompute ? display_height_views[i] : heightmap_views[i];
         heightInfo.sampler = textureSampler;
         
         VkDescriptorImageInfo biomeInfo{};
         biomeInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-        biomeInfo.imageView = biome_views[i];
+        biomeInfo.imageView = asyncCompute ? display_biome_views[i] : biome_views[i];
         biomeInfo.sampler = textureSampler;
         
-        VkWriteDescriptorSet writes[2] = {};
+        // One pyramid, rebuilt from whichever set is drawn
+        VkDescriptorImageInfo pyramidInfo{};
+        pyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        pyramidInfo.imageView = height_pyramid_view;
+        pyramidInfo.sampler = textureSampler;
+        
+        VkWriteDescriptorSet writes[3] = {};
         
         // Height (Binding 0)
         writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -2186,7 +5049,15 @@ void LivingWorlds::create_texture_descriptors() {
         writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         writes[1].pImageInfo = &biomeInfo;
         
-        vkUpdateDescriptorSets(device.device, 2, writes, 0, nullptr);
+        // Height pyramid (Binding 2)
+        writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[2].dstSet = texture_descriptor_sets[i];
+        writes[2].dstBinding = 2;
+        writes[2].descriptorCount = 1;
+        writes[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[2].pImageInfo = &pyramidInfo;
+        
+        vkUpdateDescriptorSets(device.device, 3, writes, 0, nullptr);
     }
 }
 
@@ -2201,21 +5072,19 @@ void LivingWorlds::init_terrain_pipeline() {
         abort();
     }
     
+    // PATCH_QUADS (constant 0): the vertex shader unpacks gl_VertexIndex with it
+    uint32_t patchQuads = TerrainLod::PATCH_QUADS;
+    VkSpecializationMapEntry patchSpecEntry{0, 0, sizeof(uint32_t)};
+    VkSpecializationInfo patchSpecInfo{1, &patchSpecEntry, sizeof(uint32_t), &patchQuads};
+    
     VkPipelineShaderStageCreateInfo shaderStages[] = {
-        { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vertShader, "main", nullptr },
+        { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vertShader, "main", &patchSpecInfo },
         { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragShader, "main", nullptr }
     };
     
-    // Vertex Input
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
-    
+    // Vertex Input: none, positions are pulled from gl_VertexIndex/gl_InstanceIndex
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
     
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -2306,6 +5175,343 @@ void LivingWorlds::init_terrain_pipeline() {
     vkDestroyShaderModule(device.device, fragShader, nullptr);
 }
 
+void LivingWorlds::init_terrain_cull() {
+    // Set 0: UBO (frustum), selected patches, visible patches, draw args
+    VkDescriptorSetLayoutBinding bindings[4] = {};
+    for (uint32_t b = 0; b < 4; b++) {
+        bindings[b].binding = b;
+        bindings[b].descriptorType = b == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[b].descriptorCount = 1;
+        bindings[b].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 4;
+    layoutInfo.pBindings = bindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(device.device, &layoutInfo, nullptr, &terrain_cull_layout));
+    
+    VkDescriptorPoolSize poolSizes[2] = {};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * 3;
+    
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes = poolSizes;
+    poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    VK_CHECK(vkCreateDescriptorPool(device.device, &poolInfo, nullptr, &terrain_cull_pool));
+    
+    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, terrain_cull_layout);
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = terrain_cull_pool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    allocInfo.pSetLayouts = layouts.data();
+    terrain_cull_sets.resize(MAX_FRAMES_IN_FLIGHT);
+    VK_CHECK(vkAllocateDescriptorSets(device.device, &allocInfo, terrain_cull_sets.data()));
+    
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        VkDescriptorBufferInfo bufferInfos[4] = {
+            {uniformBuffers[i], 0, sizeof(UniformBufferObject)},
+            {terrainPatchBuffers[i], 0, VK_WHOLE_SIZE},
+            {visiblePatchBuffers[i], 0, VK_WHOLE_SIZE},
+            {terrainDrawArgsBuffers[i], 0, VK_WHOLE_SIZE},
+        };
+        VkWriteDescriptorSet writes[4] = {};
+        for (uint32_t b = 0; b < 4; b++) {
+            writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[b].dstSet = terrain_cull_sets[i];
+            writes[b].dstBinding = b;
+            writes[b].descriptorCount = 1;
+            writes[b].descriptorType = bindings[b].descriptorType;
+            writes[b].pBufferInfo = &bufferInfos[b];
+        }
+        vkUpdateDescriptorSets(device.device, 4, writes, 0, nullptr);
+    }
+    
+    // Set 1: the terrain pass's textures, so culling sees the heights it draws
+    VkDescriptorSetLayout setLayouts[2] = {terrain_cull_layout, texture_descriptor_layout};
+    
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(uint32_t);
+    
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 2;
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK(vkCreatePipelineLayout(device.device, &pipelineLayoutInfo, nullptr, &terrain_cull_pipeline_layout));
+    
+    VkShaderModule cullShader;
+    if (!load_shader_module("shaders/terrain_cull.comp.spv", &cullShader)) {
+        std::cerr << "Failed to load terrain_cull.comp.spv\n";
+        abort();
+    }
+    
+    // PATCH_QUADS (constant 0), as in terrain.vert
+    uint32_t patchQuads = TerrainLod::PATCH_QUADS;
+    VkSpecializationMapEntry patchSpecEntry{0, 0, sizeof(uint32_t)};
+    VkSpecializationInfo patchSpecInfo{1, &patchSpecEntry, sizeof(uint32_t), &patchQuads};
+    
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = cullShader;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.stage.pSpecializationInfo = &patchSpecInfo;
+    pipelineInfo.layout = terrain_cull_pipeline_layout;
+    VK_CHECK(vkCreateComputePipelines(device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &terrain_cull_pipeline));
+    
+    vkDestroyShaderModule(device.device, cullShader, nullptr);
+}
+
+// Frustum-culls this frame's selected patches into the visible list and
+// instance count the terrain pass draws indirectly. Bounds come from the
+// height pyramid, refreshed from the texture the terrain pass draws.
+void LivingWorlds::record_terrain_cull(VkCommandBuffer cmd, uint32_t currentImage, size_t textureSet) {
+    uint32_t patchCount = static_cast<uint32_t>(terrainPatches.size());
+    auto record = [this, currentImage, textureSet, patchCount](VkCommandBuffer c) {
+        VkDrawIndexedIndirectCommand reset = {patchIndexCount, 0, 0, 0, 0};
+        vkCmdUpdateBuffer(c, terrainDrawArgsBuffers[currentImage], 0, sizeof(reset), &reset);
+        
+        VkMemoryBarrier resetBar = {};
+        resetBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        resetBar.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        resetBar.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(c, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &resetBar, 0, nullptr, 0, nullptr);
+        
+        vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, terrain_cull_pipeline);
+        vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, terrain_cull_pipeline_layout, 0, 1, &terrain_cull_sets[currentImage], 0, nullptr);
+        vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, terrain_cull_pipeline_layout, 1, 1, &texture_descriptor_sets[textureSet], 0, nullptr);
+        vkCmdPushConstants(c, terrain_cull_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &patchCount);
+        if (patchCount > 0) vkCmdDispatch(c, (patchCount + 63) / 64, 1, 1);
+        
+        // Visible list + args -> indirect draw and vertex pulling
+        VkMemoryBarrier drawBar = {};
+        drawBar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        drawBar.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        drawBar.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(c, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                             0, 1, &drawBar, 0, nullptr, 0, nullptr);
+    };
+    
+    frame_graph.add_pass("terrain cull", VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {fg_height_pyramid}, {}, record);
+}
+
+// Level 0 is the heightmap reduced 2x2, padded to whole 64x64-texel tiles
+// so every tile owns its cells down to level 5; the chain runs to 1x1
+void LivingWorlds::create_height_pyramid() {
+    uint32_t tilesX = (simWidth + PYRAMID_TILE - 1) / PYRAMID_TILE;
+    uint32_t tilesY = (simHeight + PYRAMID_TILE - 1) / PYRAMID_TILE;
+    VkExtent3D extent = {tilesX * PYRAMID_TILE / 2, tilesY * PYRAMID_TILE / 2, 1};
+    heightPyramidLevels = 1;
+    while ((std::max(extent.width, extent.height) >> heightPyramidLevels) > 0) heightPyramidLevels++;
+    heightPyramidLevels = std::min(heightPyramidLevels, MAX_PYRAMID_LEVELS);
+    
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent = extent;
+    imageInfo.mipLevels = heightPyramidLevels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = VK_FORMAT_R16G16B16A16_UINT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // Graphics queue only, async or not
+    
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    VK_CHECK(vmaCreateImage(allocator, &imageInfo, &allocInfo, &height_pyramid_image, &height_pyramid_allocation, nullptr));
+    track_vram("Height pyramid", height_pyramid_allocation);
+    
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = height_pyramid_image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R16G16B16A16_UINT;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = heightPyramidLevels;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+    VK_CHECK(vkCreateImageView(device.device, &viewInfo, nullptr, &height_pyramid_view));
+    
+    height_pyramid_level_views.resize(heightPyramidLevels);
+    for (uint32_t level = 0; level < heightPyramidLevels; level++) {
+        viewInfo.subresourceRange.baseMipLevel = level;
+        viewInfo.subresourceRange.levelCount = 1;
+        VK_CHECK(vkCreateImageView(device.device, &viewInfo, nullptr, &height_pyramid_level_views[level]));
+    }
+    transition_image_layout(height_pyramid_image, VK_FORMAT_R16G16B16A16_UINT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+    
+    // Finished-workgroup counter; the shader zeroes it after each refresh
+    create_buffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
+                  height_pyramid_counter_buffer, height_pyramid_counter_allocation);
+    track_vram("Height pyramid", height_pyramid_counter_allocation);
+    void* mapped;
+    vmaMapMemory(allocator, height_pyramid_counter_allocation, &mapped);
+    memset(mapped, 0, sizeof(uint32_t));
+    vmaFlushAllocation(allocator, height_pyramid_counter_allocation, 0, VK_WHOLE_SIZE);
+    vmaUnmapMemory(allocator, height_pyramid_counter_allocation);
+    
+    std::cout << "Height pyramid: " << heightPyramidLevels << " levels from " << extent.width << "x" << extent.height << "\n";
+}
+
+void LivingWorlds::init_height_pyramid_pipeline() {
+    // Set 0: every level as a storage image (unused slots repeat the last
+    // level) + the workgroup counter
+    VkDescriptorSetLayoutBinding bindings[2] = {};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[0].descriptorCount = MAX_PYRAMID_LEVELS;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = bindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(device.device, &layoutInfo, nullptr, &height_pyramid_layout));
+    
+    VkDescriptorPoolSize poolSizes[2] = {};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSizes[0].descriptorCount = MAX_PYRAMID_LEVELS;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = 1;
+    
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes = poolSizes;
+    poolInfo.maxSets = 1;
+    VK_CHECK(vkCreateDescriptorPool(device.device, &poolInfo, nullptr, &height_pyramid_pool));
+    
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = height_pyramid_pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &height_pyramid_layout;
+    VK_CHECK(vkAllocateDescriptorSets(device.device, &allocInfo, &height_pyramid_set));
+    
+    VkDescriptorImageInfo levelInfos[MAX_PYRAMID_LEVELS] = {};
+    for (uint32_t level = 0; level < MAX_PYRAMID_LEVELS; level++) {
+        levelInfos[level].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        levelInfos[level].imageView = height_pyramid_level_views[std::min(level, heightPyramidLevels - 1)];
+    }
+    VkDescriptorBufferInfo counterInfo = {height_pyramid_counter_buffer, 0, VK_WHOLE_SIZE};
+    
+    VkWriteDescriptorSet writes[2] = {};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = height_pyramid_set;
+    writes[0].dstBinding = 0;
+    writes[0].descriptorCount = MAX_PYRAMID_LEVELS;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[0].pImageInfo = levelInfos;
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = height_pyramid_set;
+    writes[1].dstBinding = 1;
+    writes[1].descriptorCount = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[1].pBufferInfo = &counterInfo;
+    vkUpdateDescriptorSets(device.device, 2, writes, 0, nullptr);
+    
+    // Set 1: the terrain pass's textures (source height)
+    VkDescriptorSetLayout setLayouts[2] = {height_pyramid_layout, texture_descriptor_layout};
+    
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(HeightPyramidPushConstants);
+    
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 2;
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK(vkCreatePipelineLayout(device.device, &pipelineLayoutInfo, nullptr, &height_pyramid_pipeline_layout));
+    
+    VkShaderModule pyramidShader;
+    if (!load_shader_module("shaders/height_pyramid.comp.spv", &pyramidShader)) {
+        std::cerr << "Failed to load height_pyramid.comp.spv\n";
+        abort();
+    }
+    
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = pyramidShader;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = height_pyramid_pipeline_layout;
+    VK_CHECK(vkCreateComputePipelines(device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &height_pyramid_pipeline));
+    
+    vkDestroyShaderModule(device.device, pyramidShader, nullptr);
+}
+
+// Texels [x0, x1] x [y0, y1] changed outside a sim step (brush)
+void LivingWorlds::mark_height_pyramid_dirty(int x0, int y0, int x1, int y1) {
+    int* d = heightPyramidDirty;
+    if (d[2] < d[0]) {
+        d[0] = x0; d[1] = y0; d[2] = x1; d[3] = y1;
+    } else {
+        d[0] = std::min(d[0], x0); d[1] = std::min(d[1], y0);
+        d[2] = std::max(d[2], x1); d[3] = std::max(d[3], y1);
+    }
+}
+
+// Refreshes the height pyramid from the texture the terrain pass is about
+// to draw: the whole chain after sim steps, a reset or a new async
+// publication, only the tiles under brush edits otherwise
+void LivingWorlds::record_height_pyramid(VkCommandBuffer cmd, size_t textureSet) {
+    int* d = heightPyramidDirty;
+    int tilesX = static_cast<int>((simWidth + PYRAMID_TILE - 1) / PYRAMID_TILE);
+    int tilesY = static_cast<int>((simHeight + PYRAMID_TILE - 1) / PYRAMID_TILE);
+    int tx0 = 0, ty0 = 0, tx1 = tilesX - 1, ty1 = tilesY - 1;
+    if (!heightPyramidFull) {
+        if (d[2] < d[0]) return;
+        tx0 = d[0] / static_cast<int>(PYRAMID_TILE);
+        ty0 = d[1] / static_cast<int>(PYRAMID_TILE);
+        tx1 = d[2] / static_cast<int>(PYRAMID_TILE);
+        ty1 = d[3] / static_cast<int>(PYRAMID_TILE);
+    }
+    heightPyramidFull = false;
+    d[0] = d[1] = 0;
+    d[2] = d[3] = -1;
+    
+    uint32_t groupsX = static_cast<uint32_t>(tx1 - tx0 + 1);
+    uint32_t groupsY = static_cast<uint32_t>(ty1 - ty0 + 1);
+    HeightPyramidPushConstants pc = {tx0, ty0, groupsX * groupsY, heightPyramidLevels};
+    auto record = [this, textureSet, pc, groupsX, groupsY](VkCommandBuffer c) {
+        VkDescriptorSet sets[2] = {height_pyramid_set, texture_descriptor_sets[textureSet]};
+        vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, height_pyramid_pipeline);
+        vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, height_pyramid_pipeline_layout, 0, 2, sets, 0, nullptr);
+        vkCmdPushConstants(c, height_pyramid_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+        vkCmdDispatch(c, groupsX, groupsY, 1);
+    };
+    
+    // Async mode reads the display copy, ordered by the timeline wait
+    if (asyncCompute) {
+        frame_graph.add_pass("height pyramid", VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {}, {fg_height_pyramid}, record);
+    } else {
+        frame_graph.add_pass("height pyramid", VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {fg_height[textureSet]}, {fg_height_pyramid}, record);
+    }
+}
+
 // =================================================================================================
 // Input Handling
 // =================================================================================================
@@ -2358,12 +5564,20 @@ void LivingWorlds::process_input(float deltaTime) {
             dispatch_biome_init();
             // Run biome CA init once (now clears images first)
             dispatch_biome_ca_init();
-            current_heightmap_index = 0;
+            current_heightmap_index = 1;
+            displayDirty = true;
+            activeTilesForce = true;
+            biomePlanesNeedPack = true;
+            frame_graph.invalidate();
+            wake_simulation();
             simAccumulator = 0.0f; // Reset simulation timer
             
             // Reset biome step counter for seeding
-            static uint32_t simStep = 0;
             simStep = 0;
+            lastExportStep = 0;
+            lastPickRefreshStep = 0;
+            pickRefreshDue = true;
+            heightPyramidFull = true;
         }
     } else {
         resetPressed = false;
@@ -2466,135 +5680,59 @@ void LivingWorlds::process_input(float deltaTime) {
 
 void LivingWorlds::mouse_callback(GLFWwindow* window, double xpos, double ypos) {
     LivingWorlds* app = reinterpret_cast<LivingWorlds*>(glfwGetWindowUserPointer(window));
-    if (app) {
-        app->handle_mouse(xpos, ypos);
+    if (!app) return;
+    // Dragging with the button held paints a stroke
+    if (app->brushHeld && app->showUI && app->camera.isometricMode && app->spawnMode != SPAWN_NONE) {
+        float u, v;
+        if (app->pick_terrain(xpos, ypos, u, v)) app->queue_brush(u, v);
     }
+    app->handle_mouse(xpos, ypos);
+}
+
+// Cursor ray against the CPU height pyramid; false when it misses the
+// terrain or no pyramid has been built yet. No GPU work, so it is cheap
+// enough to run on every cursor move of a drag stroke.
+bool LivingWorlds::pick_terrain(double mouseX, double mouseY, float& u, float& v) {
+    if (!pickPyramid) return false;
+    
+    int winWidth, winHeight;
+    glfwGetWindowSize(window, &winWidth, &winHeight);
+    if (winWidth == 0 || winHeight == 0) return false;
+    
+    // Same matrices as the renderer (no Vulkan Y-flip for unproject)
+    glm::mat4 view = camera.getViewMatrix();
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 
+                                      (float)winWidth / (float)winHeight, 0.1f, 1000.0f);
+    glm::vec4 viewport(0, 0, winWidth, winHeight);
+    glm::vec3 nearPos = glm::unProject(glm::vec3(mouseX, winHeight - mouseY, 0.0f), view, proj, viewport);
+    glm::vec3 farPos = glm::unProject(glm::vec3(mouseX, winHeight - mouseY, 1.0f), view, proj, viewport);
+    
+    // World (terrain spans -0.5..0.5, y = height * scale) -> pyramid texel space
+    const HeightPyramid& pyramid = *pickPyramid;
+    auto toPyramid = [&](const glm::vec3& p) {
+        return glm::vec3((p.x + 0.5f) * pyramid.width(), p.y / TERRAIN_HEIGHT_SCALE, (p.z + 0.5f) * pyramid.height());
+    };
+    glm::vec3 origin = toPyramid(nearPos);
+    glm::vec3 dir = toPyramid(farPos) - origin;
+    return pyramid.raycast(origin, dir, u, v);
 }
 
 void LivingWorlds::mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
     LivingWorlds* app = reinterpret_cast<LivingWorlds*>(glfwGetWindowUserPointer(window));
     if (!app) return;
+    if (button != GLFW_MOUSE_BUTTON_LEFT) return;
+    if (action == GLFW_RELEASE) {
+        app->brushHeld = false;
+        return;
+    }
     
     // Only handle left click when UI is visible and in isometric mode
-    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && 
-        app->showUI && app->camera.isometricMode && app->spawnMode != SPAWN_NONE) {
-        
+    if (action == GLFW_PRESS && app->showUI && app->camera.isometricMode && app->spawnMode != SPAWN_NONE) {
         double mouseX, mouseY;
         glfwGetCursorPos(window, &mouseX, &mouseY);
-        
-        // Get window size
-        int winWidth, winHeight;
-        glfwGetWindowSize(window, &winWidth, &winHeight);
-        
-        // Get view and projection matrices (no Vulkan Y-flip for unproject)
-        glm::mat4 view = app->camera.getViewMatrix();
-        glm::mat4 proj = glm::perspective(glm::radians(45.0f), 
-                                          (float)winWidth / (float)winHeight, 0.1f, 1000.0f);
-        
-        glm::vec4 viewport(0, 0, winWidth, winHeight);
-        
-        // Read depth buffer at mouse position for exact 3D intersection
-        int px = static_cast<int>(mouseX);
-        int py = static_cast<int>(mouseY);
-        px = glm::clamp(px, 0, winWidth - 1);
-        py = glm::clamp(py, 0, winHeight - 1);
-        
-        // Create staging buffer to read depth value (D32_SFLOAT = 4 bytes)
-        VkBuffer readBuffer;
-        VmaAllocation readAlloc;
-        VkDeviceSize bufSize = 4;
-        
-        VkBufferCreateInfo bufInfo = {};
-        bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufInfo.size = bufSize;
-        bufInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-        
-        VmaAllocationCreateInfo allocInfo = {};
-        allocInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
-        vmaCreateBuffer(app->allocator, &bufInfo, &allocInfo, &readBuffer, &readAlloc, nullptr);
-        
-        // One-shot command buffer to copy depth pixel
-        VkCommandBufferAllocateInfo cmdAllocInfo = {};
-        cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        cmdAllocInfo.commandPool = app->command_pool;
-        cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        cmdAllocInfo.commandBufferCount = 1;
-        
-        VkCommandBuffer readCmd;
-        vkAllocateCommandBuffers(app->device.device, &cmdAllocInfo, &readCmd);
-        
-        VkCommandBufferBeginInfo beginInfo = {};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-        vkBeginCommandBuffer(readCmd, &beginInfo);
-        
-        // Transition depth image to TRANSFER_SRC
-        VkImageMemoryBarrier barrier = {};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = app->depthImage;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        
-        vkCmdPipelineBarrier(readCmd, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, 
-                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-        
-        VkBufferImageCopy region = {};
-        region.bufferOffset = 0;
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        region.imageSubresource.layerCount = 1;
-        region.imageOffset = {px, py, 0};
-        region.imageExtent = {1, 1, 1};
-        
-        vkCmdCopyImageToBuffer(readCmd, app->depthImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 
-                               readBuffer, 1, &region);
-        
-        // Transition back
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-        
-        vkCmdPipelineBarrier(readCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, 
-                             VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-        
-        vkEndCommandBuffer(readCmd);
-        
-        VkSubmitInfo submitInfo = {};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &readCmd;
-        
-        vkQueueSubmit(app->graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(app->graphics_queue);
-        
-        // Read the depth value
-        float* depthData;
-        vmaMapMemory(app->allocator, readAlloc, (void**)&depthData);
-        float depthValue = *depthData;
-        vmaUnmapMemory(app->allocator, readAlloc);
-        
-        vkFreeCommandBuffers(app->device.device, app->command_pool, 1, &readCmd);
-        vmaDestroyBuffer(app->allocator, readBuffer, readAlloc);
-        
-        // Unproject with exact depth to get world position
-        glm::vec3 worldPos = glm::unProject(glm::vec3(mouseX, winHeight - mouseY, depthValue), 
-                                             view, proj, viewport);
-        
-        // Convert world XZ to terrain UV (terrain spans -0.5 to 0.5)
-        float terrainU = glm::clamp(worldPos.x + 0.5f, 0.0f, 1.0f);
-        float terrainV = glm::clamp(worldPos.z + 0.5f, 0.0f, 1.0f);
-        
-        // Set pending click for processing in draw loop
-        app->pendingClick = true;
-        app->clickU = terrainU;
-        app->clickV = terrainV;
+        float u, v;
+        if (app->pick_terrain(mouseX, mouseY, u, v)) app->queue_brush(u, v);
+        app->brushHeld = true;
     }
 }
 
@@ -2724,6 +5862,52 @@ void LivingWorlds::render_ui() {
             if (ImGui::SliderFloat("Updates/sec", &speedMultiplier, 0.5f, 1000.0f, "%.1f", ImGuiSliderFlags_Logarithmic)) {
                 simInterval = 1.0f / speedMultiplier;
             }
+            ImGui::SliderInt("Max Steps/Frame", &config.maxStepsPerFrame, 1, MAX_STEPS_PER_FRAME_LIMIT);
+            ImGui::Text("Steps/sec: %.0f (%d this frame)", stepsPerSecond, lastFrameSteps);
+            ImGui::Text("Barriers: %u this frame", lastFrameBarriers);
+            if (ImGui::TreeNode("GPU Time per Frame")) {
+                if (gpuProfiler.enabled()) {
+                    float totalMs = 0.0f;
+                    for (const GpuProfiler::Stage& stage : gpuProfiler.stages()) {
+                        if (stage.avgMs <= 0.0f) continue; // Stage didn't run last second
+                        ImGui::Text("%-14s %7.3f ms", stage.name, stage.avgMs);
+                        totalMs += stage.avgMs;
+                    }
+                    ImGui::Text("%-14s %7.3f ms", "total", totalMs);
+                } else {
+                    ImGui::TextDisabled("Timestamps not supported on this device");
+                }
+                ImGui::TreePop();
+            }
+            if (config.exportEvery > 0) {
+                ImGui::Text("Exports: %u queued, %u deferred", exportsQueued, exportsDeferred);
+            }
+            ImGui::Text("Async compute: %s", asyncCompute ? "ON" : "OFF");
+            if (fused_pipeline) {
+                ImGui::Checkbox("Fused Erosion + Biome CA", &config.fusedSim);
+            }
+            if (temporal_pipeline) {
+                bool temporal = config.temporalK > 0;
+                if (ImGui::Checkbox("Temporal Blocking", &temporal)) {
+                    config.temporalK = temporal ? temporalK : 0;
+                }
+                ImGui::SameLine();
+                ImGui::Text("(K=%d gens/dispatch)", temporalK);
+            }
+            if (config.bitslicedBiome) {
+                ImGui::Text("Biome state: bit-sliced (4 planes)");
+            }
+            float changedPct = 100.0f * lastStats.changedCells / (static_cast<float>(simWidth) * simHeight);
+            ImGui::Text("Changed cells/step: %u (%.3f%%)", lastStats.changedCells, changedPct);
+            ImGui::Text("Height change/step: %.4f", lastStats.heightDelta() / 65535.0);
+            if (ImGui::Checkbox("Auto Idle", &config.autoIdle) && !config.autoIdle) {
+                wake_simulation();
+            }
+            if (config.autoIdle) {
+                ImGui::SameLine();
+                if (simIdling) ImGui::Text("(idle)");
+                else ImGui::Text("(quiet %u steps)", quietSteps);
+            }
             if (ImGui::Button("Reset Terrain (R)")) {
                 needsReset = true;
             }
@@ -2731,12 +5915,20 @@ void LivingWorlds::render_ui() {
         
         // Click Spawning
         if (ImGui::CollapsingHeader("Click Spawn", ImGuiTreeNodeFlags_DefaultOpen)) {
-            const char* spawnModes[] = { "None", "Forest", "Desert", "Water", "Mountain", "Grass" };
+            const char* spawnModes[] = { "None", "Forest", "Desert", "Water", "Mountain", "Grass", "Raise", "Lower" };
             ImGui::Combo("Spawn Mode", &spawnMode, spawnModes, IM_ARRAYSIZE(spawnModes));
             ImGui::SliderInt("Radius", &spawnRadius, 1, 20);
-            ImGui::TextWrapped("Left-click on terrain to spawn selected biome");
+            ImGui::SliderFloat("Falloff", &brushFalloff, 0.0f, 1.0f);
+            if (spawnMode == SPAWN_RAISE || spawnMode == SPAWN_LOWER) {
+                ImGui::SliderFloat("Strength", &brushStrength, 0.001f, 0.05f, "%.3f", ImGuiSliderFlags_Logarithmic);
+            }
+            ImGui::TextWrapped("Left-click or drag on terrain to paint the selected biome or height");
         }
         
+        // Parameter edits below wake an idle simulation
+        ErosionPushConstants erosionBefore = erosionParams;
+        BiomePushConstants biomeBefore = biomePushConstants;
+        
         // Erosion
         if (ImGui::CollapsingHeader("Erosion", ImGuiTreeNodeFlags_DefaultOpen)) {
             ImGui::SliderFloat("Rate", &erosionParams.rate, 0.1f, 0.99f, "%.2f");
@@ -2778,10 +5970,18 @@ void LivingWorlds::render_ui() {
             ImGui::SliderFloat("Tree Line", &biomePushConstants.treeLineHeight, 0.55f, 0.75f, "%.2f");
         }
         
+        if (memcmp(&erosionBefore, &erosionParams, sizeof(ErosionPushConstants)) != 0 ||
+            memcmp(&biomeBefore, &biomePushConstants, sizeof(BiomePushConstants)) != 0) {
+            wake_simulation();
+        }
+        
         // Visualization
         if (ImGui::CollapsingHeader("Visualization")) {
             const char* modes[] = { "Height", "Biome", "Temperature", "Humidity" };
             ImGui::Combo("Mode", &vizMode, modes, IM_ARRAYSIZE(modes));
+            ImGui::SliderFloat("LOD Error (px)", &config.lodPixelError, 0.5f, 16.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+            size_t terrainTris = terrainPatches.size() * patchIndexCount / 3;
+            ImGui::Text("Terrain: %zu patches, %.2fM tris (before culling)", terrainPatches.size(), terrainTris / 1e6);
         }
         
         ImGui::Separator();
@@ -7,9 +7,21 @@
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_vulkan.h>
+#include "frame_graph.hpp"
+#include "gpu_profiler.hpp"
+#include "frame_timings.hpp"
+#include "snapshot.hpp"
+#include "state_exporter.hpp"
+#include "height_pyramid.hpp"
+#include "terrain_lod.hpp"
+#include "state_hash.hpp"
 #include <vector>
+#include <atomic>
+#include <future>
+#include <memory>
 #include <iostream>
 #include <fstream>
+#include <string>
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
@@ -48,6 +60,44 @@ struct ErosionPushConstants {
     float coastalBonus = 1.5f;   // Extra erosion near water
 };
 
+// Fused erosion + biome CA (sim_fused.comp)
+struct FusedPushConstants {
+    ErosionPushConstants erosion;
+    BiomePushConstants biome;
+};
+static_assert(sizeof(FusedPushConstants) == 72, "must match sim_fused.comp push block");
+
+// Temporal blocking (sim_temporal.comp): several fused generations per dispatch
+struct TemporalPushConstants {
+    FusedPushConstants fused;
+    int generations = 1;
+};
+static_assert(sizeof(TemporalPushConstants) == 76, "must match sim_temporal.comp push block");
+
+// One queued spawn/paint edit (brush.comp, std430)
+struct BrushEvent {
+    float centerX, centerY;  // Texels
+    float radius;            // Texels
+    float falloff;           // 0 = hard edge, 1 = fades all the way from the center
+    int32_t biome;           // Biome id to paint, -1 = leave biomes alone
+    float heightDelta;       // Added to the height at full brush weight
+    float pad[2];
+};
+static_assert(sizeof(BrushEvent) == 32, "must match brush.comp BrushEvent");
+
+// height_pyramid.comp: one workgroup per 64x64-texel tile
+struct HeightPyramidPushConstants {
+    int32_t tileOriginX, tileOriginY;  // First tile of the refresh
+    uint32_t groupCount;               // Tiles dispatched (the last one finishes the chain)
+    uint32_t levels;
+};
+
+struct BrushPushConstants {
+    int32_t originX, originY;  // Top-left texel of the dispatch
+    uint32_t eventOffset;      // First event of this frame's arena region
+    uint32_t eventCount;
+};
+
 // Profiling/Benchmark configuration
 struct ProfileConfig {
     bool benchmarkMode = false;    // Auto-exit after duration
@@ -56,32 +106,40 @@ struct ProfileConfig {
     float simSpeed = 1.0f;         // Simulation multiplier
     bool enableErosion = true;
     bool enableBiomeCA = true;
-};
-
-static constexpr float SEED = 42.0f; // Default Seed
-
-struct Vertex {
-    glm::vec2 pos;
-    // We don't need color or texCoord explicitly for this grid, 
-    // we can calculate UV from pos (0..1 range).
-    // But let's keep it simple: just Pos (X, Z).
-    
-    static VkVertexInputBindingDescription getBindingDescription() {
-        VkVertexInputBindingDescription bindingDescription{};
-        bindingDescription.binding = 0;
-        bindingDescription.stride = sizeof(Vertex);
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-        return bindingDescription;
-    }
-
-    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions() {
-        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(1);
-        attributeDescriptions[0].binding = 0;
-        attributeDescriptions[0].location = 0;
-        attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-        attributeDescriptions[0].offset = offsetof(Vertex, pos);
-        return attributeDescriptions;
-    }
+    bool bidirErosion = false;     // Start with the biome-dependent erosion rates on
+    int maxStepsPerFrame = 64;     // Cap on batched sim steps per frame
+    bool asyncCompute = false;     // Run the simulation on a dedicated compute queue
+    bool headless = false;         // No window/swapchain/ImGui, step as fast as possible
+    int headlessSteps = 1000;      // Steps to run in headless mode
+    bool fusedSim = false;         // Single fused erosion + biome CA dispatch per step
+    bool biomeCADirect = false;    // Baseline biome CA kernel, before the shared tile (reference)
+    int temporalK = 0;             // >0: run up to K fused generations per dispatch
+    bool activeTiles = false;      // Only step tiles that changed (or neighbour a change)
+    bool autoIdle = false;         // Drop to a low tick rate once the world stops changing
+    float idleThreshold = 0.0001f; // Changed-cell fraction per step that counts as quiet
+    int idleSteps = 256;           // Quiet steps before idling
+    VkFormat heightFormat = VK_FORMAT_R16_UNORM;  // R16_UNORM, R32_SFLOAT or R8G8B8A8_UNORM
+    bool bitslicedBiome = false;   // Biome state as 4 bitplanes, 32 cells per CA invocation
+    bool climate = false;          // Temperature/humidity layers + heightmap_viz (unused by the sim)
+    std::string saveStatePath;     // Snapshot written on exit (and every checkpointSteps)
+    std::string loadStatePath;     // Snapshot restored after init
+    int checkpointSteps = 0;       // >0: incremental save every N sim steps
+    bool importHostMemory = false; // Upload snapshots via VK_EXT_external_memory_host
+    int pickRefreshSteps = 16;     // Re-read the picking height pyramid every N sim steps
+    int exportEvery = 0;           // >0: export height/biome every N sim steps
+    std::string exportDir = "exports";
+    bool exportRaw = false;        // Raw 16-bit height + 8-bit biome instead of PNG
+    float lodPixelError = 2.0f;    // Terrain LOD: on-screen size (pixels) of a quad before it splits
+    int frameLogCapacity = 262144; // Benchmark: frames kept in the per-frame timing ring
+    bool cpuBackend = false;       // Simulate on the CPU (CpuSim) instead of Vulkan; always headless
+    int cpuThreads = 0;            // CPU backend worker threads, 0 = one per hardware thread
+    bool checkIsa = false;         // CPU backend: run every vector path and compare them bit for bit
+    float seed = 42.0f;            // Terrain seed for the first world
+    int verifySteps = 0;           // >0: headless, hash the state after every step of N
+    std::string goldenPath;        // --verify: compare the hashes against this golden file
+    std::string writeGoldenPath;   // --verify: record the hashes as a golden file
+    bool verifyReference = false;  // --verify: also step CpuSim from each GPU state and compare
+    float verifyTolerance = 0.0f;  // Cell fraction allowed to differ from the reference per step
 };
 
 struct UniformBufferObject {
@@ -209,16 +267,47 @@ enum class Pattern {
     RPentomino
 };
 
+// LivingWorldsBench: one compute stage timed in isolation
+struct KernelTiming {
+    const char* kernel;
+    double msPerStep;        // GPU timestamps, or wall clock around the submit without them
+    uint64_t bytesPerStep;   // Image bytes each step reads + writes once
+    bool gpuTimer;
+};
+
+struct KernelBenchReport {
+    std::string device;
+    const char* heightFormat;  // After the device fallback
+    std::vector<KernelTiming> kernels;
+};
+
 class LivingWorlds {
 public:
     LivingWorlds() : config() {}
     explicit LivingWorlds(const ProfileConfig& cfg) : config(cfg) {}
-    void run();
+    int run(); // Exit status: non-zero when --verify or --check-isa finds a mismatch
+    
+    // Headless init, `warmup` untimed + `iterations` timed dispatches of each
+    // compute stage at config.gridSize, then cleanup
+    KernelBenchReport benchmark_kernels(uint32_t warmup, uint32_t iterations);
 
 private:
     void init();
     void main_loop();
     void cleanup();
+    
+    // Headless (compute only, no window)
+    void init_headless();
+    void run_headless();
+    void cleanup_headless();
+    
+    // --backend cpu: the headless run on CpuSim, no Vulkan at all
+    bool run_cpu();
+    // --check-isa: CpuSim's vector paths against each other, bit for bit
+    bool check_cpu_isas();
+    
+    // --verify: headless steps with a state hash after each one
+    bool run_verify();
 
     void init_window();
     void init_vulkan();
@@ -239,6 +328,29 @@ private:
     void cleanup_imgui();
 
     void draw();
+    void record_simulation_steps(VkCommandBuffer cmd, uint32_t steps);
+    
+    // Frame graph: passes declare reads/writes, barriers are inferred
+    FrameGraph frame_graph;
+    FrameGraph::ResourceId fg_height[2] = {0, 0};
+    FrameGraph::ResourceId fg_biome[2] = {0, 0};
+    FrameGraph::ResourceId fg_stats = 0;
+    FrameGraph::ResourceId fg_height_pyramid = 0;
+    uint32_t lastFrameBarriers = 0;
+    void init_frame_graph();
+    
+    // GPU timestamps around every graph pass (and ImGui), one query slot per
+    // frame in flight + one for the async batch
+    GpuProfiler gpuProfiler;
+    static constexpr int MAX_STEPS_PER_FRAME_LIMIT = 256; // "Max Steps/Frame" slider range
+    static constexpr uint32_t SIM_SCOPES_PER_STEP = 2;    // Erosion + biome CA passes
+    void init_gpu_profiler();
+    
+    // Async Compute
+    void init_async_compute();
+    bool simulation_idle();
+    void wait_simulation_idle();
+    void submit_async_simulation(uint32_t steps, int slot);
     
     // Helper to clear/initialize grid
     void initialize_grid_pattern(Pattern pattern);
@@ -257,8 +369,11 @@ private:
     // Profiling/Benchmark
     ProfileConfig config;
     double benchmarkStartTime = 0.0;
+    std::string benchmarkName;     // benchmark_<grid>_<speed>, prefix of every output
     std::ofstream benchmarkCSV;
     double lastCSVWrite = 0.0;
+    FrameTimings frameTimings;     // Every frame's CPU/GPU time, written at exit
+    void write_frame_timings();
     
     // FPS Counting
     double last_timestamp = 0.0;
@@ -274,6 +389,11 @@ private:
     double lastFrameTime = 0.0;
     bool paused = false;
     bool needsReset = false;  // Set by UI Reset button
+    uint32_t simStep = 0;     // Biome CA step counter (seeds the stochastic rules)
+    int lastFrameSteps = 0;   // Steps batched into the last frame
+    float lastFrameWaitMs = 0.0f; // draw() blocked on the frame fence + swapchain acquire
+    int stepsThisSecond = 0;
+    float stepsPerSecond = 0.0f;
     
     // UI State (ImGui)
     bool showUI = false;  // Start hidden, Tab to show
@@ -282,12 +402,32 @@ private:
     VkDescriptorPool imguiPool{VK_NULL_HANDLE};
     
     // Mouse Click Spawning
-    enum SpawnMode { SPAWN_NONE = 0, SPAWN_FOREST, SPAWN_DESERT, SPAWN_WATER, SPAWN_MOUNTAIN, SPAWN_GRASS };
+    enum SpawnMode { SPAWN_NONE = 0, SPAWN_FOREST, SPAWN_DESERT, SPAWN_WATER, SPAWN_MOUNTAIN, SPAWN_GRASS,
+                     SPAWN_RAISE, SPAWN_LOWER };
     int spawnMode = SPAWN_FOREST;  // Default to forest
     int spawnRadius = 5;           // Radius of effect in pixels
-    bool pendingClick = false;     // Flag for pending mouse click
-    float clickU = 0.0f, clickV = 0.0f;  // UV coords of click
+    float brushFalloff = 0.0f;     // 0 = hard edge (biomes), 1 = soft round brush
+    float brushStrength = 0.01f;   // Height change per raise/lower event
+    bool brushHeld = false;        // Left button down: cursor moves keep painting
     GLFWcursor* crosshairCursor = nullptr;  // Custom cursor for spawn mode
+    
+    // Brush edits: queued by the input callbacks, uploaded through a
+    // persistent arena (one region per frame in flight + the async batch)
+    // and applied by one brush.comp dispatch in the frame's command buffer
+    static constexpr uint32_t MAX_BRUSH_EVENTS = 256;  // Per region; extra events wait a frame
+    std::vector<BrushEvent> brushQueue;
+    VkBuffer brush_buffer{VK_NULL_HANDLE};
+    VmaAllocation brush_allocation{VK_NULL_HANDLE};
+    BrushEvent* brush_mapped = nullptr;
+    VkDescriptorSetLayout brush_layout{VK_NULL_HANDLE};
+    VkDescriptorPool brush_pool{VK_NULL_HANDLE};
+    VkDescriptorSet brush_set{VK_NULL_HANDLE};
+    VkPipelineLayout brush_pipeline_layout{VK_NULL_HANDLE};
+    VkPipeline brush_pipeline{VK_NULL_HANDLE};
+    void init_brush_pipeline();
+    bool pick_terrain(double mouseX, double mouseY, float& u, float& v);
+    void queue_brush(float u, float v);
+    void record_brush(VkCommandBuffer cmd, int region);
 
     // Vulkan Core
     vkb::Instance instance;
@@ -297,6 +437,17 @@ private:
     vkb::Device device;
     VkQueue graphics_queue{VK_NULL_HANDLE};
     uint32_t graphics_queue_family;
+    
+    // Async Compute (dedicated compute family, synced with timeline semaphores)
+    bool asyncCompute = false;  // Resolved in init_vulkan, may fall back to single queue
+    VkQueue compute_queue{VK_NULL_HANDLE};
+    uint32_t compute_queue_family = 0;
+    VkCommandPool compute_command_pool{VK_NULL_HANDLE};
+    VkCommandBuffer compute_command_buffer{VK_NULL_HANDLE};
+    VkSemaphore sim_timeline{VK_NULL_HANDLE};     // Signaled by each sim batch
+    VkSemaphore render_timeline{VK_NULL_HANDLE};  // Signaled by each graphics frame
+    uint64_t sim_timeline_value = 0;
+    uint64_t render_timeline_value = 0;
 
     // VMA
     VmaAllocator allocator{VK_NULL_HANDLE};
@@ -320,6 +471,7 @@ private:
     std::vector<VkSemaphore> image_available_semaphores;
     std::vector<VkSemaphore> render_finished_semaphores;
     std::vector<VkFence> in_flight_fences;
+    uint64_t profiledFrame[MAX_FRAMES_IN_FLIGHT + 1] = {}; // frameTimings frame each profiler slot last recorded
 
     // Compute Resources
     VkDescriptorSetLayout compute_descriptor_layout{VK_NULL_HANDLE};
@@ -345,7 +497,7 @@ private:
     
     size_t current_sim_output_index = 0;
 
-    // Heightmap Resources (Week 3) (R32_SFLOAT)
+    // Heightmap Resources (Week 3), config.heightFormat (R16_UNORM by default)
     VkImage heightmap_images[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
     VmaAllocation heightmap_allocations[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
     VkImageView heightmap_views[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
@@ -364,7 +516,20 @@ private:
     VmaAllocation biome_allocations[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
     VkImageView biome_views[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
     
-    size_t current_heightmap_index = 0;
+    size_t current_heightmap_index = 1;  // Start at 1 so first erosion outputs to 0 (where noise wrote)
+
+    // Display copies for async compute: the renderer samples these while the
+    // compute queue keeps stepping the ping-pong images
+    VkImage display_height_images[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VmaAllocation display_height_allocations[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VkImageView display_height_views[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VkImage display_biome_images[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VmaAllocation display_biome_allocations[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VkImageView display_biome_views[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    uint64_t display_ready_value[2]{0, 0};  // sim_timeline value that publishes the slot
+    uint64_t display_last_read[2]{0, 0};    // render_timeline value of the last frame sampling it
+    int display_latest = 0;                 // Slot of the most recently submitted batch
+    bool displayDirty = true;               // Ping-pong images changed outside a sim batch
 
     // Heightmap/Biome Initialization
     VkPipelineLayout noise_pipeline_layout{VK_NULL_HANDLE};
@@ -394,34 +559,265 @@ private:
     void init_biome_ca_pipeline();
     void dispatch_biome_ca_init();
     
+    // Heightmap format (--height-format): shaders round to heightLevels steps
+    // (0 = float) through the HEIGHT_LEVELS specialization constant
+    float heightLevels = 65535.0f;
+    VkSpecializationMapEntry heightSpecEntry{10, 0, sizeof(float)};
+    VkSpecializationInfo heightSpecInfo{1, &heightSpecEntry, sizeof(float), &heightLevels};
+    bool storageWithoutFormat = false; // Device-wide read/write without format; else per format (1.3)
+    void choose_height_format();
+    
+    // Stage-driven allocation: VRAM per stage, printed once init is done
+    std::vector<std::pair<std::string, VkDeviceSize>> stage_vram;
+    void resolve_stages();
+    void track_vram(const char* stage, VmaAllocation allocation);
+    void print_vram_report();
+    void release_aliased_images();
+    
+    // Fused Erosion + Biome CA (--fused)
+    VkPipelineLayout fused_pipeline_layout{VK_NULL_HANDLE};
+    VkPipeline fused_pipeline{VK_NULL_HANDLE};
+    void init_fused_pipeline();
+    
+    // Temporal Blocking (--temporal K)
+    VkPipelineLayout temporal_pipeline_layout{VK_NULL_HANDLE};
+    VkPipeline temporal_pipeline{VK_NULL_HANDLE};
+    int temporalK = 0;  // Ghost zone width the pipeline was built with (0 = off)
+    void init_temporal_pipeline();
+    
+    // Active Tiles (--active-tiles): dirty-tile flags -> compacted list -> indirect dispatch
+    VkDescriptorSetLayout active_tile_layout{VK_NULL_HANDLE};
+    VkDescriptorPool active_tile_pool{VK_NULL_HANDLE};
+    VkDescriptorSet active_tile_sets[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};  // By parity
+    VkBuffer tile_flag_buffers[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VmaAllocation tile_flag_allocations[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VkBuffer tile_list_buffers[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VmaAllocation tile_list_allocations[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VkPipelineLayout active_pipeline_layout{VK_NULL_HANDLE};  // Set 0 images + set 1 tile buffers
+    VkPipeline tile_compact_pipeline{VK_NULL_HANDLE};
+    VkPipeline erosion_active_pipeline{VK_NULL_HANDLE};
+    VkPipeline biome_ca_active_pipeline{VK_NULL_HANDLE};
+    uint32_t tilesX = 0, tilesY = 0;
+    int activeParity = 0;              // Flags/list pair the next compaction reads/writes
+    bool activeTilesNeedClear = true;  // Zero the buffers in the first recorded batch
+    bool activeTilesForce = true;      // Next step sweeps every tile
+    bool hasDirtyTiles = false;        // Spawn edits to re-activate
+    int dirtyTileRect[4]{0, 0, 0, 0};  // x0, y0, x1, y1 (inclusive, in tiles)
+    ErosionPushConstants lastErosionParams;
+    void init_active_tiles();
+    void record_active_tile_steps(VkCommandBuffer cmd, uint32_t steps);
+    void mark_dirty_tiles(int x0, int y0, int x1, int y1);
+    
+    // Bit-sliced biomes (--bitsliced): planes[i] mirrors Bio[i]; the R8 images
+    // are only refreshed (unpacked) once per batch
+    VkDescriptorSetLayout biome_plane_layout{VK_NULL_HANDLE};
+    VkDescriptorPool biome_plane_pool{VK_NULL_HANDLE};
+    VkDescriptorSet biome_plane_sets[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};  // By parity
+    VkBuffer biome_plane_buffers[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VmaAllocation biome_plane_allocations[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VkPipelineLayout bitsliced_pipeline_layout{VK_NULL_HANDLE};  // Set 0 images + set 1 planes
+    VkPipeline erosion_bitsliced_pipeline{VK_NULL_HANDLE};
+    VkPipeline biome_ca_bitsliced_pipeline{VK_NULL_HANDLE};
+    VkPipeline biome_convert_pipeline{VK_NULL_HANDLE};
+    bool biomePlanesNeedPack = true;  // Images were written outside the sim (init, reset, spawn)
+    void init_bitsliced_biome();
+    void record_bitsliced_steps(VkCommandBuffer cmd, uint32_t steps);
+    
+    // Convergence detection: per-batch change counts read back a frame later
+    struct SimStats {
+        uint32_t changedCells;  // Cells whose biome changed in the sampled step
+        uint32_t heightDeltaLo; // Sum of |dh| in 1/65535 steps, as two lanes
+        uint32_t heightDeltaHi; // (sim_stats.comp carries into the high one)
+        
+        uint64_t heightDelta() const { return static_cast<uint64_t>(heightDeltaHi) << 32 | heightDeltaLo; }
+    };
+    static const int SIM_STATS_SLOTS = MAX_FRAMES_IN_FLIGHT + 1;  // Per frame + async batch
+    static constexpr float IDLE_INTERVAL = 1.0f;  // Seconds per step while idling
+    VkDescriptorSetLayout sim_stats_layout{VK_NULL_HANDLE};
+    VkDescriptorPool sim_stats_pool{VK_NULL_HANDLE};
+    VkDescriptorSet sim_stats_set{VK_NULL_HANDLE};
+    VkPipelineLayout sim_stats_pipeline_layout{VK_NULL_HANDLE};
+    VkPipeline sim_stats_pipeline{VK_NULL_HANDLE};
+    VkBuffer sim_stats_buffer{VK_NULL_HANDLE};
+    VmaAllocation sim_stats_allocation{VK_NULL_HANDLE};
+    SimStats* sim_stats_mapped = nullptr;
+    uint32_t statsPendingSteps[SIM_STATS_SLOTS]{};  // Steps in the batch a slot sampled (0 = empty)
+    SimStats lastStats{};
+    uint32_t quietSteps = 0;
+    bool simIdling = false;
+    void init_sim_stats();
+    void record_sim_stats(VkCommandBuffer cmd, int slot, uint32_t steps);
+    void read_sim_stats(int slot);
+    void wake_simulation();
+    
+    // --verify: state_hash.comp reduction of the latest height + biome, and
+    // (with --verify-reference) a readback of all four ping-pong images
+    VkDescriptorSetLayout state_hash_layout{VK_NULL_HANDLE};
+    VkDescriptorPool state_hash_pool{VK_NULL_HANDLE};
+    VkDescriptorSet state_hash_set{VK_NULL_HANDLE};
+    VkPipelineLayout state_hash_pipeline_layout{VK_NULL_HANDLE};
+    VkPipeline state_hash_pipeline{VK_NULL_HANDLE};
+    VkBuffer state_hash_buffer{VK_NULL_HANDLE};
+    VmaAllocation state_hash_allocation{VK_NULL_HANDLE};
+    uint32_t* state_hash_mapped = nullptr;   // Four lanes, see state_hash.hpp
+    VkBuffer verify_readback_buffer{VK_NULL_HANDLE};
+    VmaAllocation verify_readback_allocation{VK_NULL_HANDLE};
+    uint8_t* verify_readback_mapped = nullptr; // H[0], H[1], Bio[0], Bio[1]
+    FrameGraph::ResourceId fg_state_hash = 0;
+    void init_state_hash();
+    void record_state_hash(VkCommandBuffer cmd);
+    void record_verify_readback(VkCommandBuffer cmd);
+    StateHash read_state_hash();
+    void destroy_state_hash();
+    
     // 2.5D Rendering Resources
     Camera camera;
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
     
-    VkBuffer vertexBuffer;
-    VmaAllocation vertexBufferAllocation;
-    VkBuffer indexBuffer;
-    VmaAllocation indexBufferAllocation;
+    // One terrain patch, shared by every LOD node. No vertex buffer:
+    // terrain.vert derives the grid position from gl_VertexIndex
+    VkBuffer patchIndexBuffer;
+    VmaAllocation patchIndexAllocation;
+    uint32_t patchIndexCount = 0;
     
     std::vector<VkBuffer> uniformBuffers;
     std::vector<VmaAllocation> uniformBuffersAllocation;
     std::vector<void*> uniformBuffersMapped;
+
+    // CDLOD terrain: nodes picked per frame, drawn as instances of the patch
+    static constexpr uint32_t MAX_TERRAIN_PATCHES = 16384;
+    TerrainLod terrainLod;
+    std::vector<TerrainPatch> terrainPatches;
+    std::vector<VkBuffer> terrainPatchBuffers;  // Per frame in flight, host-visible
+    std::vector<VmaAllocation> terrainPatchAllocations;
+    std::vector<void*> terrainPatchMapped;
+    
+    // GPU frustum culling (terrain_cull.comp): selected patches -> visible
+    // instance list + indirect draw args, per frame in flight
+    std::vector<VkBuffer> visiblePatchBuffers;
+    std::vector<VmaAllocation> visiblePatchAllocations;
+    std::vector<VkBuffer> terrainDrawArgsBuffers;
+    std::vector<VmaAllocation> terrainDrawArgsAllocations;
+    VkDescriptorSetLayout terrain_cull_layout{VK_NULL_HANDLE};
+    VkDescriptorPool terrain_cull_pool{VK_NULL_HANDLE};
+    std::vector<VkDescriptorSet> terrain_cull_sets;
+    VkPipelineLayout terrain_cull_pipeline_layout{VK_NULL_HANDLE};
+    VkPipeline terrain_cull_pipeline{VK_NULL_HANDLE};
+    
+    // Min/max/mean height pyramid (height_pyramid.comp) of the height the
+    // terrain pass draws; sampled at binding 2 of the texture sets and
+    // queried through height_pyramid.glsl
+    static constexpr uint32_t MAX_PYRAMID_LEVELS = 16;  // height_pyramid.comp MAX_LEVELS
+    static constexpr uint32_t PYRAMID_TILE = 64;        // Texels per workgroup side
+    VkImage height_pyramid_image{VK_NULL_HANDLE};
+    VmaAllocation height_pyramid_allocation{VK_NULL_HANDLE};
+    VkImageView height_pyramid_view{VK_NULL_HANDLE};       // Every level, sampled
+    std::vector<VkImageView> height_pyramid_level_views;   // One per level, storage
+    uint32_t heightPyramidLevels = 0;
+    VkBuffer height_pyramid_counter_buffer{VK_NULL_HANDLE};
+    VmaAllocation height_pyramid_counter_allocation{VK_NULL_HANDLE};
+    VkDescriptorSetLayout height_pyramid_layout{VK_NULL_HANDLE};
+    VkDescriptorPool height_pyramid_pool{VK_NULL_HANDLE};
+    VkDescriptorSet height_pyramid_set{VK_NULL_HANDLE};
+    VkPipelineLayout height_pyramid_pipeline_layout{VK_NULL_HANDLE};
+    VkPipeline height_pyramid_pipeline{VK_NULL_HANDLE};
+    bool heightPyramidFull = true;             // Whole chain is stale
+    int heightPyramidDirty[4] = {0, 0, -1, -1}; // Texel rect x0, y0, x1, y1 (empty when x1 < x0)
+    uint64_t heightPyramidSource = 0;          // Async: display_ready_value it was built from
+    void create_height_pyramid();
+    void init_height_pyramid_pipeline();
+    void mark_height_pyramid_dirty(int x0, int y0, int x1, int y1);
+    void record_height_pyramid(VkCommandBuffer cmd, size_t textureSet);
     
     VkImage depthImage;
     VmaAllocation depthImageAllocation;
     VkImageView depthImageView;
     
-    void create_grid_mesh();
-    void create_vertex_buffer();
-    void create_index_buffer();
+    void create_patch_index_buffer();
     void create_uniform_buffers();
+    void create_terrain_patch_buffers();
+    void select_terrain_patches(uint32_t currentImage);
+    void init_terrain_cull();
+    void record_terrain_cull(VkCommandBuffer cmd, uint32_t currentImage, size_t textureSet);
     void create_depth_resources();
     void update_uniform_buffer(uint32_t currentImage);
     
     // Helpers for buffers
     void create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage, VkBuffer& buffer, VmaAllocation& allocation);
     void copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    VkCommandBuffer begin_one_shot_commands();
+    void submit_one_shot_commands(VkCommandBuffer commandBuffer);
+    
+    // Snapshots (--save-state / --load-state / --checkpoint-steps)
+    snapshot::Writer snapshot_writer;
+    VkBuffer snapshot_readback_buffer{VK_NULL_HANDLE};
+    VmaAllocation snapshot_readback_allocation{VK_NULL_HANDLE};
+    VkDeviceSize snapshot_readback_size = 0;
+    uint32_t lastCheckpointStep = 0;
+    bool hostImportSupported = false;
+    VkImage snapshot_image(uint32_t kind, uint32_t slot);
+    void fill_snapshot_layers(snapshot::Header& header);
+    snapshot::Header snapshot_header();
+    void record_snapshot_copies(VkCommandBuffer cmd, const snapshot::Header& header);
+    void save_state(const std::string& path);
+    bool load_state(const std::string& path);
+    bool import_host_buffer(const void* ptr, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory);
+    
+    // Checkpoints (--checkpoint-steps) record the snapshot readback into a
+    // batch's command buffer; the writer hashes and writes it on a worker
+    // thread once that submit's fence/timeline has passed
+    enum CheckpointState { CHECKPOINT_IDLE = 0, CHECKPOINT_IN_FLIGHT, CHECKPOINT_WRITING };
+    int checkpointState = CHECKPOINT_IDLE;
+    int checkpointFrame = -1;             // in_flight_fences index, -1 = sim_timeline
+    uint64_t checkpointTimeline = 0;
+    snapshot::Header checkpointHeader;
+    std::future<snapshot::Writer::Result> checkpointWrite;
+    void record_checkpoint(VkCommandBuffer cmd, int frame);
+    void poll_checkpoint();
+    void finish_checkpoint();
+    
+    // Export ring (--export-every): copies recorded at the end of a step's
+    // command buffer into persistently mapped readback buffers, handed to
+    // the exporter's workers once that submit's fence/timeline has passed
+    static constexpr int EXPORT_SLOTS = 4;
+    enum ExportSlotState { EXPORT_FREE = 0, EXPORT_IN_FLIGHT = 1, EXPORT_ENCODING = 2 };
+    struct ExportSlot {
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VmaAllocation allocation{VK_NULL_HANDLE};
+        uint8_t* mapped = nullptr;
+        std::atomic<int> state{EXPORT_FREE}; // Set back to FREE by an exporter thread
+        int frame = -1;                      // in_flight_fences index, -1 = sim_timeline
+        uint64_t timelineValue = 0;
+        uint32_t step = 0;
+    };
+    ExportSlot export_slots[EXPORT_SLOTS];
+    StateExporter exporter;
+    uint32_t lastExportStep = 0;
+    uint32_t exportsQueued = 0;
+    uint32_t exportsDeferred = 0;  // Due exports that waited for a free slot
+    void init_export();
+    void record_export(VkCommandBuffer cmd, int frame);
+    void poll_exports();
+    void shutdown_export();
+    HeightEncoding height_encoding() const;
+    
+    // Picking: clicks ray-march a CPU min/max pyramid of the heightmap. A
+    // copy of the height is read back every pickRefreshSteps (same ring
+    // discipline as the exports) and the pyramid rebuilt on a worker thread.
+    static constexpr float TERRAIN_HEIGHT_SCALE = 0.22f;  // terrain.vert heightScale
+    enum PickReadbackState { PICK_IDLE = 0, PICK_IN_FLIGHT, PICK_BUILDING };
+    VkBuffer pick_readback_buffer{VK_NULL_HANDLE};
+    VmaAllocation pick_readback_allocation{VK_NULL_HANDLE};
+    uint8_t* pick_readback_mapped = nullptr;
+    int pickReadbackState = PICK_IDLE;
+    int pickReadbackFrame = -1;           // in_flight_fences index, -1 = sim_timeline
+    uint64_t pickReadbackTimeline = 0;
+    uint32_t lastPickRefreshStep = 0;
+    bool pickRefreshDue = true;           // Terrain changed outside the step count (reset, brush)
+    std::future<std::shared_ptr<const HeightPyramid>> pickBuild;
+    std::shared_ptr<const HeightPyramid> pickPyramid;
+    void init_picking();
+    void record_pick_refresh(VkCommandBuffer cmd, int frame);
+    void poll_pick_refresh();
     
     // Helper for Depth Format
     VkFormat find_depth_format();
@@ -1,42 +1,51 @@
 #include "living_worlds.hpp"
+#include "cli_args.hpp"
 #include <cstring>
 #include <cstdlib>
 
-// Helper functions for CLI parsing
-bool hasArg(int argc, char* argv[], const char* arg) {
-    for (int i = 1; i < argc; i++) {
-        if (strcmp(argv[i], arg) == 0) return true;
-    }
-    return false;
-}
-
-int getArgInt(int argc, char* argv[], const char* arg, int defaultVal) {
-    for (int i = 1; i < argc - 1; i++) {
-        if (strcmp(argv[i], arg) == 0) {
-            return atoi(argv[i + 1]);
-        }
-    }
-    return defaultVal;
-}
-
-float getArgFloat(int argc, char* argv[], const char* arg, float defaultVal) {
-    for (int i = 1; i < argc - 1; i++) {
-        if (strcmp(argv[i], arg) == 0) {
-            return static_cast<float>(atof(argv[i + 1]));
-        }
-    }
-    return defaultVal;
-}
-
 void printUsage() {
     std::cout << "Usage: LivingWorlds [options]\n"
               << "Options:\n"
               << "  --benchmark       Enable benchmark mode (auto-exit, CSV logging)\n"
               << "  --grid SIZE       Set grid size (default: 3072)\n"
               << "  --duration SECS   Benchmark duration in seconds (default: 30)\n"
+              << "  --frame-log N     Benchmark: frames kept for the per-frame timing log (default: 262144)\n"
               << "  --speed MULT      Simulation speed multiplier (default: 1.0)\n"
               << "  --no-erosion      Disable erosion simulation\n"
               << "  --no-biome        Disable biome CA simulation\n"
+              << "  --bidir           Biome-dependent erosion rates (Bidir Feedback) from the start\n"
+              << "  --max-steps N     Max simulation steps batched per frame (default: 64)\n"
+              << "  --async-compute   Run the simulation on a dedicated compute queue\n"
+              << "  --fused           Fused erosion + biome CA kernel (one dispatch per step)\n"
+              << "  --biome-ca-direct Baseline (pre-tiling) biome CA kernel, the reference for --verify/LivingWorldsBench\n"
+              << "  --temporal K      Run up to K (1-8) fused generations per dispatch\n"
+              << "  --active-tiles    Only step tiles that changed last step (indirect dispatch)\n"
+              << "  --auto-idle       Slow the sim to 1 step/s once the world stops changing\n"
+              << "  --idle-threshold F  Changed-cell fraction per step counted as quiet (default: 0.0001)\n"
+              << "  --idle-steps N    Quiet steps before idling (default: 256)\n"
+              << "  --bitsliced       Bit-sliced biome state (32 cells per CA invocation)\n"
+              << "  --height-format F Heightmap format: r16 (default), r32f or rgba8\n"
+              << "  --climate         Allocate the temperature/humidity layers (debug viz only)\n"
+              << "  --save-state FILE Write a snapshot on exit (and every --checkpoint-steps)\n"
+              << "  --load-state FILE Resume from a snapshot instead of a fresh world\n"
+              << "  --checkpoint-steps N  Incremental snapshot every N sim steps (needs --save-state)\n"
+              << "  --import-host-memory  Upload snapshots by importing the mmapped file\n"
+              << "  --pick-refresh N  Refresh the click-picking height pyramid every N steps (default: 16)\n"
+              << "  --lod-error PX    Terrain LOD screen-space error in pixels (default: 2.0)\n"
+              << "  --export-every N  Export height + biome maps every N sim steps (async)\n"
+              << "  --export-dir DIR  Export directory (default: exports)\n"
+              << "  --export-format F png (8-bit preview, default) or raw (16-bit height)\n"
+              << "  --headless        No window: run --steps sim steps and report throughput\n"
+              << "  --steps N         Steps to run in headless mode (default: 1000)\n"
+              << "  --backend B       Simulation backend: gpu (default) or cpu (headless, no Vulkan)\n"
+              << "  --threads N       CPU backend worker threads (default: all hardware threads)\n"
+              << "  --check-isa       CPU backend: run --steps on each of avx2/sse2/scalar, exit 1 unless all match\n"
+              << "  --seed F          Terrain noise seed (default: 42)\n"
+              << "  --verify N        Headless: hash the sim state after each of N steps, exit 1 on a mismatch\n"
+              << "  --golden FILE     --verify: compare the hashes against a golden file\n"
+              << "  --write-golden FILE  --verify: record the hashes as a golden file\n"
+              << "  --verify-reference  --verify: also step the CPU backend from each GPU state and compare\n"
+              << "  --verify-tolerance F  Biome cell fraction allowed to differ from the reference (default: 0, exact)\n"
               << "  --help            Show this help message\n";
 }
 
@@ -50,21 +59,98 @@ int main(int argc, char* argv[]) {
     config.benchmarkMode = hasArg(argc, argv, "--benchmark");
     config.gridSize = getArgInt(argc, argv, "--grid", 3072);
     config.duration = getArgInt(argc, argv, "--duration", 30);
+    config.frameLogCapacity = getArgInt(argc, argv, "--frame-log", 262144);
     config.simSpeed = getArgFloat(argc, argv, "--speed", 1.0f);
     config.enableErosion = !hasArg(argc, argv, "--no-erosion");
     config.enableBiomeCA = !hasArg(argc, argv, "--no-biome");
+    config.bidirErosion = hasArg(argc, argv, "--bidir");
+    config.maxStepsPerFrame = getArgInt(argc, argv, "--max-steps", 64);
+    config.asyncCompute = hasArg(argc, argv, "--async-compute");
+    config.headless = hasArg(argc, argv, "--headless");
+    config.fusedSim = hasArg(argc, argv, "--fused");
+    config.biomeCADirect = hasArg(argc, argv, "--biome-ca-direct");
+    config.temporalK = getArgInt(argc, argv, "--temporal", 0);
+    config.activeTiles = hasArg(argc, argv, "--active-tiles");
+    config.autoIdle = hasArg(argc, argv, "--auto-idle");
+    config.idleThreshold = getArgFloat(argc, argv, "--idle-threshold", 0.0001f);
+    config.idleSteps = getArgInt(argc, argv, "--idle-steps", 256);
+    config.bitslicedBiome = hasArg(argc, argv, "--bitsliced");
+    config.climate = hasArg(argc, argv, "--climate");
+    config.saveStatePath = getArgString(argc, argv, "--save-state", "");
+    config.loadStatePath = getArgString(argc, argv, "--load-state", "");
+    config.checkpointSteps = getArgInt(argc, argv, "--checkpoint-steps", 0);
+    config.importHostMemory = hasArg(argc, argv, "--import-host-memory");
+    config.pickRefreshSteps = getArgInt(argc, argv, "--pick-refresh", 16);
+    config.lodPixelError = getArgFloat(argc, argv, "--lod-error", 2.0f);
+    config.exportEvery = getArgInt(argc, argv, "--export-every", 0);
+    config.exportDir = getArgString(argc, argv, "--export-dir", "exports");
+    config.headlessSteps = getArgInt(argc, argv, "--steps", 1000);
+    config.cpuThreads = getArgInt(argc, argv, "--threads", 0);
+    config.checkIsa = hasArg(argc, argv, "--check-isa");
+    config.seed = getArgFloat(argc, argv, "--seed", 42.0f);
+    config.verifySteps = getArgInt(argc, argv, "--verify", 0);
+    config.goldenPath = getArgString(argc, argv, "--golden", "");
+    config.writeGoldenPath = getArgString(argc, argv, "--write-golden", "");
+    config.verifyReference = hasArg(argc, argv, "--verify-reference");
+    config.verifyTolerance = getArgFloat(argc, argv, "--verify-tolerance", 0.0f);
+    if (config.verifySteps > 0) config.headless = true;
+    
+    const char* backend = getArgString(argc, argv, "--backend", "gpu");
+    if (strcmp(backend, "gpu") == 0) {
+        config.cpuBackend = false;
+    } else if (strcmp(backend, "cpu") == 0) {
+        config.cpuBackend = true;
+        config.headless = true;
+    } else {
+        std::cerr << "Unknown --backend " << backend << "\n";
+        printUsage();
+        return 1;
+    }
+    
+    const char* exportFormat = getArgString(argc, argv, "--export-format", "png");
+    if (strcmp(exportFormat, "png") == 0) {
+        config.exportRaw = false;
+    } else if (strcmp(exportFormat, "raw") == 0) {
+        config.exportRaw = true;
+    } else {
+        std::cerr << "Unknown --export-format " << exportFormat << "\n";
+        printUsage();
+        return 1;
+    }
+    
+    const char* heightFormat = getArgString(argc, argv, "--height-format", "r16");
+    if (strcmp(heightFormat, "r16") == 0) {
+        config.heightFormat = VK_FORMAT_R16_UNORM;
+    } else if (strcmp(heightFormat, "r32f") == 0) {
+        config.heightFormat = VK_FORMAT_R32_SFLOAT;
+    } else if (strcmp(heightFormat, "rgba8") == 0) {
+        config.heightFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    } else {
+        std::cerr << "Unknown --height-format " << heightFormat << "\n";
+        printUsage();
+        return 1;
+    }
     
-    if (config.benchmarkMode) {
+    if (config.benchmarkMode && !config.headless) {
         std::cout << "=== BENCHMARK MODE ===\n"
                   << "Grid: " << config.gridSize << "x" << config.gridSize << "\n"
                   << "Duration: " << config.duration << "s\n"
                   << "Speed: " << config.simSpeed << "x\n"
                   << "Erosion: " << (config.enableErosion ? "ON" : "OFF") << "\n"
                   << "BiomeCA: " << (config.enableBiomeCA ? "ON" : "OFF") << "\n"
+                  << "Max Steps/Frame: " << config.maxStepsPerFrame << "\n"
+                  << "Async Compute: " << (config.asyncCompute ? "ON" : "OFF") << "\n"
+                  << "Fused Sim: " << (config.fusedSim ? "ON" : "OFF") << "\n"
+                  << "Temporal K: " << config.temporalK << "\n"
+                  << "Active Tiles: " << (config.activeTiles ? "ON" : "OFF") << "\n"
+                  << "Auto Idle: " << (config.autoIdle ? "ON" : "OFF") << "\n"
+                  << "Height Format: " << heightFormat << "\n"
+                  << "Bit-sliced Biomes: " << (config.bitslicedBiome ? "ON" : "OFF") << "\n"
+                  << "Climate Layers: " << (config.climate ? "ON" : "OFF") << "\n"
+                  << "Export Every: " << config.exportEvery << "\n"
                   << "======================\n";
     }
     
     LivingWorlds app(config);
-    app.run();
-    return 0;
+    return app.run();
 }
@@ -0,0 +1,198 @@
+#include "snapshot.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace snapshot {
+
+namespace {
+
+uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// FNV-1a over 64-bit words; tile sizes are always a multiple of 8 bytes
+uint64_t hash_tile(const uint8_t* data, uint64_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (uint64_t i = 0; i < size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool write_all(int fd, const void* data, uint64_t size, uint64_t offset) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t written = pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (written <= 0) return false;
+        bytes += written;
+        offset += static_cast<uint64_t>(written);
+        size -= static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+bool same_layout(const Header& a, const Header& b) {
+    if (a.width != b.width || a.height != b.height || a.tileSize != b.tileSize || a.layerCount != b.layerCount) {
+        return false;
+    }
+    for (uint32_t i = 0; i < a.layerCount; i++) {
+        if (a.layers[i].kind != b.layers[i].kind || a.layers[i].slot != b.layers[i].slot ||
+            a.layers[i].format != b.layers[i].format || a.layers[i].offset != b.layers[i].offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+uint64_t layout(Header& header) {
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.tileSize = TILE;
+
+    uint64_t tileCount = static_cast<uint64_t>(tiles_x(header)) * tiles_y(header);
+    uint64_t offset = align_up(sizeof(Header), DATA_ALIGN);
+    for (uint32_t i = 0; i < header.layerCount; i++) {
+        Layer& layer = header.layers[i];
+        layer.offset = offset;
+        layer.size = tileCount * tile_bytes(header, layer);
+        offset = align_up(offset + layer.size, DATA_ALIGN);
+    }
+    return offset;
+}
+
+const Layer* find_layer(const Header& header, uint32_t kind, uint32_t slot) {
+    for (uint32_t i = 0; i < header.layerCount && i < MAX_LAYERS; i++) {
+        if (header.layers[i].kind == kind && header.layers[i].slot == slot) return &header.layers[i];
+    }
+    return nullptr;
+}
+
+MappedFile::~MappedFile() {
+    if (base) munmap(base, length);
+}
+
+bool MappedFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Snapshot: cannot open " << path << "\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        std::cerr << "Snapshot: " << path << " is too small\n";
+        close(fd);
+        return false;
+    }
+    length = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Snapshot: mmap failed for " << path << "\n";
+        length = 0;
+        return false;
+    }
+    base = static_cast<uint8_t*>(mapped);
+
+    const Header& h = header();
+    if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION) {
+        std::cerr << "Snapshot: " << path << " is not a version " << VERSION << " snapshot\n";
+        return false;
+    }
+    // The copies built from the header assume this writer's tiling
+    if (h.layerCount > MAX_LAYERS || h.tileSize != TILE || h.width == 0 || h.height == 0) {
+        std::cerr << "Snapshot: corrupt header in " << path << "\n";
+        return false;
+    }
+    uint64_t tileCount = static_cast<uint64_t>(tiles_x(h)) * tiles_y(h);
+    for (uint32_t i = 0; i < h.layerCount; i++) {
+        const Layer& layer = h.layers[i];
+        bool texelOk = layer.bytesPerTexel == 1 || layer.bytesPerTexel == 2 || layer.bytesPerTexel == 4;
+        if (layer.kind > LAYER_HUMIDITY || layer.slot > 1 || !texelOk || layer.offset % DATA_ALIGN != 0 ||
+            layer.size != tileCount * tile_bytes(h, layer)) {
+            std::cerr << "Snapshot: corrupt layer table in " << path << "\n";
+            return false;
+        }
+        if (layer.offset > length || layer.size > length - layer.offset) {
+            std::cerr << "Snapshot: " << path << " is truncated\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+Writer::Result Writer::write(const std::string& path, const Header& header, const uint8_t* image) {
+    Result result;
+    uint64_t tileCount = static_cast<uint64_t>(tiles_x(header)) * tiles_y(header);
+    result.tilesTotal = tileCount * header.layerCount;
+
+    // Incremental only if the spare file is the one we left there
+    std::string spare = path + ".tmp";
+    bool sameFile = path == lastPath && same_layout(header, lastHeader);
+    bool incremental = sameFile && spareValid && access(spare.c_str(), W_OK) == 0;
+    int fd = ::open(spare.c_str(), incremental ? O_RDWR : (O_RDWR | O_CREAT | O_TRUNC), 0644);
+    if (fd < 0) {
+        std::cerr << "Snapshot: cannot write " << spare << "\n";
+        return result;
+    }
+    if (!incremental) spareHashes.assign(result.tilesTotal, 0);
+    spareValid = false;
+
+    bool ok = true;
+    uint64_t tileIndex = 0;
+    for (uint32_t i = 0; i < header.layerCount && ok; i++) {
+        const Layer& layer = header.layers[i];
+        uint64_t bytes = tile_bytes(header, layer);
+        for (uint64_t t = 0; t < tileCount && ok; t++, tileIndex++) {
+            uint64_t offset = layer.offset + t * bytes;
+            uint64_t hash = hash_tile(image + offset, bytes);
+            if (incremental && spareHashes[tileIndex] == hash) continue;
+            ok = write_all(fd, image + offset, bytes, offset);
+            spareHashes[tileIndex] = hash;
+            result.tilesWritten++;
+        }
+    }
+
+    ok = ok && write_all(fd, &header, sizeof(Header), 0);
+    if (ok && !incremental) {
+        uint64_t fileSize = header.layerCount > 0
+            ? align_up(header.layers[header.layerCount - 1].offset + header.layers[header.layerCount - 1].size, DATA_ALIGN)
+            : align_up(sizeof(Header), DATA_ALIGN);
+        ok = ftruncate(fd, static_cast<off_t>(fileSize)) == 0;
+    }
+    // On disk before the rename can make it visible
+    ok = ok && fsync(fd) == 0;
+    close(fd);
+
+    // Keep the file being replaced as the next spare: hard link it aside,
+    // rename the new one over it, then move the old one into the spare name
+    std::string previous = path + ".prev";
+    unlink(previous.c_str());
+    bool kept = ok && link(path.c_str(), previous.c_str()) == 0;
+    ok = ok && rename(spare.c_str(), path.c_str()) == 0;
+    if (!ok) {
+        std::cerr << "Snapshot: write to " << path << " failed\n";
+        if (kept) unlink(previous.c_str());
+        lastPath.clear();
+        return result;
+    }
+    kept = kept && rename(previous.c_str(), spare.c_str()) == 0;
+
+    // The old file's hashes are only known if we wrote it
+    std::swap(fileHashes, spareHashes);
+    spareValid = kept && sameFile;
+    lastPath = path;
+    lastHeader = header;
+    result.ok = true;
+    return result;
+}
+
+} // namespace snapshot
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Binary world snapshot (--save-state / --load-state).
+//
+// Layout: header, then each layer padded to DATA_ALIGN. A layer is stored
+// tile-major: TILE x TILE texel chunks (edge tiles padded) with rows
+// contiguous inside a chunk, so each chunk is one VkBufferImageCopy with
+// bufferRowLength = TILE straight out of the mmapped file, and incremental
+// saves can rewrite single chunks of the file they reuse. The file size is padded to
+// DATA_ALIGN too, so the whole mapping can be imported as a Vulkan buffer
+// (VK_EXT_external_memory_host).
+namespace snapshot {
+
+constexpr char MAGIC[8] = {'L', 'W', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t TILE = 256;
+constexpr uint32_t MAX_LAYERS = 8;
+constexpr uint64_t DATA_ALIGN = 65536; // >= minImportedHostPointerAlignment on common drivers
+
+enum LayerKind : uint32_t {
+    LAYER_HEIGHT = 0,
+    LAYER_BIOME = 1,
+    LAYER_TEMPERATURE = 2,
+    LAYER_HUMIDITY = 3,
+};
+
+struct Layer {
+    uint32_t kind = 0;          // LayerKind
+    uint32_t slot = 0;          // Ping-pong slot the image came from
+    uint32_t format = 0;        // VkFormat
+    uint32_t bytesPerTexel = 0;
+    uint64_t offset = 0;        // From file start, DATA_ALIGN aligned
+    uint64_t size = 0;          // tileCount * tile_bytes()
+};
+
+struct Header {
+    char magic[8] = {};
+    uint32_t version = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t tileSize = 0;
+    uint32_t layerCount = 0;
+    uint32_t heightmapIndex = 0; // current_heightmap_index at save time
+    uint64_t simStep = 0;
+    float seed = 0.0f;
+    uint32_t erosionSize = 0;    // sizeof(ErosionPushConstants), checked on load
+    uint32_t biomeSize = 0;      // sizeof(BiomePushConstants)
+    uint8_t erosion[64] = {};
+    uint8_t biome[64] = {};
+    Layer layers[MAX_LAYERS];
+};
+
+inline uint32_t tiles_x(const Header& h) { return (h.width + h.tileSize - 1) / h.tileSize; }
+inline uint32_t tiles_y(const Header& h) { return (h.height + h.tileSize - 1) / h.tileSize; }
+inline uint64_t tile_bytes(const Header& h, const Layer& l) {
+    return static_cast<uint64_t>(h.tileSize) * h.tileSize * l.bytesPerTexel;
+}
+
+// Fills in magic/version/tileSize and the layer table (offsets + sizes) for
+// the layers already listed in header.layers[0..layerCount). Returns the
+// padded file size; a readback buffer of that size mirrors the file.
+uint64_t layout(Header& header);
+
+const Layer* find_layer(const Header& header, uint32_t kind, uint32_t slot);
+
+// Read side: the whole file mmapped read-only
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path); // Also validates magic/version/layout
+    const Header& header() const { return *reinterpret_cast<const Header*>(base); }
+    const uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    uint8_t* base = nullptr;
+    size_t length = 0;
+};
+
+// Write side. A save goes to `path.tmp`, is fsynced and then renamed over
+// `path`, so an interrupted save leaves the previous snapshot intact. The
+// file it replaced becomes the next `path.tmp`; with a hash per tile of its
+// contents, the next save only rewrites the tiles that changed since then.
+class Writer {
+public:
+    struct Result {
+        bool ok = false;
+        uint64_t tilesWritten = 0;
+        uint64_t tilesTotal = 0;
+    };
+
+    // `image` is a buffer in file layout (see layout()); the header is
+    // taken from the argument, not from image
+    Result write(const std::string& path, const Header& header, const uint8_t* image);
+
+private:
+    std::string lastPath;
+    Header lastHeader;
+    std::vector<uint64_t> fileHashes;   // Tiles of `lastPath`
+    std::vector<uint64_t> spareHashes;  // Tiles of `lastPath.tmp`, if spareValid
+    bool spareValid = false;
+};
+
+} // namespace snapshot
@@ -0,0 +1,185 @@
+#include "state_exporter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+namespace {
+
+// Same ids as terrain.frag (biomeColorsLight)
+const uint8_t BIOME_COLORS[9][3] = {
+    {51, 115, 230},   // Water
+    {255, 242, 204},  // Sand
+    {115, 191, 89},   // Grass
+    {51, 128, 38},    // Forest
+    {242, 179, 115},  // Desert
+    {153, 148, 140},  // Rock
+    {255, 255, 255},  // Snow
+    {179, 153, 115},  // Tundra
+    {64, 140, 115},   // Wetland
+};
+
+bool pwrite_all(const std::string& path, const void* data, size_t size, size_t offset) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) return false;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    bool ok = true;
+    while (size > 0 && ok) {
+        ssize_t written = pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        ok = written > 0;
+        if (ok) {
+            bytes += written;
+            offset += static_cast<size_t>(written);
+            size -= static_cast<size_t>(written);
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+} // namespace
+
+struct StateExporter::Job {
+    Frame frame;
+    std::function<void()> done;
+    std::string heightPath;
+    std::string biomePath;
+    std::vector<uint8_t> heightPixels;  // PNG: 8-bit gray, raw: 16-bit LE
+    std::vector<uint8_t> biomePixels;   // PNG only: RGB
+    std::atomic<uint32_t> stripsLeft{0};
+};
+
+StateExporter::~StateExporter() {
+    shutdown();
+}
+
+void StateExporter::start(const std::string& dir, Format fmt, unsigned threads) {
+    directory = dir;
+    format = fmt;
+    threads = std::max(threads, 1u);
+    stripCount = threads * 2;
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(&StateExporter::worker_loop, this);
+    }
+}
+
+void StateExporter::submit(const Frame& frame, std::function<void()> done) {
+    auto job = std::make_shared<Job>();
+    job->frame = frame;
+    job->done = std::move(done);
+    enqueue([this, job] { prepare(job); }); // Allocations stay off the caller's thread
+}
+
+void StateExporter::prepare(const std::shared_ptr<Job>& job) {
+    const Frame& frame = job->frame;
+    std::string suffix = "_" + std::to_string(frame.step) + "_" + std::to_string(frame.width) + "x" + std::to_string(frame.height);
+    if (format == Format::Png) {
+        job->heightPath = directory + "/height" + suffix + ".png";
+        job->biomePath = directory + "/biome" + suffix + ".png";
+        job->heightPixels.resize(static_cast<size_t>(frame.width) * frame.height);
+        job->biomePixels.resize(static_cast<size_t>(frame.width) * frame.height * 3);
+    } else {
+        job->heightPath = directory + "/height" + suffix + ".r16";
+        job->biomePath = directory + "/biome" + suffix + ".u8";
+        job->heightPixels.resize(static_cast<size_t>(frame.width) * frame.height * 2);
+    }
+
+    uint32_t strips = std::min(stripCount, frame.height);
+    uint32_t rowsPerStrip = (frame.height + strips - 1) / strips;
+    strips = (frame.height + rowsPerStrip - 1) / rowsPerStrip;
+    job->stripsLeft = strips;
+    for (uint32_t s = 0; s < strips; s++) {
+        uint32_t row0 = s * rowsPerStrip;
+        uint32_t row1 = std::min(row0 + rowsPerStrip, frame.height);
+        enqueue([this, job, row0, row1] { run_strip(job, row0, row1); });
+    }
+}
+
+// Converts rows [row0, row1). Raw output is written by the strip itself at
+// its file offset; PNG output is encoded once every strip has converted.
+void StateExporter::run_strip(const std::shared_ptr<Job>& job, uint32_t row0, uint32_t row1) {
+    const Frame& f = job->frame;
+    uint32_t heightStride = height_bytes_per_texel(f.heightEncoding);
+    size_t first = static_cast<size_t>(row0) * f.width;
+    size_t count = static_cast<size_t>(row1 - row0) * f.width;
+
+    for (size_t i = first; i < first + count; i++) {
+        uint16_t h = height_to_u16(f.heightData + i * heightStride, f.heightEncoding);
+        if (format == Format::Png) {
+            job->heightPixels[i] = static_cast<uint8_t>(h >> 8);
+            const uint8_t* color = BIOME_COLORS[std::min<uint8_t>(f.biomeData[i], 8)];
+            memcpy(&job->biomePixels[i * 3], color, 3);
+        } else {
+            memcpy(&job->heightPixels[i * 2], &h, sizeof(h));
+        }
+    }
+
+    if (format == Format::Raw) {
+        bool ok = pwrite_all(job->heightPath, &job->heightPixels[first * 2], count * 2, first * 2) &&
+                  pwrite_all(job->biomePath, f.biomeData + first, count, first);
+        if (!ok) std::cerr << "Export: failed writing rows " << row0 << "-" << row1 << " of step " << f.step << "\n";
+    }
+
+    if (--job->stripsLeft == 0) finish_strips(job);
+}
+
+void StateExporter::finish_strips(const std::shared_ptr<Job>& job) {
+    if (format == Format::Raw) {
+        job->done(); // Source rows were consumed by the strips
+        return;
+    }
+    // Converted copies are owned by the job, so the readback slot is free now
+    job->done();
+    enqueue([job] {
+        const Frame& f = job->frame;
+        if (!stbi_write_png(job->heightPath.c_str(), f.width, f.height, 1, job->heightPixels.data(), f.width)) {
+            std::cerr << "Export: failed writing " << job->heightPath << "\n";
+        }
+    });
+    enqueue([job] {
+        const Frame& f = job->frame;
+        if (!stbi_write_png(job->biomePath.c_str(), f.width, f.height, 3, job->biomePixels.data(), f.width * 3)) {
+            std::cerr << "Export: failed writing " << job->biomePath << "\n";
+        }
+    });
+}
+
+void StateExporter::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void StateExporter::worker_loop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return; // Stopping and drained
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void StateExporter::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+    workers.clear();
+    stopping = false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "height_encoding.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Encodes readback copies of the sim state to disk on worker threads
+// (--export-every). Work is split into horizontal strips; the caller's
+// `done` callback runs on a worker once the source buffers can be reused.
+// Nothing here ever blocks the submitting thread.
+class StateExporter {
+public:
+    enum class Format { Png, Raw };
+    using HeightEncoding = ::HeightEncoding;
+
+    struct Frame {
+        const uint8_t* heightData = nullptr; // width * height texels, tightly packed
+        const uint8_t* biomeData = nullptr;  // R8_UINT biome ids
+        HeightEncoding heightEncoding = HeightEncoding::R16;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t step = 0;
+    };
+
+    ~StateExporter();
+
+    void start(const std::string& directory, Format format, unsigned threads);
+    void submit(const Frame& frame, std::function<void()> done);
+    void shutdown(); // Finishes queued work, then joins the workers
+
+    bool running() const { return !workers.empty(); }
+
+private:
+    struct Job;
+
+    void enqueue(std::function<void()> task);
+    void prepare(const std::shared_ptr<Job>& job);
+    void worker_loop();
+    void run_strip(const std::shared_ptr<Job>& job, uint32_t row0, uint32_t row1);
+    void finish_strips(const std::shared_ptr<Job>& job);
+
+    std::string directory;
+    Format format = Format::Png;
+    uint32_t stripCount = 1;
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
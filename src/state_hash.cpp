@@ -0,0 +1,55 @@
+#include "state_hash.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+StateHash hash_state(const float* height, const uint8_t* biome, uint32_t cellCount, float heightLevels) {
+    uint32_t lanes[4] = {};
+    for (uint32_t i = 0; i < cellCount; i++) {
+        uint32_t h = state_hash_height_key(height[i], heightLevels);
+        lanes[0] += state_hash_cell(i, h, STATE_HASH_SALTS[0]);
+        lanes[1] += state_hash_cell(i, h, STATE_HASH_SALTS[1]);
+        lanes[2] += state_hash_cell(i, biome[i], STATE_HASH_SALTS[2]);
+        lanes[3] += state_hash_cell(i, biome[i], STATE_HASH_SALTS[3]);
+    }
+    return state_hash_from_lanes(lanes);
+}
+
+bool write_golden(const std::string& path, const GoldenHashes& golden) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "# params: " << golden.params << "\n"
+        << "# device: " << golden.device << "\n"
+        << "step,height_hash,biome_hash\n";
+    char line[64];
+    for (const auto& [step, hash] : golden.steps) {
+        snprintf(line, sizeof(line), "%u,%016llx,%016llx\n", step,
+                 static_cast<unsigned long long>(hash.height), static_cast<unsigned long long>(hash.biome));
+        out << line;
+    }
+    return static_cast<bool>(out);
+}
+
+bool read_golden(const std::string& path, GoldenHashes& golden) {
+    std::ifstream in(path);
+    if (!in) return false;
+    golden = GoldenHashes{};
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("# params: ", 0) == 0) {
+            golden.params = line.substr(10);
+            continue;
+        }
+        if (line.rfind("# device: ", 0) == 0) {
+            golden.device = line.substr(10);
+            continue;
+        }
+        if (line.empty() || line[0] == '#' || line.rfind("step,", 0) == 0) continue;
+
+        unsigned step;
+        unsigned long long h, b;
+        if (sscanf(line.c_str(), "%u,%llx,%llx", &step, &h, &b) != 3) return false;
+        golden.steps.push_back({step, StateHash{h, b}});
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Host side of state_hash.comp (--verify): the same order-independent
+// 64-bit hashes of the height and biome layers, and the golden hash files
+// GPU runs are checked against.
+struct StateHash {
+    uint64_t height = 0;
+    uint64_t biome = 0;
+
+    bool operator==(const StateHash&) const = default;
+};
+
+constexpr uint32_t STATE_HASH_SALTS[4] = {0x00000000u, 0x9e3779b9u, 0x85ebca6bu, 0xc2b2ae35u};
+
+inline uint32_t state_hash_mix(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+inline uint32_t state_hash_cell(uint32_t index, uint32_t value, uint32_t salt) {
+    return state_hash_mix(state_hash_mix(index ^ salt) + value);
+}
+
+// heightLevels as for the shaders; 0 (R32F) hashes the float's bits
+inline uint32_t state_hash_height_key(float h, float heightLevels) {
+    if (heightLevels <= 0.0f) {
+        uint32_t bits;
+        memcpy(&bits, &h, sizeof(bits));
+        return bits;
+    }
+    return static_cast<uint32_t>(std::lround(std::clamp(h, 0.0f, 1.0f) * 65535.0f));
+}
+
+// The four uint lanes state_hash.comp leaves in its buffer
+inline StateHash state_hash_from_lanes(const uint32_t lanes[4]) {
+    StateHash hash;
+    hash.height = static_cast<uint64_t>(lanes[1]) << 32 | lanes[0];
+    hash.biome = static_cast<uint64_t>(lanes[3]) << 32 | lanes[2];
+    return hash;
+}
+
+StateHash hash_state(const float* height, const uint8_t* biome, uint32_t cellCount, float heightLevels);
+
+// Golden file: '#' lines with the run parameters, then step,height,biome
+// (hex) per hashed step. Hashes are only comparable for the same params,
+// and bit-exact state is only expected on the same device and driver.
+struct GoldenHashes {
+    std::string params;
+    std::string device;
+    std::vector<std::pair<uint32_t, StateHash>> steps;
+};
+
+bool write_golden(const std::string& path, const GoldenHashes& golden);
+bool read_golden(const std::string& path, GoldenHashes& golden);
@@ -0,0 +1,77 @@
+#include "terrain_lod.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void TerrainLod::configure(uint32_t size, float fovY, uint32_t viewportHeight, float pixelError) {
+    gridSize = size;
+
+    // Levels until one node covers the whole grid
+    uint32_t levels = 1;
+    while ((PATCH_QUADS << (levels - 1)) < gridSize) levels++;
+
+    // World units per pixel at distance d is 2 * tan(fov / 2) * d / viewportHeight
+    float pixelsPerUnit = viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+    float quad = 1.0f / gridSize;
+    float range = quad * pixelsPerUnit / std::max(pixelError, 0.01f);
+    // A range must stay a few node diagonals wide, or neighbours end up more
+    // than one level apart and the morph no longer closes the seams
+    float nodeDiagonal = 1.41421356f * PATCH_QUADS * quad;
+    range = std::max(range, 4.0f * nodeDiagonal);
+
+    ranges.resize(levels);
+    for (uint32_t l = 0; l < levels; l++) {
+        ranges[l] = range;
+        range *= 2.0f;
+    }
+}
+
+void TerrainLod::select(const glm::vec3& cameraPos, std::vector<TerrainPatch>& out, size_t maxPatches) const {
+    out.clear();
+    if (ranges.empty()) return;
+    select_node(0, 0, level_count() - 1, cameraPos, out, maxPatches);
+}
+
+// Distance from the camera to the node's footprint on y = 0
+float TerrainLod::node_distance(uint32_t x, uint32_t z, uint32_t level, const glm::vec3& cameraPos) const {
+    float size = static_cast<float>(PATCH_QUADS << level);
+    float x0 = x / static_cast<float>(gridSize) - 0.5f;
+    float z0 = z / static_cast<float>(gridSize) - 0.5f;
+    float x1 = std::min(x + size, static_cast<float>(gridSize)) / gridSize - 0.5f;
+    float z1 = std::min(z + size, static_cast<float>(gridSize)) / gridSize - 0.5f;
+    float dx = std::max({x0 - cameraPos.x, 0.0f, cameraPos.x - x1});
+    float dz = std::max({z0 - cameraPos.z, 0.0f, cameraPos.z - z1});
+    return std::sqrt(dx * dx + cameraPos.y * cameraPos.y + dz * dz);
+}
+
+void TerrainLod::select_node(uint32_t x, uint32_t z, uint32_t level, const glm::vec3& cameraPos,
+                             std::vector<TerrainPatch>& out, size_t maxPatches) const {
+    // Split while part of the node is inside the finer level's range. A child
+    // outside that range is still drawn at its own level: it sits fully
+    // morphed, which is exactly this level's grid, so its edges match.
+    bool split = level > 0 && node_distance(x, z, level, cameraPos) < ranges[level - 1];
+    if (!split || out.size() + 4 > maxPatches) {
+        emit(x, z, level, out, maxPatches);
+        return;
+    }
+    uint32_t half = PATCH_QUADS << (level - 1);
+    for (uint32_t c = 0; c < 4; c++) {
+        uint32_t cx = x + (c & 1) * half;
+        uint32_t cz = z + (c >> 1) * half;
+        if (cx >= gridSize || cz >= gridSize) continue;
+        select_node(cx, cz, level - 1, cameraPos, out, maxPatches);
+    }
+}
+
+void TerrainLod::emit(uint32_t x, uint32_t z, uint32_t level, std::vector<TerrainPatch>& out, size_t maxPatches) const {
+    if (out.size() >= maxPatches) return;
+    TerrainPatch patch{};
+    patch.originX = x;
+    patch.originZ = z;
+    patch.level = level;
+    // Morph over the outer 30% of the range; the finer level's range (half
+    // of this one) is always inside the unmorphed part
+    patch.morphEnd = ranges[level];
+    patch.morphStart = ranges[level] * 0.7f;
+    out.push_back(patch);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// One selected quadtree node, drawn as an instance of the shared patch mesh.
+// Matches TerrainPatch in terrain.vert (std430).
+struct TerrainPatch {
+    uint32_t originX;   // Texel of the patch's corner
+    uint32_t originZ;
+    uint32_t level;     // Quad size is 2^level texels
+    float morphStart;   // Morph toward the next level's grid over [start, end]
+    float morphEnd;
+    uint32_t pad[3];
+};
+static_assert(sizeof(TerrainPatch) == 32, "must match terrain.vert TerrainPatch");
+
+// CDLOD quadtree selection over the heightmap (continuous distance-dependent
+// LOD). Every node is a PATCH_QUADS^2 grid; a node is split while any of it is
+// closer than its children's LOD range, where a range is the distance at which
+// one quad of that level projects to `pixelError` pixels on screen.
+//
+// Distances ignore terrain height (points sit on y = 0), so selection and the
+// vertex shader's morph agree exactly whatever the current heights are.
+class TerrainLod {
+public:
+    static constexpr uint32_t PATCH_QUADS = 32;
+
+    void configure(uint32_t gridSize, float fovY, uint32_t viewportHeight, float pixelError);
+
+    // World space: the terrain spans [-0.5, 0.5] in x/z
+    void select(const glm::vec3& cameraPos, std::vector<TerrainPatch>& out, size_t maxPatches) const;
+
+    uint32_t level_count() const { return static_cast<uint32_t>(ranges.size()); }
+
+private:
+    void select_node(uint32_t x, uint32_t z, uint32_t level, const glm::vec3& cameraPos,
+                     std::vector<TerrainPatch>& out, size_t maxPatches) const;
+    float node_distance(uint32_t x, uint32_t z, uint32_t level, const glm::vec3& cameraPos) const;
+    void emit(uint32_t x, uint32_t z, uint32_t level, std::vector<TerrainPatch>& out, size_t maxPatches) const;
+
+    uint32_t gridSize = 0;
+    std::vector<float> ranges;  // Per level, finest first; each is twice the last
+};
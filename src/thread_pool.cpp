@@ -0,0 +1,120 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+namespace {
+
+uint64_t pack(uint32_t begin, uint32_t end) {
+    return static_cast<uint64_t>(begin) | static_cast<uint64_t>(end) << 32;
+}
+
+uint32_t range_begin(uint64_t packed) { return static_cast<uint32_t>(packed); }
+uint32_t range_end(uint64_t packed) { return static_cast<uint32_t>(packed >> 32); }
+
+} // namespace
+
+ThreadPool::ThreadPool(uint32_t threadCount) {
+    if (threadCount == 0) threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    workerCount = threadCount;
+    ranges.reset(new Range[workerCount]);
+    // Worker 0 is whichever thread calls parallel_for
+    for (uint32_t i = 1; i < workerCount; i++) {
+        threads.emplace_back(&ThreadPool::worker_main, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads) t.join();
+}
+
+void ThreadPool::parallel_for(uint32_t count, const std::function<void(uint32_t, uint32_t)>& body) {
+    if (count == 0) return;
+    if (workerCount == 1 || count == 1) {
+        for (uint32_t i = 0; i < count; i++) body(i, 0);
+        return;
+    }
+
+    for (uint32_t w = 0; w < workerCount; w++) {
+        uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(count) * w / workerCount);
+        uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(count) * (w + 1) / workerCount);
+        ranges[w].packed.store(pack(begin, end), std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &body;
+        running = workerCount - 1;
+        generation++;
+    }
+    wake.notify_all();
+
+    run_items(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return running == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::worker_main(uint32_t worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        run_items(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running--;
+        }
+        done.notify_one();
+    }
+}
+
+void ThreadPool::run_items(uint32_t worker) {
+    const auto& body = *job;
+    uint32_t item;
+    while (pop(worker, item) || steal(worker, item)) {
+        body(item, worker);
+    }
+}
+
+bool ThreadPool::pop(uint32_t worker, uint32_t& item) {
+    std::atomic<uint64_t>& own = ranges[worker].packed;
+    uint64_t current = own.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t begin = range_begin(current), end = range_end(current);
+        if (begin >= end) return false;
+        if (own.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_acq_rel)) {
+            item = begin;
+            return true;
+        }
+    }
+}
+
+// Takes the back half of the first non-empty block after our own, keeps
+// its first item and makes the rest our new block. Our block is empty
+// here, so nobody else can be updating it.
+bool ThreadPool::steal(uint32_t worker, uint32_t& item) {
+    for (uint32_t i = 1; i < workerCount; i++) {
+        std::atomic<uint64_t>& victim = ranges[(worker + i) % workerCount].packed;
+        uint64_t current = victim.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t begin = range_begin(current), end = range_end(current);
+            if (begin >= end) break;
+            uint32_t mid = begin + (end - begin) / 2;
+            if (victim.compare_exchange_weak(current, pack(begin, mid), std::memory_order_acq_rel)) {
+                item = mid;
+                ranges[worker].packed.store(pack(mid + 1, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
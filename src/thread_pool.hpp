@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork-join pool for the CPU simulation backend. parallel_for() hands each
+// worker a contiguous block of items (neighbouring tiles, so neighbouring
+// memory); a worker that runs out steals the back half of another worker's
+// remaining block. The calling thread works too, and the call returns once
+// every item has run.
+class ThreadPool {
+public:
+    explicit ThreadPool(uint32_t threadCount = 0); // 0 = hardware_concurrency
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Runs body(item, worker) for every item in [0, count); worker is in
+    // [0, size()) and unique among the calls running at the same time
+    void parallel_for(uint32_t count, const std::function<void(uint32_t, uint32_t)>& body);
+
+    uint32_t size() const { return workerCount; }
+
+private:
+    // [begin, end) packed as begin | end << 32, so owner pops (front) and
+    // steals (back half) are both a single CAS
+    struct alignas(64) Range {
+        std::atomic<uint64_t> packed{0};
+    };
+
+    void worker_main(uint32_t worker);
+    void run_items(uint32_t worker);
+    bool pop(uint32_t worker, uint32_t& item);
+    bool steal(uint32_t worker, uint32_t& item);
+
+    uint32_t workerCount = 1;  // Helper threads + the caller
+    std::unique_ptr<Range[]> ranges;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(uint32_t, uint32_t)>* job = nullptr;
+    uint64_t generation = 0;   // Bumped per parallel_for, guarded by mutex
+    uint32_t running = 0;      // Helper threads still inside the current job
+    bool stopping = false;
+};